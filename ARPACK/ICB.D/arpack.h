@@ -7,10 +7,14 @@
 
 #define a_int int32_t
 #define a_dcomplex double _Complex
+#define a_fcomplex float _Complex
 
 #ifndef CMPLX
 #define CMPLX(r,i) ((double _Complex)((double)(r) + _Complex_I * (double)(i)))
 #endif
+#ifndef CMPLXF
+#define CMPLXF(r,i) ((float _Complex)((float)(r) + _Complex_I * (float)(i)))
+#endif
 
 
 // Double complex routines for general and hermitian endomorphisms
@@ -99,4 +103,176 @@ void dneupd_c(a_int             rvec     ,
               a_int             lworkl   ,
               a_int*            info      );
 
+// Double routines for symmetric endomorphisms
+void dsaupd_c(a_int*            ido      ,
+              char const*       bmat     ,
+              a_int             n        ,
+              char const*       which    ,
+              a_int             nev      ,
+              double            tol      ,
+              double*           resid    ,
+              a_int             ncv      ,
+              double*           v        ,
+              a_int             ldv      ,
+              a_int*            iparam   ,
+              a_int*            ipntr    ,
+              double*           workd    ,
+              double*           workl    ,
+              a_int             lworkl   ,
+              a_int*            info      );
+void dseupd_c(a_int             rvec     ,
+              char const*       howmny   ,
+              a_int const*      select   ,
+              double*           d        ,
+              double*           z        ,
+              a_int             ldz      ,
+              double            sigma    ,
+              char const*       bmat     ,
+              a_int             n        ,
+              char const*       which    ,
+              a_int             nev      ,
+              double            tol      ,
+              double*           resid    ,
+              a_int             ncv      ,
+              double*           v        ,
+              a_int             ldv      ,
+              a_int*            iparam   ,
+              a_int*            ipntr    ,
+              double*           workd    ,
+              double*           workl    ,
+              a_int             lworkl   ,
+              a_int*            info      );
+
+// Complex routines for general and hermitian endomorphisms
+void cnaupd_c(a_int*            ido      ,
+              char const*       bmat     ,
+              a_int             n        ,
+              char const*       which    ,
+              a_int             nev      ,
+              float             tol      ,
+              a_fcomplex*       resid    ,
+              a_int             ncv      ,
+              a_fcomplex*       v        ,
+              a_int             ldv      ,
+              a_int*            iparam   ,
+              a_int*            ipntr    ,
+              a_fcomplex*       workd    ,
+              a_fcomplex*       workl    ,
+              a_int             lworkl   ,
+              float*            rwork    ,
+              a_int*            info      );
+void cneupd_c(a_int             rvec     ,
+              char const*       howmny   ,
+              a_int const*      select   ,
+              a_fcomplex*       d        ,
+              a_fcomplex*       z        ,
+              a_int             ldz      ,
+              a_fcomplex        sigma    ,
+              a_fcomplex*       workev   ,
+              char const*       bmat     ,
+              a_int             n        ,
+              char const*       which    ,
+              a_int             nev      ,
+              float             tol      ,
+              a_fcomplex*       resid    ,
+              a_int             ncv      ,
+              a_fcomplex*       v        ,
+              a_int             ldv      ,
+              a_int*            iparam   ,
+              a_int*            ipntr    ,
+              a_fcomplex*       workd    ,
+              a_fcomplex*       workl    ,
+              a_int             lworkl   ,
+              float*            rwork    ,
+              a_int*            info      );
+
+// Real routines for general endomorphisms
+void snaupd_c(a_int*            ido      ,
+              char const*       bmat     ,
+              a_int             n        ,
+              char const*       which    ,
+              a_int             nev      ,
+              float             tol      ,
+              float*            resid    ,
+              a_int             ncv      ,
+              float*            v        ,
+              a_int             ldv      ,
+              a_int*            iparam   ,
+              a_int*            ipntr    ,
+              float*            workd    ,
+              float*            workl    ,
+              a_int             lworkl   ,
+              a_int*            info      );
+void sneupd_c(a_int             rvec     ,
+              char const*       howmny   ,
+              a_int const*      select   ,
+              float*            dr       ,
+              float*            di       ,
+              float*            z        ,
+              a_int             ldz      ,
+              float             sigmar   ,
+              float             sigmai   ,
+              float*            workev   ,
+              char const*       bmat     ,
+              a_int             n        ,
+              char const*       which    ,
+              a_int             nev      ,
+              float             tol      ,
+              float*            resid    ,
+              a_int             ncv      ,
+              float*            v        ,
+              a_int             ldv      ,
+              a_int*            iparam   ,
+              a_int*            ipntr    ,
+              float*            workd    ,
+              float*            workl    ,
+              a_int             lworkl   ,
+              a_int*            info      );
+
+// Real routines for symmetric endomorphisms
+void ssaupd_c(a_int*            ido      ,
+              char const*       bmat     ,
+              a_int             n        ,
+              char const*       which    ,
+              a_int             nev      ,
+              float             tol      ,
+              float*            resid    ,
+              a_int             ncv      ,
+              float*            v        ,
+              a_int             ldv      ,
+              a_int*            iparam   ,
+              a_int*            ipntr    ,
+              float*            workd    ,
+              float*            workl    ,
+              a_int             lworkl   ,
+              a_int*            info      );
+void sseupd_c(a_int             rvec     ,
+              char const*       howmny   ,
+              a_int const*      select   ,
+              float*            d        ,
+              float*            z        ,
+              a_int             ldz      ,
+              float             sigma    ,
+              char const*       bmat     ,
+              a_int             n        ,
+              char const*       which    ,
+              a_int             nev      ,
+              float             tol      ,
+              float*            resid    ,
+              a_int             ncv      ,
+              float*            v        ,
+              a_int             ldv      ,
+              a_int*            iparam   ,
+              a_int*            ipntr    ,
+              float*            workd    ,
+              float*            workl    ,
+              a_int             lworkl   ,
+              a_int*            info      );
+
+// Counters and timers of the last solve in the calling thread ("typ" 's' for
+// the symmetric, 'n' for the general real and 'c' for the complex routines)
+void arstat_c(char              typ      ,
+              a_int*            counts   ,
+              float*            times     );
+
 #endif
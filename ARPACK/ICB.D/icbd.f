@@ -2,7 +2,7 @@ C2345&
 C
 CCC   ISO C BINDINGS FOR DOUBLE ARPACK ROUTINES CCCCCCCCCCCCCCCCCCCCCCCC
 C
-CCC   DSAUPD
+CCC   DNAUPD
       SUBROUTINE DNAUPD_C(IDO,BMAT,N,WHICH,NEV,TOL,RESID,NCV,V,LDV,
      &IPARAM,IPNTR,WORKD,WORKL,LWORKL,INFO)
      &BIND(C,NAME="dnaupd_c")
@@ -33,12 +33,12 @@ C
           W(I:I)=WHICH(I)
       END DO
 C
-      CALL DSAUPD(IDO,BMAT,N,W,NEV,TOL,RESID,NCV,V,LDV,IPARAM,IPNTR,
+      CALL DNAUPD(IDO,BMAT,N,W,NEV,TOL,RESID,NCV,V,LDV,IPARAM,IPNTR,
      &WORKD,WORKL,LWORKL,INFO)
 C
       END SUBROUTINE DNAUPD_C
-C   C
-CCC   ZNEUPD
+C
+CCC   DNEUPD
       SUBROUTINE DNEUPD_C(RVEC,HOWMNY,SELECT,DR,DI,Z,LDZ,SIGMAR,SIGMAI,
      &WORKEV,BMAT,N,WHICH,NEV,TOL,RESID,NCV,V,LDV,IPARAM,IPNTR,WORKD,
      &WORKL,LWORKL,INFO)
@@ -92,3 +92,90 @@ C
      &W,NEV,TOL,RESID,NCV,V,LDV,IPARAM,IPNTR,WORKD,WORKL,LWORKL,INFO)
 C
       END SUBROUTINE DNEUPD_C
+C
+CCC   DSAUPD
+      SUBROUTINE DSAUPD_C(IDO,BMAT,N,WHICH,NEV,TOL,RESID,NCV,V,LDV,
+     &IPARAM,IPNTR,WORKD,WORKL,LWORKL,INFO)
+     &BIND(C,NAME="dsaupd_c")
+C
+      USE::ISO_C_BINDING
+C
+      IMPLICIT NONE
+      INTEGER(KIND=C_INT),INTENT(INOUT)::IDO
+      CHARACTER(KIND=C_CHAR),INTENT(IN)::BMAT
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::N
+      CHARACTER(KIND=C_CHAR),DIMENSION(2),INTENT(IN)::WHICH
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::NEV
+      REAL(KIND=C_DOUBLE),VALUE,INTENT(IN)::TOL
+      REAL(KIND=C_DOUBLE),DIMENSION(N),INTENT(INOUT)::RESID
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::NCV
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::LDV
+      REAL(KIND=C_DOUBLE),DIMENSION(LDV,NCV),INTENT(OUT)::V
+      INTEGER(KIND=C_INT),DIMENSION(11),INTENT(INOUT)::IPARAM
+      INTEGER(KIND=C_INT),DIMENSION(11),INTENT(OUT)::IPNTR
+      REAL(KIND=C_DOUBLE),DIMENSION(3*N),INTENT(OUT)::WORKD
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::LWORKL
+      REAL(KIND=C_DOUBLE),DIMENSION(LWORKL),INTENT(OUT)::WORKL
+      INTEGER(KIND=C_INT),INTENT(INOUT)::INFO
+      CHARACTER(LEN=2)::W
+      INTEGER::I
+C
+      DO I=1,2
+          W(I:I)=WHICH(I)
+      END DO
+C
+      CALL DSAUPD(IDO,BMAT,N,W,NEV,TOL,RESID,NCV,V,LDV,IPARAM,IPNTR,
+     &WORKD,WORKL,LWORKL,INFO)
+C
+      END SUBROUTINE DSAUPD_C
+C
+CCC   DSEUPD
+      SUBROUTINE DSEUPD_C(RVEC,HOWMNY,SELECT,D,Z,LDZ,SIGMA,BMAT,N,WHICH,
+     &NEV,TOL,RESID,NCV,V,LDV,IPARAM,IPNTR,WORKD,WORKL,LWORKL,INFO)
+     &BIND(C,NAME="dseupd_c")
+C
+      USE::ISO_C_BINDING
+C
+      IMPLICIT NONE
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::RVEC
+      CHARACTER(KIND=C_CHAR),INTENT(IN)::HOWMNY
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::NCV
+      INTEGER(KIND=C_INT),DIMENSION(NCV),INTENT(IN)::SELECT
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::NEV
+      REAL(KIND=C_DOUBLE),DIMENSION(NEV),INTENT(OUT)::D
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::N
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::LDZ
+      REAL(KIND=C_DOUBLE),DIMENSION(LDZ,NEV),INTENT(OUT)::Z
+      REAL(KIND=C_DOUBLE),VALUE,INTENT(IN)::SIGMA
+      CHARACTER(KIND=C_CHAR),INTENT(IN)::BMAT
+      CHARACTER(KIND=C_CHAR),DIMENSION(2),INTENT(IN)::WHICH
+      REAL(KIND=C_DOUBLE),VALUE,INTENT(IN)::TOL
+      REAL(KIND=C_DOUBLE),DIMENSION(N),INTENT(INOUT)::RESID
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::LDV
+      REAL(KIND=C_DOUBLE),DIMENSION(LDV,NCV),INTENT(OUT)::V
+      INTEGER(KIND=C_INT),DIMENSION(11),INTENT(INOUT)::IPARAM
+      INTEGER(KIND=C_INT),DIMENSION(11),INTENT(OUT)::IPNTR
+      REAL(KIND=C_DOUBLE),DIMENSION(3*N),INTENT(OUT)::WORKD
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::LWORKL
+      REAL(KIND=C_DOUBLE),DIMENSION(LWORKL),INTENT(OUT)::WORKL
+      INTEGER(KIND=C_INT),INTENT(INOUT)::INFO
+      LOGICAL::RV
+      LOGICAL,DIMENSION(NCV)::SLT
+      INTEGER::IDX
+      CHARACTER(LEN=2)::W
+      INTEGER::I
+C
+      RV=.FALSE.
+      IF (RVEC.NE.0) RV=.TRUE.
+      SLT=.FALSE.
+      DO IDX=1,NCV
+        IF (SELECT(IDX).NE.0) SLT(IDX)=.TRUE.
+      ENDDO
+      DO I=1,2
+          W(I:I)=WHICH(I)
+      END DO
+C
+      CALL DSEUPD(RV,HOWMNY,SLT,D,Z,LDZ,SIGMA,BMAT,N,W,NEV,TOL,RESID,
+     &NCV,V,LDV,IPARAM,IPNTR,WORKD,WORKL,LWORKL,INFO)
+C
+      END SUBROUTINE DSEUPD_C
@@ -0,0 +1,181 @@
+C2345&
+C
+CCC   ISO C BINDINGS FOR REAL ARPACK ROUTINES CCCCCCCCCCCCCCCCCCCCCCCCCC
+C
+CCC   SNAUPD
+      SUBROUTINE SNAUPD_C(IDO,BMAT,N,WHICH,NEV,TOL,RESID,NCV,V,LDV,
+     &IPARAM,IPNTR,WORKD,WORKL,LWORKL,INFO)
+     &BIND(C,NAME="snaupd_c")
+C
+      USE::ISO_C_BINDING
+C
+      IMPLICIT NONE
+      INTEGER(KIND=C_INT),INTENT(INOUT)::IDO
+      CHARACTER(KIND=C_CHAR),INTENT(IN)::BMAT
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::NEV
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::NCV
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::LDV
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::N
+      CHARACTER(KIND=C_CHAR),DIMENSION(2),INTENT(IN)::WHICH
+      REAL(KIND=C_FLOAT),VALUE,INTENT(IN)::TOL
+      REAL(KIND=C_FLOAT),DIMENSION(N),INTENT(INOUT)::RESID
+      REAL(KIND=C_FLOAT),DIMENSION(N,NCV),INTENT(OUT)::V
+      INTEGER(KIND=C_INT),DIMENSION(11),INTENT(INOUT)::IPARAM
+      INTEGER(KIND=C_INT),DIMENSION(14),INTENT(OUT)::IPNTR
+      REAL(KIND=C_FLOAT),DIMENSION(3*N),INTENT(OUT)::WORKD
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::LWORKL
+      REAL(KIND=C_FLOAT),DIMENSION(LWORKL),INTENT(OUT)::WORKL
+      INTEGER(KIND=C_INT),INTENT(INOUT)::INFO
+      CHARACTER(LEN=2)::W
+      INTEGER::I
+C
+      DO I=1,2
+          W(I:I)=WHICH(I)
+      END DO
+C
+      CALL SNAUPD(IDO,BMAT,N,W,NEV,TOL,RESID,NCV,V,LDV,IPARAM,IPNTR,
+     &WORKD,WORKL,LWORKL,INFO)
+C
+      END SUBROUTINE SNAUPD_C
+C
+CCC   SNEUPD
+      SUBROUTINE SNEUPD_C(RVEC,HOWMNY,SELECT,DR,DI,Z,LDZ,SIGMAR,SIGMAI,
+     &WORKEV,BMAT,N,WHICH,NEV,TOL,RESID,NCV,V,LDV,IPARAM,IPNTR,WORKD,
+     &WORKL,LWORKL,INFO)
+     &BIND(C,NAME="sneupd_c")
+C
+      USE::ISO_C_BINDING
+C
+      IMPLICIT NONE
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::RVEC
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::NCV
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::LDV
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::NEV
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::N
+      CHARACTER(KIND=C_CHAR),INTENT(IN)::HOWMNY
+      INTEGER(KIND=C_INT),DIMENSION(NCV),INTENT(IN)::SELECT
+      REAL(KIND=C_FLOAT),DIMENSION(NEV+1),INTENT(OUT)::DR
+      REAL(KIND=C_FLOAT),DIMENSION(NEV+1),INTENT(OUT)::DI
+      REAL(KIND=C_FLOAT),DIMENSION(N,NEV+1),INTENT(OUT)::Z
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::LDZ
+      REAL(KIND=C_FLOAT),VALUE,INTENT(IN)::SIGMAR
+      REAL(KIND=C_FLOAT),VALUE,INTENT(IN)::SIGMAI
+      REAL(KIND=C_FLOAT),DIMENSION(3*NCV),INTENT(OUT)::WORKEV
+      CHARACTER(KIND=C_CHAR),INTENT(IN)::BMAT
+      CHARACTER(KIND=C_CHAR),DIMENSION(2),INTENT(IN)::WHICH
+      REAL(KIND=C_FLOAT),VALUE,INTENT(IN)::TOL
+      REAL(KIND=C_FLOAT),DIMENSION(N),INTENT(INOUT)::RESID
+      REAL(KIND=C_FLOAT),DIMENSION(LDV,NCV),INTENT(OUT)::V
+      INTEGER(KIND=C_INT),DIMENSION(11),INTENT(INOUT)::IPARAM
+      INTEGER(KIND=C_INT),DIMENSION(14),INTENT(OUT)::IPNTR
+      REAL(KIND=C_FLOAT),DIMENSION(3*N),INTENT(OUT)::WORKD
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::LWORKL
+      REAL(KIND=C_FLOAT),DIMENSION(LWORKL),INTENT(OUT)::WORKL
+      INTEGER(KIND=C_INT),INTENT(INOUT)::INFO
+      LOGICAL::RV
+      LOGICAL,DIMENSION(NCV)::SLT
+      INTEGER::IDX
+      CHARACTER(LEN=2)::W
+      INTEGER::I
+C
+      RV=.FALSE.
+      IF (RVEC.NE.0) RV=.TRUE.
+      SLT=.FALSE.
+      DO IDX=1,NCV
+        IF (SELECT(IDX).NE.0) SLT(IDX)=.TRUE.
+      ENDDO
+      DO I=1,2
+          W(I:I)=WHICH(I)
+      END DO
+C
+      CALL SNEUPD(RV,HOWMNY,SLT,DR,DI,Z,LDZ,SIGMAR,SIGMAI,WORKEV,BMAT,N,
+     &W,NEV,TOL,RESID,NCV,V,LDV,IPARAM,IPNTR,WORKD,WORKL,LWORKL,INFO)
+C
+      END SUBROUTINE SNEUPD_C
+C
+CCC   SSAUPD
+      SUBROUTINE SSAUPD_C(IDO,BMAT,N,WHICH,NEV,TOL,RESID,NCV,V,LDV,
+     &IPARAM,IPNTR,WORKD,WORKL,LWORKL,INFO)
+     &BIND(C,NAME="ssaupd_c")
+C
+      USE::ISO_C_BINDING
+C
+      IMPLICIT NONE
+      INTEGER(KIND=C_INT),INTENT(INOUT)::IDO
+      CHARACTER(KIND=C_CHAR),INTENT(IN)::BMAT
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::N
+      CHARACTER(KIND=C_CHAR),DIMENSION(2),INTENT(IN)::WHICH
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::NEV
+      REAL(KIND=C_FLOAT),VALUE,INTENT(IN)::TOL
+      REAL(KIND=C_FLOAT),DIMENSION(N),INTENT(INOUT)::RESID
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::NCV
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::LDV
+      REAL(KIND=C_FLOAT),DIMENSION(LDV,NCV),INTENT(OUT)::V
+      INTEGER(KIND=C_INT),DIMENSION(11),INTENT(INOUT)::IPARAM
+      INTEGER(KIND=C_INT),DIMENSION(11),INTENT(OUT)::IPNTR
+      REAL(KIND=C_FLOAT),DIMENSION(3*N),INTENT(OUT)::WORKD
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::LWORKL
+      REAL(KIND=C_FLOAT),DIMENSION(LWORKL),INTENT(OUT)::WORKL
+      INTEGER(KIND=C_INT),INTENT(INOUT)::INFO
+      CHARACTER(LEN=2)::W
+      INTEGER::I
+C
+      DO I=1,2
+          W(I:I)=WHICH(I)
+      END DO
+C
+      CALL SSAUPD(IDO,BMAT,N,W,NEV,TOL,RESID,NCV,V,LDV,IPARAM,IPNTR,
+     &WORKD,WORKL,LWORKL,INFO)
+C
+      END SUBROUTINE SSAUPD_C
+C
+CCC   SSEUPD
+      SUBROUTINE SSEUPD_C(RVEC,HOWMNY,SELECT,D,Z,LDZ,SIGMA,BMAT,N,WHICH,
+     &NEV,TOL,RESID,NCV,V,LDV,IPARAM,IPNTR,WORKD,WORKL,LWORKL,INFO)
+     &BIND(C,NAME="sseupd_c")
+C
+      USE::ISO_C_BINDING
+C
+      IMPLICIT NONE
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::RVEC
+      CHARACTER(KIND=C_CHAR),INTENT(IN)::HOWMNY
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::NCV
+      INTEGER(KIND=C_INT),DIMENSION(NCV),INTENT(IN)::SELECT
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::NEV
+      REAL(KIND=C_FLOAT),DIMENSION(NEV),INTENT(OUT)::D
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::N
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::LDZ
+      REAL(KIND=C_FLOAT),DIMENSION(LDZ,NEV),INTENT(OUT)::Z
+      REAL(KIND=C_FLOAT),VALUE,INTENT(IN)::SIGMA
+      CHARACTER(KIND=C_CHAR),INTENT(IN)::BMAT
+      CHARACTER(KIND=C_CHAR),DIMENSION(2),INTENT(IN)::WHICH
+      REAL(KIND=C_FLOAT),VALUE,INTENT(IN)::TOL
+      REAL(KIND=C_FLOAT),DIMENSION(N),INTENT(INOUT)::RESID
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::LDV
+      REAL(KIND=C_FLOAT),DIMENSION(LDV,NCV),INTENT(OUT)::V
+      INTEGER(KIND=C_INT),DIMENSION(11),INTENT(INOUT)::IPARAM
+      INTEGER(KIND=C_INT),DIMENSION(11),INTENT(OUT)::IPNTR
+      REAL(KIND=C_FLOAT),DIMENSION(3*N),INTENT(OUT)::WORKD
+      INTEGER(KIND=C_INT),VALUE,INTENT(IN)::LWORKL
+      REAL(KIND=C_FLOAT),DIMENSION(LWORKL),INTENT(OUT)::WORKL
+      INTEGER(KIND=C_INT),INTENT(INOUT)::INFO
+      LOGICAL::RV
+      LOGICAL,DIMENSION(NCV)::SLT
+      INTEGER::IDX
+      CHARACTER(LEN=2)::W
+      INTEGER::I
+C
+      RV=.FALSE.
+      IF (RVEC.NE.0) RV=.TRUE.
+      SLT=.FALSE.
+      DO IDX=1,NCV
+        IF (SELECT(IDX).NE.0) SLT(IDX)=.TRUE.
+      ENDDO
+      DO I=1,2
+          W(I:I)=WHICH(I)
+      END DO
+C
+      CALL SSEUPD(RV,HOWMNY,SLT,D,Z,LDZ,SIGMA,BMAT,N,W,NEV,TOL,RESID,
+     &NCV,V,LDV,IPARAM,IPNTR,WORKD,WORKL,LWORKL,INFO)
+C
+      END SUBROUTINE SSEUPD_C
@@ -0,0 +1,50 @@
+C2345&
+C
+CCC   ISO C BINDING FOR THE TIMING COMMON BLOCK OF ARPACK CCCCCCCCCCCCCC
+C
+CCC   ARSTAT
+      SUBROUTINE ARSTAT_C(TYP,COUNTS,TIMES)
+     &BIND(C,NAME="arstat_c")
+C
+      USE::ISO_C_BINDING
+C
+      IMPLICIT NONE
+      INCLUDE '../INC.D/stat.h'
+      CHARACTER(KIND=C_CHAR),VALUE,INTENT(IN)::TYP
+      INTEGER(KIND=C_INT),DIMENSION(5),INTENT(OUT)::COUNTS
+      REAL(KIND=C_FLOAT),DIMENSION(8),INTENT(OUT)::TIMES
+C
+      COUNTS(1)=NOPX
+      COUNTS(2)=NBX
+      COUNTS(3)=NRORTH
+      COUNTS(4)=NITREF
+      COUNTS(5)=NRSTRT
+C
+      IF (TYP.EQ.'s') THEN
+          TIMES(1)=TSAUPD
+          TIMES(2)=TSAUP2
+          TIMES(3)=TSAITR
+          TIMES(4)=TSEIGT
+          TIMES(5)=TSGETS
+          TIMES(6)=TSAPPS
+          TIMES(7)=TSCONV
+      ELSE IF (TYP.EQ.'n') THEN
+          TIMES(1)=TNAUPD
+          TIMES(2)=TNAUP2
+          TIMES(3)=TNAITR
+          TIMES(4)=TNEIGH
+          TIMES(5)=TNGETS
+          TIMES(6)=TNAPPS
+          TIMES(7)=TNCONV
+      ELSE
+          TIMES(1)=TCAUPD
+          TIMES(2)=TCAUP2
+          TIMES(3)=TCAITR
+          TIMES(4)=TCEIGH
+          TIMES(5)=TCGETS
+          TIMES(6)=TCAPPS
+          TIMES(7)=TCCONV
+      END IF
+      TIMES(8)=TMVOPX
+C
+      END SUBROUTINE ARSTAT_C
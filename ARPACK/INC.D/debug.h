@@ -14,3 +14,4 @@ c     %---------------------------------%
      &         msaupd, msaup2, msaitr, mseigt, msapps, msgets, mseupd,
      &         mnaupd, mnaup2, mnaitr, mneigh, mnapps, mngets, mneupd,
      &         mcaupd, mcaup2, mcaitr, mceigh, mcapps, mcgets, mceupd
+c$omp threadprivate(/debug/)
@@ -7,6 +7,7 @@ c FILE: stat.h   SID: 2.2   DATE OF SID: 11/16/95   RELEASE: 2
 c
       real       t0, t1, t2, t3, t4, t5
       save       t0, t1, t2, t3, t4, t5
+c$omp threadprivate(t0, t1, t2, t3, t4, t5)
 c
       integer    nopx, nbx, nrorth, nitref, nrstrt
       real       tsaupd, tsaup2, tsaitr, tseigt, tsgets, tsapps, tsconv,
@@ -19,3 +20,4 @@ c
      &           tnaupd, tnaup2, tnaitr, tneigh, tngets, tnapps, tnconv,
      &           tcaupd, tcaup2, tcaitr, tceigh, tcgets, tcapps, tcconv,
      &           tmvopx, tmvbx, tgetv0, titref, trvec
+c$omp threadprivate(/timing/)
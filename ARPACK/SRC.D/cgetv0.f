@@ -163,6 +163,7 @@ c
       Complex
      &           cnorm
       save       first, iseed, inits, iter, msglvl, orth, rnorm0
+c$omp threadprivate(first, iseed, inits, iter, msglvl, orth, rnorm0)
 c
 c     %----------------------%
 c     | External Subroutines |
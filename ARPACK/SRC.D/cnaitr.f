@@ -267,6 +267,9 @@ c
       save       first, orth1, orth2, rstart, step3, step4,
      &           ierr, ipj, irj, ivj, iter, itry, j, msglvl, ovfl,
      &           betaj, rnorm1, smlnum, ulp, unfl, wnorm
+c$omp threadprivate(first, orth1, orth2, rstart, step3, step4, ierr,
+c$omp&           ipj, irj, ivj, iter, itry, j, msglvl, ovfl, betaj,
+c$omp&           rnorm1, smlnum, ulp, unfl, wnorm)
 c
 c     %----------------------%
 c     | External Subroutines |
@@ -227,6 +227,8 @@ c
       save       cnorm,  getv0, initv , update, ushift,
      &           rnorm,  iter , kplusp, msglvl, nconv ,
      &           nevbef, nev0 , np0   , eps23
+c$omp threadprivate(cnorm, getv0, initv, update, ushift, rnorm, iter,
+c$omp&           kplusp, msglvl, nconv, nevbef, nev0, np0, eps23)
 c
 c
 c     %-----------------------%
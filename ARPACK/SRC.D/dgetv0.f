@@ -162,6 +162,7 @@ c
       Double precision
      &           rnorm0
       save       first, iseed, inits, iter, msglvl, orth, rnorm0
+c$omp threadprivate(first, iseed, inits, iter, msglvl, orth, rnorm0)
 c
 c     %----------------------%
 c     | External Subroutines |
@@ -174,8 +175,8 @@ c     | External Functions |
 c     %--------------------%
 c
       Double precision
-     &           ddot, dnrm2
-      external   ddot, dnrm2
+     &           eigs_fddot, eigs_fdnrm2
+      external   eigs_fddot, eigs_fdnrm2
 c
 c     %---------------------%
 c     | Intrinsic Functions |
@@ -298,10 +299,10 @@ c
 c
       first = .FALSE.
       if (bmat .eq. 'G') then
-          rnorm0 = ddot (n, resid, 1, workd, 1)
+          rnorm0 = eigs_fddot (n, resid, workd)
           rnorm0 = sqrt(abs(rnorm0))
       else if (bmat .eq. 'I') then
-           rnorm0 = dnrm2(n, resid, 1)
+           rnorm0 = eigs_fdnrm2(n, resid)
       end if
       rnorm  = rnorm0
 c
@@ -355,10 +356,10 @@ c
       end if
 c
       if (bmat .eq. 'G') then
-         rnorm = ddot (n, resid, 1, workd, 1)
+         rnorm = eigs_fddot (n, resid, workd)
          rnorm = sqrt(abs(rnorm))
       else if (bmat .eq. 'I') then
-         rnorm = dnrm2(n, resid, 1)
+         rnorm = eigs_fdnrm2(n, resid)
       end if
 c
 c     %--------------------------------------%
@@ -255,6 +255,9 @@ c
       save       first, orth1, orth2, rstart, step3, step4,
      &           ierr, ipj, irj, ivj, iter, itry, j, msglvl, ovfl,
      &           betaj, rnorm1, smlnum, ulp, unfl, wnorm
+c$omp threadprivate(first, orth1, orth2, rstart, step3, step4, ierr,
+c$omp&           ipj, irj, ivj, iter, itry, j, msglvl, ovfl, betaj,
+c$omp&           rnorm1, smlnum, ulp, unfl, wnorm)
 c
 c     %-----------------------%
 c     | Local Array Arguments |
@@ -268,15 +271,15 @@ c     | External Subroutines |
 c     %----------------------%
 c
       external   daxpy, dcopy, dscal, dgemv, dgetv0, dlabad,
-     &           dvout, dmout, ivout, arscnd
+     &           dvout, dmout, ivout, arscnd, eigs_fdscal
 c
 c     %--------------------%
 c     | External Functions |
 c     %--------------------%
 c
       Double precision
-     &           ddot, dnrm2, dlanhs, dlamch
-      external   ddot, dnrm2, dlanhs, dlamch
+     &           eigs_fddot, eigs_fdnrm2, dlanhs, dlamch
+      external   eigs_fddot, eigs_fdnrm2, dlanhs, dlamch
 c
 c     %---------------------%
 c     | Intrinsic Functions |
@@ -448,8 +451,8 @@ c
          call dcopy (n, resid, 1, v(1,j), 1)
          if (rnorm .ge. unfl) then
              temp1 = one / rnorm
-             call dscal (n, temp1, v(1,j), 1)
-             call dscal (n, temp1, workd(ipj), 1)
+             call eigs_fdscal (n, temp1, v(1,j))
+             call eigs_fdscal (n, temp1, workd(ipj))
          else
 c
 c            %-----------------------------------------%
@@ -543,10 +546,10 @@ c        | Compute the B-norm of OP*v_{j}.     |
 c        %-------------------------------------%
 c
          if (bmat .eq. 'G') then
-             wnorm = ddot (n, resid, 1, workd(ipj), 1)
+             wnorm = eigs_fddot (n, resid, workd(ipj))
              wnorm = sqrt(abs(wnorm))
          else if (bmat .eq. 'I') then
-            wnorm = dnrm2(n, resid, 1)
+            wnorm = eigs_fdnrm2(n, resid)
          end if
 c
 c        %-----------------------------------------%
@@ -615,10 +618,10 @@ c        | Compute the B-norm of r_{j}. |
 c        %------------------------------%
 c
          if (bmat .eq. 'G') then
-            rnorm = ddot (n, resid, 1, workd(ipj), 1)
+            rnorm = eigs_fddot (n, resid, workd(ipj))
             rnorm = sqrt(abs(rnorm))
          else if (bmat .eq. 'I') then
-            rnorm = dnrm2(n, resid, 1)
+            rnorm = eigs_fdnrm2(n, resid)
          end if
 c
 c        %-----------------------------------------------------------%
@@ -714,10 +717,10 @@ c        | Compute the B-norm of the corrected residual r_{j}. |
 c        %-----------------------------------------------------%
 c
          if (bmat .eq. 'G') then
-             rnorm1 = ddot (n, resid, 1, workd(ipj), 1)
+             rnorm1 = eigs_fddot (n, resid, workd(ipj))
              rnorm1 = sqrt(abs(rnorm1))
          else if (bmat .eq. 'I') then
-             rnorm1 = dnrm2(n, resid, 1)
+             rnorm1 = eigs_fdnrm2(n, resid)
          end if
 c
          if (msglvl .gt. 0 .and. iter .gt. 0) then
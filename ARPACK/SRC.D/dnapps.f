@@ -183,13 +183,15 @@ c
      &           c, f, g, h11, h12, h21, h22, h32, ovfl, r, s, sigmai,
      &           sigmar, smlnum, ulp, unfl, u(3), t, tau, tst1
       save       first, ovfl, smlnum, ulp, unfl
+c$omp threadprivate(first, ovfl, smlnum, ulp, unfl)
 c
 c     %----------------------%
 c     | External Subroutines |
 c     %----------------------%
 c
       external   daxpy, dcopy, dscal, dlacpy, dlarfg, dlarf,
-     &           dlaset, dlabad, arscnd, dlartg
+     &           dlaset, dlabad, arscnd, dlartg, eigs_fdscal,
+     &           eigs_fdaxpy
 c
 c     %--------------------%
 c     | External Functions |
@@ -618,9 +620,9 @@ c     |    sigmak = (e_{kplusp}'*Q)*e_{kev} |
 c     |    betak = e_{kev+1}'*H*e_{kev}     |
 c     %-------------------------------------%
 c
-      call dscal (n, q(kplusp,kev), resid, 1)
+      call eigs_fdscal (n, q(kplusp,kev), resid)
       if (h(kev+1,kev) .gt. zero)
-     &   call daxpy (n, h(kev+1,kev), v(1,kev+1), 1, resid, 1)
+     &   call eigs_fdaxpy (n, h(kev+1,kev), v(1,kev+1), resid)
 c
       if (msglvl .gt. 1) then
          call dvout (logfil, 1, q(kplusp,kev), ndigit,
@@ -449,6 +449,8 @@ c
       save       bounds, ih, iq, ishift, iupd, iw, ldh, ldq,
      &           levec, mode, msglvl, mxiter, nb, nev0, next,
      &           np, ritzi, ritzr
+c$omp threadprivate(bounds, ih, iq, ishift, iupd, iw, ldh, ldq, levec,
+c$omp&           mode, msglvl, mxiter, nb, nev0, next, np, ritzi, ritzr)
 c
 c     %----------------------%
 c     | External Subroutines |
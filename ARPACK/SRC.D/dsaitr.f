@@ -246,9 +246,12 @@ c
      &           infol, jj
       Double precision
      &           rnorm1, wnorm, safmin, temp1
-      save       orth1, orth2, rstart, step3, step4,
+      save       first, orth1, orth2, rstart, step3, step4,
      &           ierr, ipj, irj, ivj, iter, itry, j, msglvl,
      &           rnorm1, safmin, wnorm
+c$omp threadprivate(first, orth1, orth2, rstart, step3, step4, ierr,
+c$omp&           ipj, irj, ivj, iter, itry, j, msglvl, rnorm1, safmin,
+c$omp&           wnorm)
 c
 c     %-----------------------%
 c     | Local Array Arguments |
@@ -262,15 +265,15 @@ c     | External Subroutines |
 c     %----------------------%
 c
       external   daxpy, dcopy, dscal, dgemv, dgetv0, dvout, dmout,
-     &           dlascl, ivout, arscnd
+     &           dlascl, ivout, arscnd, eigs_fdscal
 c
 c     %--------------------%
 c     | External Functions |
 c     %--------------------%
 c
       Double precision
-     &           ddot, dnrm2, dlamch
-      external   ddot, dnrm2, dlamch
+     &           eigs_fddot, eigs_fdnrm2, dlamch
+      external   eigs_fddot, eigs_fdnrm2, dlamch
 c
 c     %-----------------%
 c     | Data statements |
@@ -438,8 +441,8 @@ c
          call dcopy (n, resid, 1, v(1,j), 1)
          if (rnorm .ge. safmin) then
              temp1 = one / rnorm
-             call dscal (n, temp1, v(1,j), 1)
-             call dscal (n, temp1, workd(ipj), 1)
+             call eigs_fdscal (n, temp1, v(1,j))
+             call eigs_fdscal (n, temp1, workd(ipj))
          else
 c
 c            %-----------------------------------------%
@@ -543,13 +546,13 @@ c           | Note that the B-norm of OP*v_{j} |
 c           | is the inv(B)-norm of A*v_{j}.   |
 c           %----------------------------------%
 c
-            wnorm = ddot (n, resid, 1, workd(ivj), 1)
+            wnorm = eigs_fddot (n, resid, workd(ivj))
             wnorm = sqrt(abs(wnorm))
          else if (bmat .eq. 'G') then
-            wnorm = ddot (n, resid, 1, workd(ipj), 1)
+            wnorm = eigs_fddot (n, resid, workd(ipj))
             wnorm = sqrt(abs(wnorm))
          else if (bmat .eq. 'I') then
-            wnorm = dnrm2(n, resid, 1)
+            wnorm = eigs_fdnrm2(n, resid)
          end if
 c
 c        %-----------------------------------------%
@@ -632,10 +635,10 @@ c        | Compute the B-norm of r_{j}. |
 c        %------------------------------%
 c
          if (bmat .eq. 'G') then
-            rnorm = ddot (n, resid, 1, workd(ipj), 1)
+            rnorm = eigs_fddot (n, resid, workd(ipj))
             rnorm = sqrt(abs(rnorm))
          else if (bmat .eq. 'I') then
-            rnorm = dnrm2(n, resid, 1)
+            rnorm = eigs_fdnrm2(n, resid)
          end if
 c
 c        %-----------------------------------------------------------%
@@ -728,10 +731,10 @@ c        | Compute the B-norm of the corrected residual r_{j}. |
 c        %-----------------------------------------------------%
 c
          if (bmat .eq. 'G') then
-             rnorm1 = ddot (n, resid, 1, workd(ipj), 1)
+             rnorm1 = eigs_fddot (n, resid, workd(ipj))
              rnorm1 = sqrt(abs(rnorm1))
          else if (bmat .eq. 'I') then
-             rnorm1 = dnrm2(n, resid, 1)
+             rnorm1 = eigs_fdnrm2(n, resid)
          end if
 c
          if (msglvl .gt. 0 .and. iter .gt. 0) then
@@ -169,6 +169,7 @@ c
       Double precision
      &           a1, a2, a3, a4, big, c, epsmch, f, g, r, s
       save       epsmch, first
+c$omp threadprivate(epsmch, first)
 c
 c
 c     %----------------------%
@@ -176,7 +177,7 @@ c     | External Subroutines |
 c     %----------------------%
 c
       external   daxpy, dcopy, dscal, dlacpy, dlartg, dlaset, dvout,
-     &           ivout, arscnd, dgemv
+     &           ivout, arscnd, dgemv, eigs_fdscal, eigs_fdaxpy
 c
 c     %--------------------%
 c     | External Functions |
@@ -488,9 +489,9 @@ c     |    sigmak = (e_{kev+p}'*Q)*e_{kev}  |
 c     |    betak = e_{kev+1}'*H*e_{kev}     |
 c     %-------------------------------------%
 c
-      call dscal (n, q(kplusp,kev), resid, 1)
+      call eigs_fdscal (n, q(kplusp,kev), resid)
       if (h(kev+1,1) .gt. zero)
-     &   call daxpy (n, h(kev+1,1), v(1,kev+1), 1, resid, 1)
+     &   call eigs_fdaxpy (n, h(kev+1,1), v(1,kev+1), resid)
 c
       if (msglvl .gt. 1) then
          call dvout (logfil, 1, q(kplusp,kev), ndigit,
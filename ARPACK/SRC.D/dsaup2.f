@@ -229,6 +229,8 @@ c
       save       cnorm, getv0, initv, update, ushift,
      &           iter, kplusp, msglvl, nconv, nev0, np0,
      &           rnorm, eps23
+c$omp threadprivate(cnorm, getv0, initv, update, ushift, iter, kplusp,
+c$omp&           msglvl, nconv, nev0, np0, rnorm, eps23)
 c
 c     %----------------------%
 c     | External Subroutines |
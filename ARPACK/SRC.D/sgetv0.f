@@ -162,6 +162,7 @@ c
       Real
      &           rnorm0
       save       first, iseed, inits, iter, msglvl, orth, rnorm0
+c$omp threadprivate(first, iseed, inits, iter, msglvl, orth, rnorm0)
 c
 c     %----------------------%
 c     | External Subroutines |
@@ -183,6 +183,7 @@ c
      &           c, f, g, h11, h12, h21, h22, h32, ovfl, r, s, sigmai,
      &           sigmar, smlnum, ulp, unfl, u(3), t, tau, tst1
       save       first, ovfl, smlnum, ulp, unfl
+c$omp threadprivate(first, ovfl, smlnum, ulp, unfl)
 c
 c     %----------------------%
 c     | External Subroutines |
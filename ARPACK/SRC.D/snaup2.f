@@ -224,6 +224,9 @@ c
       save       cnorm , getv0, initv, update, ushift,
      &           rnorm , iter , eps23, kplusp, msglvl, nconv ,
      &           nevbef, nev0 , np0  , numcnv
+c$omp threadprivate(cnorm, getv0, initv, update, ushift, rnorm, iter,
+c$omp&           eps23, kplusp, msglvl, nconv, nevbef, nev0, np0,
+c$omp&           numcnv)
 c
 c     %-----------------------%
 c     | Local array arguments |
@@ -246,9 +246,12 @@ c
      &           infol, jj
       Real
      &           rnorm1, wnorm, safmin, temp1
-      save       orth1, orth2, rstart, step3, step4,
+      save       first, orth1, orth2, rstart, step3, step4,
      &           ierr, ipj, irj, ivj, iter, itry, j, msglvl,
      &           rnorm1, safmin, wnorm
+c$omp threadprivate(first, orth1, orth2, rstart, step3, step4, ierr,
+c$omp&           ipj, irj, ivj, iter, itry, j, msglvl, rnorm1, safmin,
+c$omp&           wnorm)
 c
 c     %-----------------------%
 c     | Local Array Arguments |
@@ -169,6 +169,7 @@ c
       Real
      &           a1, a2, a3, a4, big, c, epsmch, f, g, r, s
       save       epsmch, first
+c$omp threadprivate(epsmch, first)
 c
 c
 c     %----------------------%
@@ -451,6 +451,8 @@ c
       save       bounds, ierr, ih, iq, ishift, iupd, iw,
      &           ldh, ldq, msglvl, mxiter, mode, nb,
      &           nev0, next, np, ritz
+c$omp threadprivate(bounds, ierr, ih, iq, ishift, iupd, iw, ldh, ldq,
+c$omp&           msglvl, mxiter, mode, nb, nev0, next, np, ritz)
 c
 c     %----------------------%
 c     | External Subroutines |
@@ -163,6 +163,7 @@ c
       Complex*16
      &           cnorm
       save       first, iseed, inits, iter, msglvl, orth, rnorm0
+c$omp threadprivate(first, iseed, inits, iter, msglvl, orth, rnorm0)
 c
 c     %----------------------%
 c     | External Subroutines |
@@ -175,10 +176,10 @@ c     | External Functions |
 c     %--------------------%
 c
       Double precision
-     &           dznrm2, dlapy2
+     &           eigs_fdznrm2, dlapy2
       Complex*16
      &           zzdotc
-      external   zzdotc, dznrm2, dlapy2
+      external   zzdotc, eigs_fdznrm2, dlapy2
 c
 c     %-----------------%
 c     | Data Statements |
@@ -296,7 +297,7 @@ c
           cnorm  = zzdotc (n, resid, 1, workd, 1)
           rnorm0 = sqrt(dlapy2(dble(cnorm),aimag(cnorm)))
       else if (bmat .eq. 'I') then
-           rnorm0 = dznrm2(n, resid, 1)
+           rnorm0 = eigs_fdznrm2(n, resid)
       end if
       rnorm  = rnorm0
 c
@@ -353,7 +354,7 @@ c
          cnorm = zzdotc (n, resid, 1, workd, 1)
          rnorm = sqrt(dlapy2(dble(cnorm),aimag(cnorm)))
       else if (bmat .eq. 'I') then
-         rnorm = dznrm2(n, resid, 1)
+         rnorm = eigs_fdznrm2(n, resid)
       end if
 c
 c     %--------------------------------------%
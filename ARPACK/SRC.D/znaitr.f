@@ -267,6 +267,9 @@ c
       save       first, orth1, orth2, rstart, step3, step4,
      &           ierr, ipj, irj, ivj, iter, itry, j, msglvl, ovfl,
      &           betaj, rnorm1, smlnum, ulp, unfl, wnorm
+c$omp threadprivate(first, orth1, orth2, rstart, step3, step4, ierr,
+c$omp&           ipj, irj, ivj, iter, itry, j, msglvl, ovfl, betaj,
+c$omp&           rnorm1, smlnum, ulp, unfl, wnorm)
 c
 c     %----------------------%
 c     | External Subroutines |
@@ -282,8 +285,8 @@ c
       Complex*16
      &           zzdotc
       Double precision
-     &           dlamch,  dznrm2, zlanhs, dlapy2
-      external   zzdotc, dznrm2, zlanhs, dlamch, dlapy2
+     &           dlamch,  eigs_fdznrm2, zlanhs, dlapy2
+      external   zzdotc, eigs_fdznrm2, zlanhs, dlamch, dlapy2
 c
 c     %---------------------%
 c     | Intrinsic Functions |
@@ -553,7 +556,7 @@ c
              cnorm = zzdotc (n, resid, 1, workd(ipj), 1)
              wnorm = sqrt( dlapy2(dble(cnorm),aimag(cnorm)) )
          else if (bmat .eq. 'I') then
-             wnorm = dznrm2(n, resid, 1)
+             wnorm = eigs_fdznrm2(n, resid)
          end if
 c
 c        %-----------------------------------------%
@@ -625,7 +628,7 @@ c
             cnorm = zzdotc (n, resid, 1, workd(ipj), 1)
             rnorm = sqrt( dlapy2(dble(cnorm),aimag(cnorm)) )
          else if (bmat .eq. 'I') then
-            rnorm = dznrm2(n, resid, 1)
+            rnorm = eigs_fdznrm2(n, resid)
          end if
 c
 c        %-----------------------------------------------------------%
@@ -725,7 +728,7 @@ c
              cnorm  = zzdotc (n, resid, 1, workd(ipj), 1)
              rnorm1 = sqrt( dlapy2(dble(cnorm),aimag(cnorm)) )
          else if (bmat .eq. 'I') then
-             rnorm1 = dznrm2(n, resid, 1)
+             rnorm1 = eigs_fdznrm2(n, resid)
          end if
 c
          if (msglvl .gt. 0 .and. iter .gt. 0 ) then
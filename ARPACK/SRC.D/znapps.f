@@ -178,6 +178,7 @@ c
       Double precision
      &           c,  ovfl, smlnum, ulp, unfl, tst1
       save       first, ovfl, smlnum, ulp, unfl
+c$omp threadprivate(first, ovfl, smlnum, ulp, unfl)
 c
 c     %----------------------%
 c     | External Subroutines |
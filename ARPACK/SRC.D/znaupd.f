@@ -423,6 +423,8 @@ c
       save       bounds, ih, iq, ishift, iupd, iw,
      &           ldh, ldq, levec, mode, msglvl, mxiter, nb,
      &           nev0, next, np, ritz
+c$omp threadprivate(bounds, ih, iq, ishift, iupd, iw, ldh, ldq, levec,
+c$omp&           mode, msglvl, mxiter, nb, nev0, next, np, ritz)
 c
 c     %----------------------%
 c     | External Subroutines |
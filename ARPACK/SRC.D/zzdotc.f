@@ -3,9 +3,12 @@ c
 c     forms the dot product of a vector.
 c     jack dongarra, 3/11/78.
 c     modified 12/3/93, array(1) declarations changed to array(*)
+c     modified for eigs, unit increments use its vector kernels
 c
       double complex zx(*),zy(*),ztemp
       integer i,incx,incy,ix,iy,n
+      double complex eigs_fzdotc
+      external eigs_fzdotc
       ztemp = (0.0d0,0.0d0)
       zzdotc = (0.0d0,0.0d0)
       if(n.le.0)return
@@ -28,9 +31,6 @@ c
 c
 c        code for both increments equal to 1
 c
-   20 do 30 i = 1,n
-        ztemp = ztemp + conjg(zx(i))*zy(i)
-   30 continue
-      zzdotc = ztemp
+   20 zzdotc = eigs_fzdotc(n,zx,zy)
       return
       end
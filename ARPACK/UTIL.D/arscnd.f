@@ -0,0 +1,30 @@
+      SUBROUTINE ARSCND( T )
+*
+      REAL       T
+*
+*  Purpose
+*  =======
+*
+*  ARSCND returns the wall clock time in seconds of the monotonic clock
+*  read by SYSTEM_CLOCK. The time is counted from the first call within
+*  the calling thread, such that the single precision result keeps its
+*  resolution (about a millisecond after three hours).
+*
+*     .. Local Scalars ..
+      INTEGER(KIND=SELECTED_INT_KIND(18)) COUNT, RATE, COUNT0
+      SAVE               COUNT0
+c$omp threadprivate(COUNT0)
+*     ..
+*     .. Data statements ..
+      DATA               COUNT0 / -1 /
+*     ..
+*     .. Executable Statements ..
+*
+      CALL SYSTEM_CLOCK( COUNT, RATE )
+      IF( COUNT0.LT.0 ) COUNT0 = COUNT
+      T = REAL( COUNT-COUNT0 ) / REAL( RATE )
+      RETURN
+*
+*     End of ARSCND
+*
+      END
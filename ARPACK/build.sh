@@ -2,8 +2,20 @@
 
 ### Run this script to compile and link ARPACK into a C library
 
-CMPL="gfortran -fPIC -Wall -pedantic -fcheck=all -c"
-LINK="gfortran -shared ./OBJ.D/* -o"
+# The flag "-fopenmp" turns the "c$omp threadprivate" directives in the
+# sources into thread-local storage for ARPACK's saved variables and common
+# blocks (and implies "-frecursive"), such that independent solves can run in
+# different threads at the same time; the Arnoldi loops are optimized and
+# run without runtime checks (add "-fcheck=all" to debug ARPACK)
+#
+# The double precision Arnoldi loops call the vector kernels "eigs_fd*" and
+# "eigs_fzdotc" of "../src.d/simd.c", the library resolves them against
+# "libeigs.so" at load time
+CMPL="gfortran -fPIC -fopenmp -O2 -Wall -pedantic -c"
+LINK="gfortran -shared -fopenmp ./OBJ.D/* -o"
+
+mkdir -p ./OBJ.D/ ./LIB.D/
+rm -f ./OBJ.D/*.o
 
 echo "Compiling ARPACK"
 cd ./SRC.D/
@@ -13,11 +25,16 @@ cd ../UTIL.D/
 $CMPL ./*
 mv *.o ../OBJ.D/
 cd ../ICB.D/
-cd ./ICB.D/
 $CMPL ./icbz.f
 $CMPL ./icbd.f
+$CMPL ./icbc.f
+$CMPL ./icbs.f
+$CMPL ./icbt.f
 mv ./icbz.o ../OBJ.D/
 mv ./icbd.o ../OBJ.D/
+mv ./icbc.o ../OBJ.D/
+mv ./icbs.o ../OBJ.D/
+mv ./icbt.o ../OBJ.D/
 cd ../
 echo "Linking shared library"
 $LINK ./LIB.D/libarpack.so
@@ -0,0 +1,641 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Benchmark: standard operators generated in-process, swept over dimension,  *
+ * number of eigenvalues, solver type and "which"                             *
+ * -------------------------------------------------------------------------- */
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "../inc.d/eigs.h"
+
+
+// Maximal number of entries of a list given on the command line
+#define MAX_LIST 16
+
+// Off-diagonal entries per row of the random sparse hermitian matrix
+#define RANDH_ROW 8
+
+// Coefficient of the first derivative of the convection-diffusion operator
+#define CONVECTION 0.5
+
+
+// Kinds of operators
+typedef enum { LAP1D, LAP2D, LAP3D, RANDH, CONVDIFF, GOE, GUE } op_kind;
+
+typedef struct {
+    const char *name;
+    op_kind kind;
+    bool dense;            // Dense matrix (k = n) instead of a sparse map
+    bool hermitian;
+} bench_operator;
+
+static const bench_operator operators[] = {
+    { "lap1d",    LAP1D,    false, true  },
+    { "lap2d",    LAP2D,    false, true  },
+    { "lap3d",    LAP3D,    false, true  },
+    { "randh",    RANDH,    false, true  },
+    { "convdiff", CONVDIFF, false, false },
+    { "goe",      GOE,      true,  true  },
+    { "gue",      GUE,      true,  true  }
+};
+#define NOPERATORS (int32_t)(sizeof(operators)/sizeof(operators[0]))
+
+// Settings of the sweep
+typedef struct {
+    const char *ops[MAX_LIST];     int32_t nops;
+    const char *solvers[MAX_LIST]; int32_t nsolvers;
+    const char *which[MAX_LIST];   int32_t nwhich;
+    int32_t n[MAX_LIST];           int32_t nn;
+    int32_t k[MAX_LIST];           int32_t nk;
+    int32_t ndense[MAX_LIST];      int32_t nndense;
+    int32_t maxiter;
+    int32_t repeat;
+    int32_t timeout;
+    bool evs;
+    bool json;
+} bench_settings;
+
+// A single case
+typedef struct {
+    const bench_operator *op;
+    const char *solver;
+    char which[3];
+    int32_t n;
+    int32_t k;
+} bench_case;
+
+// Measurement of a case (sent from the child process to the parent)
+typedef struct {
+    int32_t n;             // Actual dimension (grids are rounded)
+    int64_t nnz;
+    double time;           // Fastest of the repetitions (seconds)
+    double flops;          // Model operation count of a solve
+    long rss;              // Peak resident set size (kB)
+    double eigval;         // First eigenvalue (real part)
+    eigs_stats stats;
+} bench_record;
+
+// Generated operator
+typedef struct {
+    int32_t n;
+    int64_t *ptr;
+    int32_t *col;
+    double *dval;
+    double complex *zval;
+    double *dmat;
+    double complex *zmat;
+    eigs_sparse *a;
+} bench_matrix;
+
+
+static void usage(const char *);
+static int32_t split(char *, const char **);
+static int32_t split_int(char *, int32_t *);
+static void run_case(const bench_settings *, const bench_case *, bool *);
+static void measure(const bench_settings *, const bench_case *, int, int);
+static bool unconverged(FILE *);
+static void generate(const bench_case *, bool, bench_matrix *);
+static void matrix_free(bench_matrix *);
+static void stencil(bench_matrix *, int32_t, int32_t, bool, bool);
+static void random_hermitian(bench_matrix *, int32_t, bool);
+static void random_dense(bench_matrix *, int32_t, bool);
+static double model_flops(const bench_case *, const bench_matrix *,
+                          const eigs_stats *, bool);
+static void print_record(const bench_settings *, const bench_case *,
+                         const char *, const bench_record *, bool);
+static double wall(void);
+static uint64_t next_random(uint64_t *);
+static double uniform(uint64_t *);
+static double gaussian(uint64_t *);
+
+
+int main(int argc, char **argv) {
+
+    // Defaults
+    static char ops[] = "lap1d,lap2d,lap3d,randh,convdiff,goe,gue";
+    static char solvers[] = "zg,dg,zh,ds";
+    static char which[] = "LM,SA";
+    bench_settings s;
+    s.nops = split(ops, s.ops);
+    s.nsolvers = split(solvers, s.solvers);
+    s.nwhich = split(which, s.which);
+    s.n[0] = 1000; s.n[1] = 10000; s.nn = 2;
+    s.k[0] = 4; s.k[1] = 16; s.nk = 2;
+    s.ndense[0] = 200; s.ndense[1] = 800; s.nndense = 2;
+    s.maxiter = 0;
+    s.repeat = 1;
+    s.timeout = 60;
+    s.evs = true;
+    s.json = false;
+
+    // Command line
+    int i;
+    for (i=1; i<argc; i++) {
+        char *arg = argv[i];
+        if (!strcmp(arg, "-j")) { s.json = true; continue; }
+        if (!strcmp(arg, "-e")) { s.evs = false; continue; }
+        if (!strcmp(arg, "-q")) {
+            s.n[0] = 1000; s.nn = 1;
+            s.k[0] = 4; s.nk = 1;
+            s.ndense[0] = 200; s.nndense = 1;
+            continue;
+        }
+        if ((arg[0] != '-') || !arg[1] || arg[2] || (i+1 >= argc)) {
+            usage(argv[0]); return 1;
+        }
+        char *val = argv[++i];
+        switch (arg[1]) {
+            case 'o': s.nops = split(val, s.ops); break;
+            case 's': s.nsolvers = split(val, s.solvers); break;
+            case 'w': s.nwhich = split(val, s.which); break;
+            case 'n': s.nn = split_int(val, s.n); break;
+            case 'k': s.nk = split_int(val, s.k); break;
+            case 'd': s.nndense = split_int(val, s.ndense); break;
+            case 'm': s.maxiter = atoi(val); break;
+            case 'r': s.repeat = atoi(val); break;
+            case 't': s.timeout = atoi(val); break;
+            default: usage(argv[0]); return 1;
+        }
+    }
+    if (s.repeat < 1) s.repeat = 1;
+
+    // Header
+    if (s.json) printf("[\n");
+    else printf("operator,solver,which,n,k,nnz,status,time_s,nmatvec,"
+                "nrestart,nconv,nreorth,time_phi_s,time_orth_s,"
+                "time_restart_s,time_extract_s,peak_rss_kb,gflops,"
+                "eigval0\n");
+    fflush(stdout);
+
+    // Sweep
+    bool first = true;
+    int32_t o, j, v, a, b;
+    for (o=0; o<s.nops; o++) {
+        const bench_operator *op = NULL;
+        for (j=0; j<NOPERATORS; j++)
+            if (!strcmp(s.ops[o], operators[j].name)) op = &operators[j];
+        if (!op) {
+            fprintf(stderr, "BENCH: Operator *%s* not implemented\n",
+                    s.ops[o]);
+            return 1;
+        }
+        for (v=0; v<s.nsolvers; v++) {
+            bench_case c;
+            c.op = op;
+            c.solver = s.solvers[v];
+            bool complex_solver = (c.solver[0] == 'z');
+            bool hermitian_solver = !strcmp(c.solver, "zh") ||
+                                    !strcmp(c.solver, "ds");
+
+            // Hermitian solvers need hermitian operators, dense GUE (GOE)
+            // matrices come with complex (real) solvers only
+            if (hermitian_solver && !op->hermitian) continue;
+            if ((op->kind == GUE) && !complex_solver) continue;
+            if ((op->kind == GOE) && complex_solver) continue;
+
+            if (op->dense) {
+                for (a=0; a<s.nndense; a++) {
+                    c.n = c.k = s.ndense[a];
+                    strcpy(c.which, "--");
+                    run_case(&s, &c, &first);
+                }
+                continue;
+            }
+            for (a=0; a<s.nn; a++) for (b=0; b<s.nk; b++)
+            for (j=0; j<s.nwhich; j++) {
+                c.n = s.n[a]; c.k = s.k[b];
+
+                // "LA"/"SA" of the hermitian solvers are "LR"/"SR" of the
+                // general ones
+                strncpy(c.which, s.which[j], 2); c.which[2] = '\0';
+                if (!hermitian_solver && (c.which[1] == 'A')) c.which[1] = 'R';
+                if (!strcmp(c.solver, "ds") && (c.which[1] == 'R'))
+                    c.which[1] = 'A';
+                run_case(&s, &c, &first);
+            }
+        }
+    }
+    if (s.json) printf("\n]\n");
+
+    return 0;
+}
+
+// Print command line options
+static void usage(const char *name) {
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  -o list  operators (lap1d,lap2d,lap3d,randh,convdiff,goe,gue)\n"
+        "  -s list  solvers (zg,dg,zh,ds)\n"
+        "  -w list  which (LM,SM,LA,SA; LA/SA are LR/SR for zg and dg)\n"
+        "  -n list  dimensions of the sparse operators (1000,10000)\n"
+        "  -k list  numbers of eigenvalues (4,16)\n"
+        "  -d list  dimensions of the dense matrices, k = n (200,800)\n"
+        "  -m int   maximal number of Arnoldi iterations (0: 10n)\n"
+        "  -r int   repetitions per case, the fastest is reported (1)\n"
+        "  -t int   timeout per case in seconds (60)\n"
+        "  -e       eigenvalues only\n"
+        "  -q       quick sweep (n = 1000, k = 4, dense n = 200)\n"
+        "  -j       JSON instead of CSV\n", name);
+}
+
+// Split a comma separated list in place
+static int32_t split(char *list, const char **items) {
+    int32_t count = 0;
+    char *p = list;
+    while (*p && (count < MAX_LIST)) {
+        items[count++] = p;
+        while (*p && (*p != ',')) p++;
+        if (*p) *p++ = '\0';
+    }
+    return count;
+}
+
+// Split a comma separated list of integers
+static int32_t split_int(char *list, int32_t *items) {
+    const char *tmp[MAX_LIST];
+    int32_t count = split(list, tmp), i;
+    for (i=0; i<count; i++) items[i] = atoi(tmp[i]);
+    return count;
+}
+
+// Run a case in a child process (solver errors exit the process, the peak
+// memory of the case is measured on its own); a case which stops at the
+// maximal number of iterations or returns fewer converged eigenvalues than
+// wanted is reported as "unconverged", other errors as "failed"
+static void run_case(const bench_settings *s,
+                     const bench_case *c,
+                     bool *first) {
+
+    bench_record record;
+    memset(&record, 0, sizeof(bench_record));
+    record.n = c->n;
+    const char *status = "ok";
+
+    // Messages of the solver are collected and passed on to stderr
+    FILE *log = tmpfile();
+    if (!log) { perror("BENCH: tmpfile"); exit(1); }
+
+    int fd[2];
+    if (pipe(fd)) { perror("BENCH: pipe"); exit(1); }
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) { perror("BENCH: fork"); exit(1); }
+    if (pid == 0) {
+        close(fd[0]);
+        alarm(s->timeout);
+        measure(s, c, fd[1], fileno(log));
+        fflush(stdout);
+        _exit(0);
+    }
+    close(fd[1]);
+    ssize_t got = read(fd[0], &record, sizeof(bench_record));
+    close(fd[0]);
+    int wstatus;
+    waitpid(pid, &wstatus, 0);
+    bool stalled = unconverged(log);
+    fclose(log);
+    if (WIFSIGNALED(wstatus) && (WTERMSIG(wstatus) == SIGALRM))
+        status = "timeout";
+    else if (stalled)
+        status = "unconverged";
+    else if ((got != (ssize_t)sizeof(bench_record)) ||
+             !WIFEXITED(wstatus) || WEXITSTATUS(wstatus))
+        status = "failed";
+    else if (record.stats.nconv < (c->op->dense ? record.n : c->k))
+        status = "unconverged";
+
+    print_record(s, c, status, &record, *first);
+    *first = false;
+}
+
+// Generate the operator, solve and report to the parent (solver output goes
+// to the file "log")
+static void measure(const bench_settings *s,
+                    const bench_case *c,
+                    int fd,
+                    int log) {
+
+    bench_record record;
+    memset(&record, 0, sizeof(bench_record));
+    bool complex_solver = (c->solver[0] == 'z');
+    bench_matrix m;
+    generate(c, complex_solver, &m);
+    record.n = m.n;
+    record.nnz = m.a ? m.a->nnz : (int64_t)m.n*m.n;
+
+    // Solver output goes to the log, stdout belongs to the report
+    if (dup2(log, STDOUT_FILENO) < 0) _exit(1);
+
+    int32_t k = c->op->dense ? m.n : c->k, r;
+    record.time = HUGE_VAL;
+    for (r=0; r<s->repeat; r++) {
+        double t = wall();
+        eigs_result *result = eigs(c->solver,
+                                   complex_solver ? eigs_sparse_zphi : NULL,
+                                   complex_solver ? NULL : eigs_sparse_dphi,
+                                   m.zmat, m.dmat, m.a, m.n, k,
+                                   c->op->dense ? NULL : c->which,
+                                   s->maxiter, -1., s->evs);
+        t = wall()-t;
+        if (t < record.time) record.time = t;
+        record.stats = result->stats;
+        record.eigval = creal(result->eigvals[0]);
+        eigs_result_free(result);
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    record.rss = usage.ru_maxrss;
+    record.flops = model_flops(c, &m, &record.stats, s->evs);
+    matrix_free(&m);
+
+    if (write(fd, &record, sizeof(bench_record)) !=
+        (ssize_t)sizeof(bench_record))
+        _exit(1);
+}
+
+// Pass the solver messages of a case on to stderr, true if the solver gave
+// up at its maximal number of iterations (or refinement steps)
+static bool unconverged(FILE *log) {
+
+    char line[256];
+    bool stalled = false;
+
+    rewind(log);
+    while (fgets(line, sizeof(line), log)) {
+        fputs(line, stderr);
+        if (strstr(line, "MAXIMAL ALLOWED ITERATIONS") ||
+            strstr(line, "DID NOT CONVERGE"))
+            stalled = true;
+    }
+
+    return stalled;
+}
+
+// Operator of a case (complex values for the complex solvers)
+static void generate(const bench_case *c, bool cplx, bench_matrix *m) {
+
+    memset(m, 0, sizeof(bench_matrix));
+    int32_t side;
+    switch (c->op->kind) {
+        case LAP1D:
+            stencil(m, 1, c->n, cplx, false);
+            break;
+        case LAP2D:
+            side = (int32_t)lround(sqrt((double)c->n));
+            stencil(m, 2, side, cplx, false);
+            break;
+        case LAP3D:
+            side = (int32_t)lround(cbrt((double)c->n));
+            stencil(m, 3, side, cplx, false);
+            break;
+        case CONVDIFF:
+            side = (int32_t)lround(sqrt((double)c->n));
+            stencil(m, 2, side, cplx, true);
+            break;
+        case RANDH:
+            random_hermitian(m, c->n, cplx);
+            break;
+        case GOE:
+        case GUE:
+            random_dense(m, c->n, cplx);
+            return;
+    }
+    m->a = eigs_sparse_init("csr", false, m->n, m->ptr, m->col, m->zval,
+                            m->dval);
+}
+
+// Free generated operator
+static void matrix_free(bench_matrix *m) {
+    if (m->a) eigs_sparse_free(m->a);
+    free(m->ptr); free(m->col);
+    free(m->dval); free(m->zval);
+    free(m->dmat); free(m->zmat);
+}
+
+// Finite difference Laplacian -(d^2/dx_1^2+...) on a "dim"-dimensional grid
+// with "side" points per direction and Dirichlet boundaries; "convection"
+// adds the central first derivative CONVECTION*(d/dx_1+...) which makes the
+// operator non-normal
+static void stencil(bench_matrix *m,
+                    int32_t dim,
+                    int32_t side,
+                    bool cplx,
+                    bool convection) {
+
+    int32_t n = 1, d, i, stride;
+    for (d=0; d<dim; d++) n *= side;
+    m->n = n;
+    m->ptr = (int64_t *)malloc((n+1)*sizeof(int64_t));
+    m->col = (int32_t *)malloc((size_t)n*(2*dim+1)*sizeof(int32_t));
+    if (cplx)
+        m->zval = (double complex *)malloc((size_t)n*(2*dim+1)
+                                           *sizeof(double complex));
+    else
+        m->dval = (double *)malloc((size_t)n*(2*dim+1)*sizeof(double));
+
+    int64_t pos = 0;
+    double lower = convection ? -1.-CONVECTION : -1.;
+    double upper = convection ? -1.+CONVECTION : -1.;
+    for (i=0; i<n; i++) {
+        m->ptr[i] = pos;
+
+        // Columns in ascending order: lower neighbours from the slowest
+        // direction on, diagonal, upper neighbours
+        for (d=dim-1, stride=n/side; d>=0; d--, stride/=side)
+            if ((i/stride)%side > 0) {
+                m->col[pos] = i-stride;
+                if (cplx) m->zval[pos] = lower; else m->dval[pos] = lower;
+                pos++;
+            }
+        m->col[pos] = i;
+        if (cplx) m->zval[pos] = 2.*dim; else m->dval[pos] = 2.*dim;
+        pos++;
+        for (d=0, stride=1; d<dim; d++, stride*=side)
+            if ((i/stride)%side < side-1) {
+                m->col[pos] = i+stride;
+                if (cplx) m->zval[pos] = upper; else m->dval[pos] = upper;
+                pos++;
+            }
+    }
+    m->ptr[n] = pos;
+}
+
+// Random sparse hermitian (real symmetric) matrix with RANDH_ROW random
+// off-diagonal entries per row (and their mirror images) and a random
+// diagonal
+static void random_hermitian(bench_matrix *m, int32_t n, bool cplx) {
+
+    uint64_t seed = 0x9e3779b97f4a7c15ULL;
+    int64_t nt = (int64_t)n*(2*RANDH_ROW+1), t, pos;
+    int32_t *ti = (int32_t *)malloc(nt*sizeof(int32_t));
+    int32_t *tj = (int32_t *)malloc(nt*sizeof(int32_t));
+    double complex *tv = (double complex *)malloc(nt*sizeof(double complex));
+    int32_t i, r;
+
+    // Triplets (duplicates are summed by the action of the matrix)
+    t = 0;
+    for (i=0; i<n; i++) {
+        ti[t] = tj[t] = i; tv[t] = gaussian(&seed); t++;
+        for (r=0; r<RANDH_ROW; r++) {
+            int32_t j = (int32_t)(next_random(&seed)%(uint64_t)n);
+            if (j == i) continue;
+            double complex v = gaussian(&seed);
+            if (cplx) v += I*gaussian(&seed);
+            ti[t] = i; tj[t] = j; tv[t] = v; t++;
+            ti[t] = j; tj[t] = i; tv[t] = conj(v); t++;
+        }
+    }
+    nt = t;
+
+    // Sort by rows
+    m->n = n;
+    m->ptr = (int64_t *)calloc(n+1, sizeof(int64_t));
+    m->col = (int32_t *)malloc(nt*sizeof(int32_t));
+    if (cplx) m->zval = (double complex *)malloc(nt*sizeof(double complex));
+    else m->dval = (double *)malloc(nt*sizeof(double));
+    for (t=0; t<nt; t++) m->ptr[ti[t]+1]++;
+    for (i=0; i<n; i++) m->ptr[i+1] += m->ptr[i];
+    int64_t *next = (int64_t *)malloc(n*sizeof(int64_t));
+    memcpy(next, m->ptr, n*sizeof(int64_t));
+    for (t=0; t<nt; t++) {
+        pos = next[ti[t]]++;
+        m->col[pos] = tj[t];
+        if (cplx) m->zval[pos] = tv[t]; else m->dval[pos] = creal(tv[t]);
+    }
+
+    free(next); free(ti); free(tj); free(tv);
+}
+
+// Dense random matrix of the gaussian orthogonal (unitary) ensemble,
+// A = (G + G^H)/2 with standard normal entries of G
+static void random_dense(bench_matrix *m, int32_t n, bool cplx) {
+
+    uint64_t seed = 0x2545f4914f6cdd1dULL;
+    int32_t i, j;
+    m->n = n;
+    if (cplx) {
+        m->zmat = (double complex *)malloc((size_t)n*n*sizeof(double complex));
+        for (i=0; i<n; i++) {
+            m->zmat[(size_t)n*i+i] = gaussian(&seed);
+            for (j=i+1; j<n; j++) {
+                double complex v = (gaussian(&seed)+I*gaussian(&seed))/2.;
+                m->zmat[(size_t)n*i+j] = v;
+                m->zmat[(size_t)n*j+i] = conj(v);
+            }
+        }
+    } else {
+        m->dmat = (double *)malloc((size_t)n*n*sizeof(double));
+        for (i=0; i<n; i++) {
+            m->dmat[(size_t)n*i+i] = gaussian(&seed);
+            for (j=i+1; j<n; j++)
+                m->dmat[(size_t)n*i+j] = m->dmat[(size_t)n*j+i] =
+                    gaussian(&seed)/sqrt(2.);
+        }
+    }
+}
+
+// Model operation count of a solve (real flops, a complex multiply-add
+// counts as eight): the map and the orthogonalization of the Krylov basis
+// of ncv = max(2k+1, 20) vectors (two Gram-Schmidt passes) per matvec, or
+// the counts of Golub/Van Loan for the dense QR algorithms
+static double model_flops(const bench_case *c,
+                          const bench_matrix *m,
+                          const eigs_stats *stats,
+                          bool evs) {
+
+    double n = m->n, f = (c->solver[0] == 'z') ? 4. : 1.;
+    if (c->op->dense) {
+        bool hermitian = !strcmp(c->solver, "zh") || !strcmp(c->solver, "ds");
+        if (hermitian) return f*n*n*n*(evs ? 9. : 4./3.);
+        return f*n*n*n*(evs ? 25. : 10.);
+    }
+    double ncv = 2.*c->k+1.;
+    if (ncv < 20.) ncv = 20.;
+    if (ncv > n) ncv = n;
+    return (double)stats->nmatvec*f*(2.*(double)m->a->nnz+4.*n*ncv);
+}
+
+// Print a record as a CSV line or a JSON object
+static void print_record(const bench_settings *s,
+                         const bench_case *c,
+                         const char *status,
+                         const bench_record *r,
+                         bool first) {
+
+    double gflops = (r->time > 0.) ? 1e-9*r->flops/r->time : 0.;
+    const eigs_stats *st = &r->stats;
+    int32_t k = c->op->dense ? r->n : c->k;
+    if (s->json) {
+        printf("%s  {\"operator\": \"%s\", \"solver\": \"%s\", "
+               "\"which\": \"%s\", \"n\": %d, \"k\": %d, \"nnz\": %lld, "
+               "\"status\": \"%s\", \"time_s\": %.6f, \"nmatvec\": %lld, "
+               "\"nrestart\": %d, \"nconv\": %d, \"nreorth\": %d, "
+               "\"time_phi_s\": %.6f, \"time_orth_s\": %.6f, "
+               "\"time_restart_s\": %.6f, \"time_extract_s\": %.6f, "
+               "\"peak_rss_kb\": %ld, \"gflops\": %.3f, "
+               "\"eigval0\": %.12g}",
+               first ? "" : ",\n", c->op->name, c->solver, c->which, r->n,
+               k, (long long)r->nnz, status, r->time,
+               (long long)st->nmatvec, st->nrestart, st->nconv, st->nreorth,
+               st->time_phi, st->time_orth, st->time_restart,
+               st->time_extract, r->rss, gflops, r->eigval);
+    } else {
+        printf("%s,%s,%s,%d,%d,%lld,%s,%.6f,%lld,%d,%d,%d,%.6f,%.6f,%.6f,"
+               "%.6f,%ld,%.3f,%.12g\n",
+               c->op->name, c->solver, c->which, r->n, k, (long long)r->nnz,
+               status, r->time, (long long)st->nmatvec, st->nrestart,
+               st->nconv, st->nreorth, st->time_phi, st->time_orth,
+               st->time_restart, st->time_extract, r->rss, gflops,
+               r->eigval);
+    }
+    fflush(stdout);
+}
+
+// Seconds of the monotonic clock
+static double wall(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec+1e-9*(double)ts.tv_nsec;
+}
+
+// Pseudo random numbers (xorshift64*, fixed seeds make runs reproducible)
+static uint64_t next_random(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x >> 12; x ^= x << 25; x ^= x >> 27;
+    *state = x;
+    return x*0x2545f4914f6cdd1dULL;
+}
+
+// Uniform in (0, 1)
+static double uniform(uint64_t *state) {
+    return ((double)(next_random(state) >> 11)+0.5)*(1./9007199254740992.);
+}
+
+// Standard normal (Box-Muller)
+static double gaussian(uint64_t *state) {
+    double u = uniform(state), v = uniform(state);
+    return sqrt(-2.*log(u))*cos(6.283185307179586*v);
+}
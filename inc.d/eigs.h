@@ -28,9 +28,11 @@
 #include <stdbool.h>
 #include <complex.h>
 #include <string.h>
+#include <pthread.h>
 
 #include "../ARPACK/ICB.D/arpack.h"
 #include <lapacke.h>
+#include <cblas.h>
 
 
 typedef void zeigs_phi(void *,
@@ -41,14 +43,125 @@ typedef void deigs_phi(void *,
                        int32_t,
                        const double *,
                        double *);
+typedef void ceigs_phi(void *,
+                       int32_t,
+                       const float complex *,
+                       float complex *);
+typedef void seigs_phi(void *,
+                       int32_t,
+                       const float *,
+                       float *);
+typedef void zeigs_block_phi(void *,
+                             int32_t,
+                             int32_t,
+                             const double complex *,
+                             double complex *);
+typedef void deigs_block_phi(void *,
+                             int32_t,
+                             int32_t,
+                             const double *,
+                             double *);
+
+typedef struct _EigsSparse {
+    int32_t n;
+    int64_t nnz;
+    bool half;             // Only the upper triangle is stored
+    bool complex_values;   // Values are double complex (else double)
+    bool own;              // Arrays are owned by the matrix
+    int64_t *ptr;          // CSR row pointers
+    int32_t *col;          // CSR column indices
+    double *val;           // CSR values (pairs of doubles if complex)
+    int32_t nblocks;       // Row blocks with balanced numbers of nonzeros
+    int32_t *block;
+    int32_t *lo;           // Column ranges and buffers of the blocks for the
+    int32_t *hi;           // scatter of the lower triangle (half storage)
+    int64_t *offset;
+    double *scatter;
+    pthread_mutex_t lock;
+    int32_t *perm;         // Reverse Cuthill-McKee ordering and bandwidth
+    int32_t kd;            // (shift-invert, computed on first use)
+    struct _EigsFactor *factors;
+    pthread_mutex_t factor_lock;
+} eigs_sparse;
+
+typedef struct _EigsKron {
+    int32_t nmodes;
+    int32_t *dims;         // Dimensions of the modes (mode 0 is the slowest)
+    int32_t n;             // Dimension of the product space
+    bool complex_values;   // A coefficient or factor is complex
+    int32_t nterms;
+    struct _EigsKronTerm *terms;
+    double complex *diag;  // Sum of the diagonal terms (NULL: none)
+    double *buf;           // Intermediate products of a term
+    pthread_mutex_t lock;
+} eigs_kron;
+
+typedef struct _EigsOptions {
+    bool shift_invert;     // Eigenvalues closest to sigma, the operator must
+    double complex sigma;  // be a sparse matrix
+    int32_t chebyshev;     // Degree of a Chebyshev filter ("zh" and "ds")
+    bool overwrite;        // LAPACK may overwrite the input matrix (k = n)
+    bool colmajor;         // Eigenvectors in column-major order
+    double complex *eigvecs; // Caller's buffer for n*k eigenvectors
+    char range;            // Dense "zh"/"ds": 'A' all, 'I' the eigenvalues
+    int32_t il;            // il,...,il+k-1 (ascending, counted from 0) or
+    double vl;             // 'V' at most k eigenvalues in [vl, vu)
+    double vu;
+    char storage;          // Dense "zh"/"ds": 'F' full, 'B' band with "kd"
+    int32_t kd;            // super-diagonals or 'P' packed upper triangle
+    char balance;          // Dense "zg"/"dg": balancing 'B' (permute and
+                           // scale), 'P', 'S' or 'N' (none)
+    ceigs_phi *cphi;       // Float map for mixed precision: Arnoldi in single
+    seigs_phi *sphi;       // precision, refinement with the double map
+    void *fphi_data;       // Data of the float map (NULL: "phi_data")
+    int32_t block;         // Block size of the Lanczos solver ("zh", "ds")
+    zeigs_block_phi *zphi_block; // Map acting on a block of vectors (NULL:
+    deigs_block_phi *dphi_block; // the map column by column)
+    int32_t ncv;           // Dimension of the Krylov subspace (0: 2k+1, at
+                           // least 20, plus 8 blocks for block Lanczos)
+    int32_t nkeep;         // Vectors kept at a thick/Krylov-Schur restart (0:
+                           // halfway between k and ncv)
+    bool krylov_schur;     // Krylov-Schur instead of ARPACK ("zg", "dg")
+    int64_t memory;        // Budget in bytes for the workspaces (0:
+                           // unlimited), ncv shrinks to fit or, if automatic,
+                           // grows up to four times the default
+    const char *basis_dir; // Krylov basis in a memory-mapped file in this
+                           // directory (NULL: in memory)
+} eigs_options;
+
+typedef struct _EigsContext eigs_context;
+
+typedef struct _EigsStats {
+    int64_t nmatvec;       // Applications of the map (of the inverse or the
+                           // filter with shift-invert or Chebyshev)
+    int32_t nrestart;      // Implicit (thick) restarts
+    int32_t nconv;         // Converged Ritz values (ARPACK's iparam[4])
+    int32_t nreorth;       // Reorthogonalizations
+    double time_phi;       // Seconds in the map
+    double time_orth;      // Seconds in the Arnoldi/Lanczos steps without map
+    double time_restart;   // Seconds in Ritz values, shifts and restarts
+    double time_extract;   // Seconds in the extraction of the eigenpairs
+    double time_total;     // Seconds of the whole solve
+} eigs_stats;
 
 typedef struct _EigsResult {
     int32_t n;
     int32_t k;
     double complex *eigvals;
     double complex *eigvecs;
+    bool borrowed;         // Eigenvectors belong to the caller
+    int64_t nmatvec_float; // Mixed precision: applications of the float map
+    int64_t nmatvec_refine; // and of the double map during the refinement
+    eigs_stats stats;      // Counters and timers of the solve
 } eigs_result;
 
+typedef struct _EigsFresult {
+    int32_t n;
+    int32_t k;
+    float complex *eigvals;
+    float complex *eigvecs;
+} eigs_fresult;
+
 
 eigs_result *eigs(const char *,
                   zeigs_phi *,
@@ -63,44 +176,640 @@ eigs_result *eigs(const char *,
                   double,
                   bool);
 
+eigs_result *eigsx(const char *,
+                   zeigs_phi *,
+                   deigs_phi *,
+                   const double complex *,
+                   const double *,
+                   void *,
+                   int32_t,
+                   int32_t,
+                   const char *,
+                   int32_t,
+                   double,
+                   bool,
+                   const eigs_options *);
+
+void eigs_options_init(eigs_options *);
+
+int64_t eigs_workspace_query(const char *,
+                             void *,
+                             int32_t,
+                             int32_t,
+                             bool,
+                             const eigs_options *);
+
+eigs_context *eigs_context_init(const char *,
+                                int32_t,
+                                int32_t);
+
+eigs_result *eigs_solve(eigs_context *,
+                        zeigs_phi *,
+                        deigs_phi *,
+                        const double complex *,
+                        const double *,
+                        void *,
+                        const char *,
+                        int32_t,
+                        double,
+                        bool,
+                        const eigs_options *);
+
+void eigs_context_free(eigs_context *);
+
 void eigs_result_free(eigs_result *);
 
+eigs_result *eigs_batch(const char *,
+                        const double complex *const *,
+                        const double *const *,
+                        const int32_t *,
+                        int32_t,
+                        bool);
+
+void eigs_batch_free(eigs_result *);
+
+eigs_sparse *eigs_sparse_init(const char *,
+                              bool,
+                              int32_t,
+                              const int64_t *,
+                              const int32_t *,
+                              const double complex *,
+                              const double *);
+
+void eigs_sparse_free(eigs_sparse *);
+
+void eigs_sparse_zphi(void *,
+                      int32_t,
+                      const double complex *,
+                      double complex *);
+void eigs_sparse_dphi(void *,
+                      int32_t,
+                      const double *,
+                      double *);
+
+int32_t eigs_sparse_inertia(eigs_sparse *,
+                            double);
+
+eigs_kron *eigs_kron_init(int32_t,
+                          const int32_t *);
+
+void eigs_kron_add(eigs_kron *,
+                   double complex,
+                   const double complex *const *,
+                   const double *const *);
+
+void eigs_kron_free(eigs_kron *);
+
+void eigs_kron_zphi(void *,
+                    int32_t,
+                    const double complex *,
+                    double complex *);
+void eigs_kron_dphi(void *,
+                    int32_t,
+                    const double *,
+                    double *);
+
+eigs_result *eigs_sectors(const char *,
+                          zeigs_phi *,
+                          deigs_phi *,
+                          const double complex *,
+                          const double *,
+                          void *,
+                          int32_t,
+                          int32_t,
+                          const char *,
+                          int32_t,
+                          double,
+                          bool,
+                          const eigs_options *,
+                          int32_t,
+                          const int32_t *,
+                          const int32_t *);
+
+int32_t eigs_sectors_detect(int32_t,
+                            const eigs_sparse *,
+                            const double complex *,
+                            const double *,
+                            int32_t *,
+                            int32_t *);
+
+eigs_result *eigs_slice(const char *,
+                        eigs_sparse *,
+                        double,
+                        double,
+                        int32_t,
+                        double,
+                        bool,
+                        const eigs_options *);
+
+eigs_fresult *eigs_float(const char *,
+                         ceigs_phi *,
+                         seigs_phi *,
+                         const float complex *,
+                         const float *,
+                         void *,
+                         int32_t,
+                         int32_t,
+                         const char *,
+                         int32_t,
+                         float,
+                         bool);
+
+void eigs_fresult_free(eigs_fresult *);
+
 
 /* --- Solvers for internal usage ------------------------------------------- */
+typedef void eigs_reduce(void *,
+                         double complex *,
+                         a_int);
+
 void zgeigsf(a_int,
              zeigs_phi *,
              void *,
              bool,
              const char *,
              a_int,
+             a_int,
              double,
              a_int,
+             a_int,
+             a_dcomplex,
+             bool,
+             const char *,
+             void **,
              eigs_result *);
+void zgeigsf_free(void *);
 void dgeigsf(a_int,
              deigs_phi *,
              void *,
              bool,
              const char *,
              a_int,
+             a_int,
+             double,
+             a_int,
+             a_int,
+             double,
+             bool,
+             const char *,
+             void **,
+             eigs_result *);
+void dgeigsf_free(void *);
+void zheigsf(a_int,
+             zeigs_phi *,
+             void *,
+             bool,
+             const char *,
+             a_int,
+             a_int,
+             a_int,
+             double,
+             a_int,
+             a_int,
+             double,
+             bool,
+             const char *,
+             void **,
+             eigs_result *);
+void zheigsf_free(void *);
+void dseigsf(a_int,
+             deigs_phi *,
+             void *,
+             bool,
+             const char *,
+             a_int,
+             a_int,
              double,
              a_int,
+             a_int,
+             double,
+             bool,
+             const char *,
+             void **,
              eigs_result *);
+void dseigsf_free(void *);
+void zheigsf_block(a_int,
+                   zeigs_phi *,
+                   deigs_phi *,
+                   zeigs_block_phi *,
+                   deigs_block_phi *,
+                   void *,
+                   bool,
+                   const char *,
+                   a_int,
+                   a_int,
+                   a_int,
+                   a_int,
+                   double,
+                   a_int,
+                   a_int,
+                   double,
+                   bool,
+                   const char *,
+                   void **,
+                   eigs_result *);
+void zheigsf_block_free(void *);
+void zgeigsf_ks(a_int,
+                zeigs_phi *,
+                deigs_phi *,
+                void *,
+                const a_dcomplex *,
+                bool,
+                const char *,
+                a_int,
+                a_int,
+                a_int,
+                double,
+                a_int,
+                a_int,
+                a_dcomplex,
+                bool,
+                const char *,
+                void **,
+                eigs_result *);
+void zgeigsf_ks_free(void *);
+void zgeigsf_ks_dist(a_int,
+                     a_int,
+                     eigs_reduce *,
+                     void *,
+                     a_int,
+                     zeigs_phi *,
+                     deigs_phi *,
+                     void *,
+                     bool,
+                     const char *,
+                     a_int,
+                     a_int,
+                     a_int,
+                     double,
+                     a_int,
+                     a_int,
+                     a_dcomplex,
+                     bool,
+                     const char *,
+                     eigs_result *);
 void zgeigsa(uint32_t,
              const double complex *,
              bool,
+             const eigs_options *,
              eigs_result *);
 void dgeigsa(uint32_t,
              const double *,
              bool,
+             const eigs_options *,
              eigs_result *);
 void zheigsa(uint32_t,
              const double complex *,
              bool,
+             const eigs_options *,
              eigs_result *);
 void dseigsa(uint32_t,
              const double *,
              bool,
+             const eigs_options *,
              eigs_result *);
+void cgeigsf(a_int,
+             ceigs_phi *,
+             void *,
+             bool,
+             const char *,
+             a_int,
+             float,
+             a_int,
+             eigs_fresult *);
+void sgeigsf(a_int,
+             seigs_phi *,
+             void *,
+             bool,
+             const char *,
+             a_int,
+             float,
+             a_int,
+             eigs_fresult *);
+void sseigsf(a_int,
+             seigs_phi *,
+             void *,
+             bool,
+             const char *,
+             a_int,
+             float,
+             a_int,
+             eigs_fresult *);
+void cgeigsa(uint32_t,
+             const float complex *,
+             bool,
+             eigs_fresult *);
+void sgeigsa(uint32_t,
+             const float *,
+             bool,
+             eigs_fresult *);
+void cheigsa(uint32_t,
+             const float complex *,
+             bool,
+             eigs_fresult *);
+void sseigsa(uint32_t,
+             const float *,
+             bool,
+             eigs_fresult *);
+/* -------------------------------------------------------------------------- */
+
+
+/* --- Mixed precision for internal usage ---------------------------------- */
+int32_t eigs_mixed(const char *,
+                   zeigs_phi *,
+                   deigs_phi *,
+                   void *,
+                   int32_t,
+                   int32_t,
+                   const char *,
+                   int32_t,
+                   double,
+                   bool,
+                   int32_t,
+                   const eigs_options *,
+                   eigs_result *);
+/* -------------------------------------------------------------------------- */
+
+
+/* --- Statistics for internal usage --------------------------------------- */
+double eigs_clock(void);
+void eigs_arpack_stats(char,
+                       const a_int *,
+                       eigs_stats *);
+/* -------------------------------------------------------------------------- */
+
+
+/* --- Layout for internal usage ------------------------------------------- */
+void eigs_zvecs(int32_t,
+                int32_t,
+                const double complex *,
+                double complex *,
+                bool,
+                bool);
+void eigs_dvecs(int32_t,
+                int32_t,
+                const double *,
+                const double *,
+                double complex *,
+                bool,
+                bool);
+void eigs_cvecs(int32_t,
+                int32_t,
+                const float complex *,
+                float complex *,
+                bool,
+                bool);
+void eigs_svecs(int32_t,
+                int32_t,
+                const float *,
+                const float *,
+                float complex *,
+                bool,
+                bool);
+/* -------------------------------------------------------------------------- */
+
+
+/* --- Memory for internal usage ------------------------------------------- */
+// Rows of the basis rotated at once during a restart
+#define EIGS_ROTATE_ROWS 256
+
+void *eigs_malloc(size_t);
+void *eigs_basis_alloc(size_t,
+                       const char *);
+void eigs_basis_free(void *);
+bool eigs_basis_mapped(const void *);
+size_t eigs_basis_bytes(size_t,
+                        const char *);
+void eigs_basis_prefetch(const void *,
+                         size_t,
+                         a_int,
+                         a_int,
+                         size_t,
+                         size_t);
+void eigs_basis_rotate(a_dcomplex *,
+                       a_int,
+                       a_int,
+                       a_int,
+                       a_int,
+                       const a_dcomplex *,
+                       a_int,
+                       a_dcomplex *);
+void eigs_basis_random(a_dcomplex *,
+                       a_int,
+                       a_int,
+                       a_int *,
+                       a_dcomplex *,
+                       a_dcomplex *,
+                       eigs_reduce *,
+                       void *);
+int64_t eigs_basis_dapply(deigs_phi *,
+                          deigs_block_phi *,
+                          void *,
+                          a_int,
+                          a_int,
+                          const a_dcomplex *,
+                          a_dcomplex *,
+                          double *,
+                          eigs_reduce *,
+                          void *);
+a_int eigs_ncv(a_int,
+               a_int,
+               a_int);
+a_int eigs_nkeep(a_int,
+                 a_int,
+                 a_int);
+a_int eigs_block_ncv(a_int,
+                     a_int,
+                     a_int,
+                     a_int);
+a_int eigs_budget_ncv(const char *,
+                      void *,
+                      int32_t,
+                      int32_t,
+                      bool,
+                      const eigs_options *);
+size_t zgeigsf_bytes(a_int,
+                     a_int,
+                     a_int,
+                     const char *);
+size_t dgeigsf_bytes(a_int,
+                     a_int,
+                     a_int,
+                     const char *);
+size_t zheigsf_bytes(a_int,
+                     a_int,
+                     a_int,
+                     const char *);
+size_t dseigsf_bytes(a_int,
+                     a_int,
+                     a_int,
+                     const char *);
+size_t zheigsf_block_bytes(a_int,
+                           a_int,
+                           a_int,
+                           a_int,
+                           const char *);
+size_t zgeigsf_ks_bytes(a_int,
+                        a_int,
+                        a_int,
+                        const char *);
+size_t cgeigsf_bytes(a_int,
+                     a_int);
+size_t sgeigsf_bytes(a_int,
+                     a_int);
+size_t sseigsf_bytes(a_int,
+                     a_int);
+size_t eigs_mixed_bytes(const char *,
+                        int32_t,
+                        int32_t,
+                        int32_t,
+                        const char *);
+/* -------------------------------------------------------------------------- */
+
+
+/* --- Shift-invert for internal usage ------------------------------------- */
+typedef struct _EigsFactor {
+    double complex sigma;
+    int32_t n;
+    int32_t kd;            // Bandwidth (LU factors have 3*kd+1 diagonals)
+    bool complex_values;
+    const int32_t *perm;   // Ordering of the matrix
+    double *ab;            // LAPACK band storage (pairs of doubles if complex)
+    lapack_int *ipiv;
+    int32_t refs;          // Number of solves using the factorization
+    struct _EigsFactor *next;
+} eigs_factor;
+
+eigs_factor *eigs_factor_get(eigs_sparse *,
+                             double complex);
+void eigs_factor_release(eigs_sparse *,
+                         eigs_factor *);
+void eigs_factor_clear(eigs_sparse *);
+size_t eigs_factor_bytes(eigs_sparse *,
+                         double complex);
+typedef struct _EigsInverse {
+    const eigs_factor *factor;
+    double *b;             // Permuted right-hand side of this solve only (the
+                           // factorization is shared between threads)
+} eigs_inverse;
+
+void eigs_inverse_init(eigs_inverse *,
+                       const eigs_factor *);
+void eigs_inverse_destroy(eigs_inverse *);
+void eigs_factor_zsolve(void *,
+                        int32_t,
+                        const double complex *,
+                        double complex *);
+void eigs_factor_dsolve(void *,
+                        int32_t,
+                        const double *,
+                        double *);
+/* -------------------------------------------------------------------------- */
+
+
+/* --- Chebyshev filter for internal usage --------------------------------- */
+typedef struct _EigsChebyshev {
+    zeigs_phi *zphi;
+    deigs_phi *dphi;
+    void *phi_data;
+    int32_t n;
+    int32_t degree;
+    bool complex_values;
+    int64_t len;           // Length of vectors in doubles
+    double a;              // Damped interval [a, b]
+    double b;
+    double a0;             // Filter is one at a0 (wanted end of the spectrum)
+    double *w[3];
+} eigs_chebyshev;
+
+void eigs_chebyshev_init(eigs_chebyshev *,
+                         zeigs_phi *,
+                         deigs_phi *,
+                         void *,
+                         int32_t,
+                         int32_t,
+                         const char *,
+                         int32_t);
+void eigs_chebyshev_destroy(eigs_chebyshev *);
+size_t eigs_chebyshev_bytes(int32_t,
+                            int32_t,
+                            bool,
+                            size_t);
+void eigs_chebyshev_zphi(void *,
+                         int32_t,
+                         const double complex *,
+                         double complex *);
+void eigs_chebyshev_dphi(void *,
+                         int32_t,
+                         const double *,
+                         double *);
+void eigs_chebyshev_rayleigh(eigs_chebyshev *,
+                             eigs_result *,
+                             bool);
+/* -------------------------------------------------------------------------- */
+
+
+/* --- Vector kernels for internal usage ----------------------------------- */
+double eigs_ddot(int64_t,
+                 const double *,
+                 const double *);
+void eigs_daxpy(int64_t,
+                double,
+                const double *,
+                double *);
+double eigs_dnrm2_scale(int64_t,
+                        const double *,
+                        double *,
+                        double);
+double complex eigs_zdotc(int64_t,
+                          const double complex *,
+                          const double complex *);
+double eigs_znrm2_scale(int64_t,
+                        const double complex *,
+                        double complex *,
+                        double);
+void eigs_dcsr_rows(int32_t,
+                    const int64_t *,
+                    const int32_t *,
+                    const double *,
+                    const double *,
+                    double *);
+void eigs_zcsr_rows(int32_t,
+                    const int64_t *,
+                    const int32_t *,
+                    const double *,
+                    const double *,
+                    double *);
+double eigs_fddot_(const a_int *,
+                   const double *,
+                   const double *);
+double eigs_fdnrm2_(const a_int *,
+                    const double *);
+void eigs_fdaxpy_(const a_int *,
+                  const double *,
+                  const double *,
+                  double *);
+void eigs_fdscal_(const a_int *,
+                  const double *,
+                  double *);
+double complex eigs_fzdotc_(const a_int *,
+                            const double complex *,
+                            const double complex *);
+double eigs_fdznrm2_(const a_int *,
+                     const double complex *);
+const char *eigs_simd(void);
+/* -------------------------------------------------------------------------- */
+
+
+/* --- Thread pool for internal usage --------------------------------------- */
+typedef void eigs_pool_task(void *,
+                            int32_t,
+                            int32_t);
+
+int32_t eigs_pool_size(void);
+void eigs_pool_run(int32_t,
+                   eigs_pool_task *,
+                   void *);
 /* -------------------------------------------------------------------------- */
 
 #endif
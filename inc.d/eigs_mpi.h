@@ -0,0 +1,44 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Distributed-memory eigensolver *eigs_mpi* (library *eigs_mpi*).            *
+ *                                                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#ifndef EIGS_MPI_H
+#define EIGS_MPI_H
+
+#include <mpi.h>
+
+#include "eigs.h"
+
+
+eigs_result *eigs_mpi(MPI_Comm,
+                      const char *,
+                      zeigs_phi *,
+                      deigs_phi *,
+                      void *,
+                      int32_t,
+                      int32_t,
+                      const char *,
+                      int32_t,
+                      double,
+                      bool,
+                      const eigs_options *);
+/* -------------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,244 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Storage of the Krylov basis in memory or in a memory-mapped file and the   *
+ * operations on it shared by the Lanczos and Krylov-Schur engines            *
+ *                                                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "../inc.d/eigs.h"
+
+
+// Bytes in front of the basis holding its header (keeps the alignment)
+#define HEADER 64
+
+// Rows of the basis read ahead at once during a restart (basis in a file)
+#define PREFETCH_ROWS (16*EIGS_ROTATE_ROWS)
+
+
+// Header in front of the basis
+typedef struct _BasisHeader {
+    void *base;            // Start of the allocation or of the mapping
+    size_t size;           // Bytes of the mapping
+    bool mapped;
+} basis_header;
+
+
+// Krylov basis of "bytes" bytes in memory ("dir" is NULL) or in a file in the
+// directory "dir" mapped into memory (free with "eigs_basis_free"); the file
+// is removed at once, its blocks are freed with the mapping
+void *eigs_basis_alloc(size_t bytes, const char *dir) {
+
+    basis_header *h;
+    char *v;
+
+    if (!dir) {
+        char *base = (char *)eigs_malloc(HEADER+bytes);
+        v = base+HEADER;
+        h = (basis_header *)(v-HEADER);
+        h->base = base; h->size = 0; h->mapped = false;
+        return v;
+    }
+
+    // Anonymous file in "dir", the header goes to the end of the first page
+    size_t page = (size_t)sysconf(_SC_PAGESIZE), size = page+bytes;
+    size_t len = strlen(dir);
+    char *path = (char *)malloc(len+32);
+    sprintf(path, "%s/eigs_basis_XXXXXX", dir);
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        printf("EIGS_BASIS: CANNOT CREATE A FILE IN %s\n", dir); exit(1);
+    }
+    unlink(path);
+    free(path);
+    if (ftruncate(fd, (off_t)size)) {
+        printf("EIGS_BASIS: CANNOT RESIZE THE FILE IN %s\n", dir); exit(1);
+    }
+    char *base = (char *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                              fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        printf("EIGS_BASIS: CANNOT MAP THE FILE IN %s\n", dir); exit(1);
+    }
+
+    // Arnoldi/Lanczos steps stream through the leading columns
+    posix_madvise(base, size, POSIX_MADV_SEQUENTIAL);
+
+    v = base+page;
+    h = (basis_header *)(v-HEADER);
+    h->base = base; h->size = size; h->mapped = true;
+    return v;
+}
+
+// Free Krylov basis
+void eigs_basis_free(void *v) {
+    if (!v) return;
+    basis_header *h = (basis_header *)((char *)v-HEADER);
+    if (h->mapped) munmap(h->base, h->size);
+    else free(h->base);
+}
+
+// Basis is in a file
+bool eigs_basis_mapped(const void *v) {
+    return ((const basis_header *)((const char *)v-HEADER))->mapped;
+}
+
+// Bytes of memory (not of the file) taken by a basis of "bytes" bytes
+size_t eigs_basis_bytes(size_t bytes, const char *dir) {
+    return dir ? 0 : HEADER+bytes;
+}
+
+// Read ahead rows "first",...,first+len-1 (in bytes, up to the end of the
+// columns) of the columns j0,...,j0+ncols-1 with leading dimension "ld" (in
+// bytes) of a basis in a file
+void eigs_basis_prefetch(const void *v,
+                         size_t ld,
+                         a_int j0,
+                         a_int ncols,
+                         size_t first,
+                         size_t len) {
+
+    if ((first >= ld) || !eigs_basis_mapped(v)) return;
+    if (len > ld-first) len = ld-first;
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    for (a_int j=j0; j<j0+ncols; j++) {
+        uintptr_t a = (uintptr_t)v+(size_t)j*ld+first;
+        uintptr_t b = a+len;
+        a -= a%page;
+        posix_madvise((void *)a, b-a, POSIX_MADV_WILLNEED);
+    }
+}
+
+// V(:,j0:j0+l) = V(:,j0:j0+m) Q for a basis V with n rows, done in place in
+// blocks of EIGS_ROTATE_ROWS rows ("tmp" holds EIGS_ROTATE_ROWS x l)
+void eigs_basis_rotate(a_dcomplex *v,
+                       a_int n,
+                       a_int j0,
+                       a_int m,
+                       a_int l,
+                       const a_dcomplex *q,
+                       a_int ldq,
+                       a_dcomplex *tmp) {
+
+    a_int r0, nr, j;
+    a_dcomplex *vj = &v[(size_t)n*j0];
+    const a_dcomplex one = CMPLX(1., 0.), zero = CMPLX(0., 0.);
+
+    for (r0=0; r0<n; r0+=EIGS_ROTATE_ROWS) {
+        nr = (n-r0 < EIGS_ROTATE_ROWS) ? n-r0 : EIGS_ROTATE_ROWS;
+        if (r0%PREFETCH_ROWS == 0)
+            eigs_basis_prefetch(v, (size_t)n*sizeof(a_dcomplex), j0, m,
+                                (size_t)r0*sizeof(a_dcomplex),
+                                2*PREFETCH_ROWS*sizeof(a_dcomplex));
+        cblas_zgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nr, l, m,
+                    &one, &vj[r0], n, q, ldq, &zero, tmp, nr);
+        for (j=0; j<l; j++)
+            memcpy(&vj[(size_t)n*j+r0], &tmp[nr*j], nr*sizeof(a_dcomplex));
+    }
+}
+
+// Random basis vector j of V (n rows, the first j columns orthonormal): x is
+// filled at random (it may be column j), orthogonalized by two passes of
+// classical Gram-Schmidt ("c" holds j coefficients) and stored normalized in
+// column j; with "reduce" the basis is distributed and V holds the local rows
+void eigs_basis_random(a_dcomplex *v,
+                       a_int n,
+                       a_int j,
+                       a_int *iseed,
+                       a_dcomplex *x,
+                       a_dcomplex *c,
+                       eigs_reduce *reduce,
+                       void *reduce_data) {
+
+    a_int ldv = (n > 0) ? n : 1, pass, i;
+    const a_dcomplex one = CMPLX(1., 0.), mone = CMPLX(-1., 0.);
+    const a_dcomplex zero = CMPLX(0., 0.);
+
+    LAPACKE_zlarnv(2, iseed, n, x);
+    for (pass=0; (pass<2) && j; pass++) {
+        // An empty slice adds nothing, BLAS returns early without touching c
+        if (!n) memset(c, 0, j*sizeof(a_dcomplex));
+        cblas_zgemv(CblasColMajor, CblasConjTrans, n, j, &one, v, ldv, x, 1,
+                    &zero, c, 1);
+        if (reduce) reduce(reduce_data, c, j);
+        cblas_zgemv(CblasColMajor, CblasNoTrans, n, j, &mone, v, ldv, c, 1,
+                    &one, x, 1);
+    }
+
+    a_dcomplex *y = &v[(size_t)n*j];
+    if (!reduce) { eigs_znrm2_scale(n, x, y, 0.); return; }
+    a_dcomplex s = eigs_zdotc(n, x, x);
+    reduce(reduce_data, &s, 1);
+    double nrm = sqrt(creal(s));
+    for (i=0; i<n; i++) y[i] = x[i]/nrm;
+}
+
+// Action of a real map (or block map) on the nb columns x (leading dimension
+// n): it acts on the real and imaginary parts, column by column only on
+// those that do not vanish; a distributed map is collective, so with
+// "reduce" all processes decide on the whole columns and apply it the same
+// times ("split" holds 4 n nb doubles); returns the number of applications
+int64_t eigs_basis_dapply(deigs_phi *dphi,
+                          deigs_block_phi *dphi_block,
+                          void *phi_data,
+                          a_int n,
+                          a_int nb,
+                          const a_dcomplex *x,
+                          a_dcomplex *y,
+                          double *split,
+                          eigs_reduce *reduce,
+                          void *reduce_data) {
+
+    size_t nn = (size_t)n*nb, i;
+    double *xs = split, *ys = &split[2*nn];
+    int64_t napply = 0;
+    a_int a;
+
+    for (i=0; i<nn; i++) { xs[i] = creal(x[i]); xs[nn+i] = cimag(x[i]); }
+    if (dphi_block) {
+        dphi_block(phi_data, n, 2*nb, xs, ys);
+        napply = 2*nb;
+    } else {
+        for (a=0; a<2*nb; a++) {
+            bool zero = (a >= nb);
+            for (i=0; zero && (i<(size_t)n); i++)
+                zero = (xs[(size_t)n*a+i] == 0.);
+            if ((a >= nb) && reduce) {
+                a_dcomplex any = CMPLX(zero ? 0. : 1., 0.);
+                reduce(reduce_data, &any, 1);
+                zero = (creal(any) == 0.);
+            }
+            if (zero) {
+                memset(&ys[(size_t)n*a], 0, n*sizeof(double));
+            } else {
+                dphi(phi_data, n, &xs[(size_t)n*a], &ys[(size_t)n*a]);
+                napply++;
+            }
+        }
+    }
+    for (i=0; i<nn; i++) y[i] = CMPLX(ys[i], ys[nn+i]);
+
+    return napply;
+}
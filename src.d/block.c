@@ -0,0 +1,617 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Block thick-restart Lanczos solver for a few eigenvalues/-vectors of a     *
+ * hermitian (real symmetric) endomorphism, BLAS-3 orthogonalization          *
+ * -------------------------------------------------------------------------- */
+
+
+#include <math.h>
+
+#include "../inc.d/eigs.h"
+
+
+// Data for internal usage
+typedef struct _BlockData {
+
+    // User set
+    a_int n;
+    zeigs_phi *zphi;
+    deigs_phi *dphi;
+    zeigs_block_phi *zphi_block;
+    deigs_block_phi *dphi_block;
+    void *phi_data;
+    a_int nev;
+    a_int nb;           // Block size
+    const char *which;
+    bool evs;
+    double tol;
+    a_int ncv;          // Multiple of the block size
+    a_int nkeep_restart; // Number of Ritz vectors kept at restart
+    a_int mxiter;
+    a_int mode;
+    double sigma;
+
+    // Internal
+    a_dcomplex *v;      // Lanczos basis, n x (ncv+nb), column-major
+    a_dcomplex *w;      // Image of a block, n x nb
+    double *split;      // Real and imaginary parts for a real map, n x 4nb
+    double *wnorm;      // Norms of the columns of the image, length nb
+    a_dcomplex *h;      // Projection coefficients, (ncv+nb) x nb
+    a_dcomplex *c;      // Reorthogonalization coefficients, (ncv+nb) x nb
+    a_dcomplex *r;      // Residual block coefficients, nb x nb
+    a_dcomplex *tmp;    // Buffer for basis rotations, EIGS_ROTATE_ROWS x
+                        // ncv
+    a_dcomplex *t;      // Projected (hermitian) matrix, ncv x ncv
+    a_dcomplex *y;      // Eigenvectors of t, ncv x ncv
+    a_dcomplex *ysel;   // Selected Ritz vectors of t, ncv x ncv
+    double *theta;      // Ritz values, length ncv
+    double *res;        // Residual norms of the Ritz values, length ncv
+    a_int *order;       // Ritz values ordered by "which"
+    a_int nkeep;        // Number of Ritz vectors kept (zero at the start)
+    a_int nconv;
+    a_int iter;
+    a_int iseed[4];
+    double eps;
+    eigs_stats stats;   // Counters and timers
+
+    // Results
+    double *d;
+    a_dcomplex *z;
+
+} block_data;
+
+
+static block_data *block_alloc(a_int,
+                               a_int,
+                               a_int,
+                               a_int,
+                               const char *);
+static void block_init(block_data *,
+                       zeigs_phi *,
+                       deigs_phi *,
+                       zeigs_block_phi *,
+                       deigs_block_phi *,
+                       void *,
+                       const char *,
+                       bool,
+                       double,
+                       a_int,
+                       a_int,
+                       a_int,
+                       double);
+static void block_data_destroy(block_data *);
+static void lanczos_iterations(block_data *);
+static void expand(block_data *);
+static void apply(block_data *, const a_dcomplex *, a_dcomplex *);
+static void orthogonalize(block_data *, a_int, a_dcomplex *, a_int);
+static void normalize(block_data *, a_int, a_dcomplex *);
+static void ritz(block_data *);
+static void restart(block_data *);
+static void extract(block_data *, a_dcomplex *);
+static eigs_result *prepare_result(block_data *, eigs_result *, bool);
+
+
+// Eigenvalues and eigenvectors ("zphi" or "dphi" is NULL, a block map is
+// used instead of the map if not NULL)
+void zheigsf_block(a_int n,
+                   zeigs_phi *zphi,
+                   deigs_phi *dphi,
+                   zeigs_block_phi *zphi_block,
+                   deigs_block_phi *dphi_block,
+                   void *phi_data,
+                   bool evs,
+                   const char *which,
+                   a_int k,
+                   a_int nb,
+                   a_int ncv,
+                   a_int nkeep,
+                   double tol,
+                   a_int maxiter,
+                   a_int mode,
+                   double sigma,
+                   bool colmajor,
+                   const char *basis_dir,
+                   void **work,
+                   eigs_result *result) {
+
+    // Workspace (kept in "*work" for further solves if "work" is not NULL
+    // and neither the block size, the dimension of the subspace nor the
+    // storage of the basis change)
+    block_data *data = work ? (block_data *)*work : NULL;
+    if (data && ((data->nb != nb) ||
+                 (data->ncv != eigs_block_ncv(n, k, nb, ncv)) ||
+                 (eigs_basis_mapped(data->v) != (basis_dir != NULL)))) {
+        block_data_destroy(data);
+        data = NULL;
+    }
+    if (!data) data = block_alloc(n, k, nb, ncv, basis_dir);
+    if (work) *work = data;
+
+    // Initialize data
+    block_init(data,
+               zphi,
+               dphi,
+               zphi_block,
+               dphi_block,
+               phi_data,
+               which,
+               evs,
+               tol,
+               nkeep,
+               maxiter,
+               mode,
+               sigma);
+
+    // Lanczos iterations
+    lanczos_iterations(data);
+    result->stats = data->stats;
+
+    // Extract eigenvalues and (possibly) eigenvectors, column-major ones
+    // directly into the result
+    double t = eigs_clock();
+    extract(data, (evs && colmajor) ? result->eigvecs : data->z);
+
+    // Prepare result
+    prepare_result(data, result, colmajor);
+    result->stats.time_extract = eigs_clock()-t;
+
+    // Clean up
+    if (!work) block_data_destroy(data);
+}
+
+// Free workspace kept by "zheigsf_block"
+void zheigsf_block_free(void *work) {
+    if (work) block_data_destroy((block_data *)work);
+}
+
+// Dimension of the subspace: "ncv" if positive, otherwise max(2k+1, 20) plus
+// eight blocks for nb > 1 (a restart keeps half of the vectors beyond k, so
+// at least four block steps are left per restart for any block size),
+// rounded up to blocks such that the residual block fits as well
+a_int eigs_block_ncv(a_int n, a_int k, a_int nb, a_int ncv) {
+    a_int m = ncv;
+    if (m <= 0) {
+        m = (2*k+1 < 20) ? 20 : 2*k+1;
+        if (nb > 1) m += 8*nb;
+    }
+    m = nb*((m+nb-1)/nb);
+    if (m+nb > n) m = nb*((n-nb)/nb);
+    if (m < k+nb) {
+        printf("%s\n", "EIGS_BLOCK: BLOCK SIZE TOO LARGE FOR N AND K");
+        exit(1);
+    }
+    return m;
+}
+
+// Allocate memory for data
+static block_data *block_alloc(a_int n, a_int k, a_int nb, a_int ncv,
+                               const char *basis_dir) {
+
+    block_data *data = (block_data *)eigs_malloc(sizeof(block_data));
+    size_t nz = sizeof(a_dcomplex), nd = sizeof(double);
+
+    // Dimensions
+    data->n = n;
+    data->nev = k;
+    data->nb = nb;
+    data->ncv = eigs_block_ncv(n, k, nb, ncv);
+    a_int m = data->ncv;
+
+    // Internal
+    data->v = (a_dcomplex *)eigs_basis_alloc((size_t)n*(m+nb)*nz, basis_dir);
+    data->w = (a_dcomplex *)eigs_malloc((size_t)n*nb*nz);
+    data->split = (double *)eigs_malloc((size_t)4*n*nb*nd);
+    data->wnorm = (double *)eigs_malloc(nb*nd);
+    data->h = (a_dcomplex *)eigs_malloc((m+nb)*nb*nz);
+    data->c = (a_dcomplex *)eigs_malloc((m+nb)*nb*nz);
+    data->r = (a_dcomplex *)eigs_malloc(nb*nb*nz);
+    data->tmp = (a_dcomplex *)eigs_malloc(EIGS_ROTATE_ROWS*m*nz);
+    data->t = (a_dcomplex *)eigs_malloc(m*m*nz);
+    data->y = (a_dcomplex *)eigs_malloc(m*m*nz);
+    data->ysel = (a_dcomplex *)eigs_malloc(m*m*nz);
+    data->theta = (double *)eigs_malloc(m*nd);
+    data->res = (double *)eigs_malloc(m*nd);
+    data->order = (a_int *)eigs_malloc(m*sizeof(a_int));
+
+    // Results
+    data->d = (double *)eigs_malloc(k*nd);
+    data->z = (a_dcomplex *)eigs_malloc((size_t)n*k*nz);
+
+    return data;
+}
+
+// Bytes allocated by "block_alloc"
+size_t zheigsf_block_bytes(a_int n,
+                           a_int k,
+                           a_int nb,
+                           a_int ncv,
+                           const char *basis_dir) {
+    size_t nn = n, b = nb, m = eigs_block_ncv(n, k, nb, ncv);
+    size_t nz = sizeof(a_dcomplex), nd = sizeof(double);
+    return sizeof(block_data)
+           +(nn*b+2*(m+b)*b+b*b+EIGS_ROTATE_ROWS*m+3*m*m+nn*k)*nz
+           +(4*nn*b+b+2*m+k)*nd+m*sizeof(a_int)
+           +eigs_basis_bytes(nn*(m+b)*nz, basis_dir);
+}
+
+// Initialize eigenproblem
+static void block_init(block_data *data,
+                       zeigs_phi *zphi,
+                       deigs_phi *dphi,
+                       zeigs_block_phi *zphi_block,
+                       deigs_block_phi *dphi_block,
+                       void *phi_data,
+                       const char *which,
+                       bool evs,
+                       double tol,
+                       a_int nkeep,
+                       a_int maxiter,
+                       a_int mode,
+                       double sigma) {
+
+    // Check which
+    if (strcmp(which, "LA") && strcmp(which, "LR") &&
+        strcmp(which, "SA") && strcmp(which, "SR") &&
+        strcmp(which, "LM") && strcmp(which, "SM")) {
+        printf("EIGS_BLOCK: WHICH = %s NOT SUPPORTED\n", which);
+        exit(1);
+    }
+
+    // User set
+    data->zphi = zphi;
+    data->dphi = dphi;
+    data->zphi_block = zphi_block;
+    data->dphi_block = dphi_block;
+    data->which = which;
+    data->evs = evs;
+    data->eps = LAPACKE_dlamch('E');
+    data->tol = (tol > 0.) ? tol : data->eps; // Default machine precision
+    data->nkeep_restart = eigs_nkeep(data->nev, data->ncv, nkeep);
+    if (data->nkeep_restart > data->ncv-data->nb)
+        data->nkeep_restart = data->ncv-data->nb;
+    data->mxiter = maxiter; // Default 10*n
+    data->phi_data = phi_data; // Default NULL
+    data->mode = mode; // 1 (regular) or 3 (shift-invert, phi is the inverse)
+    data->sigma = sigma; // Only referenced if mode is 3
+
+    // Internal
+    memset(data->t, 0, data->ncv*data->ncv*sizeof(a_dcomplex));
+    data->nkeep = 0;
+    data->nconv = 0;
+    data->iter = 0;
+    memset(&data->stats, 0, sizeof(eigs_stats));
+    data->iseed[0] = 1; data->iseed[1] = 3;
+    data->iseed[2] = 5; data->iseed[3] = 7;
+
+    // Random starting block (real for a real map, the basis stays real as
+    // long as the projected matrix does)
+    LAPACKE_zlarnv(2, data->iseed, data->n*data->nb, data->v);
+    if (dphi) {
+        a_int i;
+        for (i=0; i<data->n*data->nb; i++)
+            data->v[i] = CMPLX(creal(data->v[i]), 0.);
+    }
+    normalize(data, 0, data->r);
+}
+
+// Free for block_data type
+static void block_data_destroy(block_data *data) {
+    eigs_basis_free(data->v); data->v = NULL;
+    free(data->w); data->w = NULL;
+    free(data->split); data->split = NULL;
+    free(data->wnorm); data->wnorm = NULL;
+    free(data->h); data->h = NULL;
+    free(data->c); data->c = NULL;
+    free(data->r); data->r = NULL;
+    free(data->tmp); data->tmp = NULL;
+    free(data->t); data->t = NULL;
+    free(data->y); data->y = NULL;
+    free(data->ysel); data->ysel = NULL;
+    free(data->theta); data->theta = NULL;
+    free(data->res); data->res = NULL;
+    free(data->order); data->order = NULL;
+    free(data->d); data->d = NULL;
+    free(data->z); data->z = NULL;
+    free(data);
+}
+
+// Do block thick-restart Lanczos iterations
+static void lanczos_iterations(block_data *data) {
+
+    double t;
+
+    for (data->iter=1; data->iter<=data->mxiter; data->iter++) {
+
+        // Extend the basis to ncv vectors
+        expand(data);
+
+        // Ritz values and their residuals
+        t = eigs_clock();
+        ritz(data);
+        data->stats.nconv = data->nconv;
+        if (data->nconv >= data->nev) {
+            data->stats.time_restart += eigs_clock()-t;
+            return;
+        }
+
+        // Keep the best Ritz vectors and start over
+        restart(data);
+        data->stats.nrestart++;
+        data->stats.time_restart += eigs_clock()-t;
+    }
+
+    printf("%s\n", "EIGS_BLOCK: MAXIMAL ALLOWED ITERATIONS REACHED");
+    exit(1);
+}
+
+// Block Lanczos steps nkeep,...,ncv-1 (with full reorthogonalization), the
+// basis grows by one block of nb vectors per step
+static void expand(block_data *data) {
+
+    a_int n = data->n, m = data->ncv, nb = data->nb, ld = m+nb;
+    a_int j, a, p;
+    double t0 = eigs_clock(), t, tphi = 0.;
+
+    for (j=data->nkeep; j<m; j+=nb) {
+
+        // Compute action of phi on the block v_j,...,v_j+nb-1
+        t = eigs_clock();
+        apply(data, &data->v[(size_t)n*j], data->w);
+        tphi += eigs_clock()-t;
+        data->stats.nmatvec += nb;
+        for (a=0; a<nb; a++)
+            data->wnorm[a] = eigs_znrm2_scale(n, &data->w[(size_t)n*a], NULL,
+                                              0.);
+
+        // Orthogonalize against v_0,...,v_j+nb-1
+        orthogonalize(data, j+nb, data->w, nb);
+        data->stats.nreorth += nb;
+
+        // Diagonal block of the projected matrix (made exactly hermitian),
+        // the coefficients of the previous blocks vanish up to rounding and
+        // are known from the previous step (or the restart)
+        for (a=0; a<nb; a++) {
+            for (p=0; p<nb; p++)
+                data->t[m*(j+a)+j+p] = 0.5*(data->h[ld*a+j+p]
+                                            +conj(data->h[ld*p+j+a]));
+        }
+
+        // Next block (or the residual block) and its coefficients
+        memcpy(&data->v[(size_t)n*(j+nb)], data->w,
+               (size_t)n*nb*sizeof(a_dcomplex));
+        normalize(data, j+nb, data->r);
+        if (j+nb < m) {
+            for (a=0; a<nb; a++) for (p=0; p<nb; p++) {
+                data->t[m*(j+a)+j+nb+p] = data->r[nb*a+p];
+                data->t[m*(j+nb+p)+j+a] = conj(data->r[nb*a+p]);
+            }
+        }
+    }
+
+    data->stats.time_phi += tphi;
+    data->stats.time_orth += eigs_clock()-t0-tphi;
+}
+
+// Action of the map on a block of nb columns x (column-major, leading
+// dimension n): the block map if given, otherwise column by column; a real
+// map acts on the real and imaginary parts (column by column only on those
+// that do not vanish)
+static void apply(block_data *data, const a_dcomplex *x, a_dcomplex *y) {
+
+    a_int n = data->n, nb = data->nb, a;
+
+    if (data->zphi_block) {
+        data->zphi_block(data->phi_data, n, nb, x, y);
+    } else
+    if (data->zphi) {
+        for (a=0; a<nb; a++)
+            data->zphi(data->phi_data, n, &x[(size_t)n*a], &y[(size_t)n*a]);
+    } else {
+        eigs_basis_dapply(data->dphi, data->dphi_block, data->phi_data, n, nb,
+                          x, y, data->split, NULL, NULL);
+    }
+}
+
+// Block classical Gram-Schmidt with one reorthogonalization (CGS2) of the
+// "nw" columns of w against the first "nv" basis vectors by matrix products,
+// the coefficients are stored in h ((ncv+nb) x nw)
+static void orthogonalize(block_data *data, a_int nv, a_dcomplex *w, a_int nw) {
+
+    a_int n = data->n, ld = data->ncv+data->nb, i, a;
+    const a_dcomplex one = CMPLX(1., 0.), mone = CMPLX(-1., 0.);
+    const a_dcomplex zero = CMPLX(0., 0.);
+
+    // First pass: H = V^H W, W = W - V H
+    cblas_zgemm(CblasColMajor, CblasConjTrans, CblasNoTrans, nv, nw, n, &one,
+                data->v, n, w, n, &zero, data->h, ld);
+    cblas_zgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, nw, nv, &mone,
+                data->v, n, data->h, ld, &one, w, n);
+
+    // Second pass: C = V^H W, W = W - V C, H = H + C
+    cblas_zgemm(CblasColMajor, CblasConjTrans, CblasNoTrans, nv, nw, n, &one,
+                data->v, n, w, n, &zero, data->c, ld);
+    cblas_zgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, nw, nv, &mone,
+                data->v, n, data->c, ld, &one, w, n);
+    for (a=0; a<nw; a++)
+        for (i=0; i<nv; i++) data->h[ld*a+i] += data->c[ld*a+i];
+}
+
+// Orthonormalize the block v_j,...,v_j+nb-1 (already orthogonal to the
+// previous basis vectors) column by column, v_j+a = sum_p v_j+p r_pa with
+// the upper triangular nb x nb matrix r; a column that vanishes is replaced
+// by a random vector (invariant subspace) and its row of r is zero
+static void normalize(block_data *data, a_int j, a_dcomplex *r) {
+
+    a_int n = data->n, nb = data->nb, a, p;
+    a_dcomplex *x, *q = &data->v[(size_t)n*j];
+    const a_dcomplex one = CMPLX(1., 0.), mone = CMPLX(-1., 0.);
+    const a_dcomplex zero = CMPLX(0., 0.);
+    double nrm, scale;
+
+    memset(r, 0, nb*nb*sizeof(a_dcomplex));
+    for (a=0; a<nb; a++) {
+        x = &q[(size_t)n*a];
+        scale = (j > 0) ? data->wnorm[a] : eigs_znrm2_scale(n, x, NULL, 0.);
+
+        // Against the previous columns of the block (two passes)
+        if (a) {
+            cblas_zgemv(CblasColMajor, CblasConjTrans, n, a, &one, q, n, x, 1,
+                        &zero, data->c, 1);
+            cblas_zgemv(CblasColMajor, CblasNoTrans, n, a, &mone, q, n,
+                        data->c, 1, &one, x, 1);
+            for (p=0; p<a; p++) r[nb*a+p] = data->c[p];
+            cblas_zgemv(CblasColMajor, CblasConjTrans, n, a, &one, q, n, x, 1,
+                        &zero, data->c, 1);
+            cblas_zgemv(CblasColMajor, CblasNoTrans, n, a, &mone, q, n,
+                        data->c, 1, &one, x, 1);
+            for (p=0; p<a; p++) r[nb*a+p] += data->c[p];
+        }
+
+        nrm = eigs_znrm2_scale(n, x, x, data->eps*scale);
+        if (nrm <= data->eps*scale)
+            eigs_basis_random(data->v, n, j+a, data->iseed, x, data->c, NULL,
+                              NULL);
+        else r[nb*a+a] = CMPLX(nrm, 0.);
+    }
+}
+
+// Ritz values, ordering by "which" and number of converged Ritz values
+static void ritz(block_data *data) {
+
+    a_int m = data->ncv, nb = data->nb, i, j, l;
+    double eps23 = pow(data->eps, 2./3.), tol;
+    const char *which = data->which;
+    const a_dcomplex one = CMPLX(1., 0.), zero = CMPLX(0., 0.);
+
+    // Eigenvalues (ascending) and eigenvectors of t
+    memcpy(data->y, data->t, m*m*sizeof(a_dcomplex));
+    lapack_int info = LAPACKE_zheev(LAPACK_COL_MAJOR, 'V', 'U', m, data->y,
+                                    m, data->theta);
+    if (info) {
+        printf("EIGS_BLOCK: LAPACKE_zheev FAILED: INFO = %d\n", info);
+        exit(1);
+    }
+
+    // Residual norms |R y_l(ncv-nb:ncv)|, R y is stored in ysel
+    cblas_zgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nb, m, nb, &one,
+                data->r, nb, &data->y[m-nb], m, &zero, data->ysel, nb);
+    for (l=0; l<m; l++)
+        data->res[l] = cblas_dznrm2(nb, &data->ysel[nb*l], 1);
+
+    // Order by which (insertion sort, ncv is small)
+    for (i=0; i<m; i++) {
+        if (!strcmp(which, "LA") || !strcmp(which, "LR"))
+            data->order[i] = m-1-i;
+        else
+            data->order[i] = i;
+    }
+    if (!strcmp(which, "LM") || !strcmp(which, "SM")) {
+        bool largest = !strcmp(which, "LM");
+        for (i=1; i<m; i++) {
+            l = data->order[i];
+            for (j=i; j>0; j--) {
+                double a = fabs(data->theta[data->order[j-1]]);
+                double b = fabs(data->theta[l]);
+                if (largest ? (a >= b) : (a <= b)) break;
+                data->order[j] = data->order[j-1];
+            }
+            data->order[j] = l;
+        }
+    }
+
+    // Converged wanted Ritz values (same criterion as ARPACK)
+    data->nconv = 0;
+    for (i=0; i<data->nev; i++) {
+        l = data->order[i];
+        tol = data->tol*fmax(eps23, fabs(data->theta[l]));
+        if (data->res[l] <= tol) data->nconv++;
+    }
+}
+
+// Thick restart with the nkeep most wanted Ritz vectors (ncv-nkeep is a
+// multiple of the block size)
+static void restart(block_data *data) {
+
+    a_int n = data->n, m = data->ncv, nb = data->nb, nkeep, i, a, l;
+    const a_dcomplex one = CMPLX(1., 0.), zero = CMPLX(0., 0.);
+
+    // Number of kept Ritz vectors (at most ncv-nb, at least one block step)
+    nkeep = m-nb*((m-data->nkeep_restart)/nb);
+
+    // Rotate basis: (v_0,...,v_nkeep-1) = V Y_kept
+    for (i=0; i<nkeep; i++) {
+        l = data->order[i];
+        memcpy(&data->ysel[m*i], &data->y[m*l], m*sizeof(a_dcomplex));
+    }
+    eigs_basis_rotate(data->v, data->n, 0, m, nkeep, data->ysel, m,
+                      data->tmp);
+
+    // The residual block becomes v_nkeep,...,v_nkeep+nb-1
+    memmove(&data->v[(size_t)n*nkeep], &data->v[(size_t)n*m],
+            (size_t)n*nb*sizeof(a_dcomplex));
+
+    // Projected matrix is diagonal plus an arrow of nb rows/columns with the
+    // coupling R y_l(ncv-nb:ncv)
+    memset(data->t, 0, m*m*sizeof(a_dcomplex));
+    cblas_zgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, nb, nkeep, nb,
+                &one, data->r, nb, &data->ysel[m-nb], m, &zero, data->h, nb);
+    for (i=0; i<nkeep; i++) {
+        l = data->order[i];
+        data->t[m*i+i] = CMPLX(data->theta[l], 0.);
+        for (a=0; a<nb; a++) {
+            data->t[m*i+nkeep+a] = data->h[nb*i+a];
+            data->t[m*(nkeep+a)+i] = conj(data->h[nb*i+a]);
+        }
+    }
+    data->nkeep = nkeep;
+}
+
+// Extract eigenvalues and (possiby) eigenvectors
+static void extract(block_data *data, a_dcomplex *z) {
+
+    a_int n = data->n, m = data->ncv, i, l;
+    const a_dcomplex one = CMPLX(1., 0.), zero = CMPLX(0., 0.);
+
+    for (i=0; i<data->nev; i++) data->d[i] = data->theta[data->order[i]];
+
+    // Shift-invert: theta = 1/(lambda-sigma)
+    if (data->mode == 3)
+        for (i=0; i<data->nev; i++) data->d[i] = data->sigma+1./data->d[i];
+
+    if (data->evs) {
+        for (i=0; i<data->nev; i++) {
+            l = data->order[i];
+            memcpy(&data->ysel[m*i], &data->y[m*l], m*sizeof(a_dcomplex));
+        }
+        cblas_zgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n,
+                    data->nev, m, &one, data->v, n, data->ysel, m, &zero,
+                    z, n);
+    }
+}
+
+// Load data into result (eigenvectors row-major unless "colmajor")
+static eigs_result *prepare_result(block_data *data,
+                                   eigs_result *result,
+                                   bool colmajor) {
+    a_int n, k, j;
+    n = data->n; k = data->nev;
+    result->n = n; result->k = k;
+    for (j=0; j<k; j++) result->eigvals[j] = CMPLX(data->d[j], 0.);
+    if (data->evs && !colmajor)
+        eigs_zvecs(n, k, data->z, result->eigvecs, false, false);
+    return result;
+}
@@ -0,0 +1,63 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LAPACK based solver for all float complex eigenvalues/-vectors of a        *
+ * general matrix                                                             *
+ *                                                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#include "../inc.d/eigs.h"
+
+
+// Eigenvalues and eigenvectors (the row-major input read as column-major is
+// the transposed matrix, whose left eigenvectors are the complex conjugated
+// right eigenvectors of the matrix)
+void cgeigsa(uint32_t n,
+             const float complex *phi,
+             bool evs,
+             eigs_fresult *result) {
+
+    // Copy input, LAPACK overwrites it
+    float complex *a, *vl = NULL;
+    a = (float complex *)malloc((size_t)n*n*sizeof(float complex));
+    memcpy(a, phi, (size_t)n*n*sizeof(float complex));
+    if (evs) vl = (float complex *)malloc((size_t)n*n*sizeof(float complex));
+
+    // Solve eigenproblem using LAPACK
+    lapack_int info = LAPACKE_cgeev(LAPACK_COL_MAJOR,
+                                    evs ? 'V' : 'N',
+                                    'N',
+                                    n,
+                                    a,
+                                    n,
+                                    result->eigvals,
+                                    vl,
+                                    evs ? n : 1,
+                                    NULL,
+                                    1);
+
+    // Check result
+    if (info) {
+        printf("%s\n", "EIGS: LAPACKE_cgeev did not converge"); exit(1);
+    }
+
+    // Check if eigenvectors are desired
+    if (evs) eigs_cvecs(n, n, vl, result->eigvecs, false, true);
+
+    // Clean up
+    free(a); free(vl);
+}
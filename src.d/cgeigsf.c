@@ -0,0 +1,313 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * ARPACK based solver for a few eigenvalues/-vectors of a general float      *
+ * complex endomorphism                                                       *
+ * -------------------------------------------------------------------------- */
+
+
+#include "../inc.d/eigs.h"
+
+
+// Data for internal usage
+typedef struct _CgeigsfData {
+
+    // User set
+    a_int n;
+    ceigs_phi *phi;
+    void *phi_data;
+    a_int nev;
+    const char *which;
+    bool evs;
+    float tol;
+    a_int ncv;
+    a_int mxiter;
+
+    // Internal
+    a_int ido;
+    const char *bmat;
+    a_fcomplex *resid;
+    a_fcomplex *v;
+    a_int ldv;
+    a_int *iparam;
+    a_int *ipntr;
+    a_fcomplex *workd;
+    a_int lworkl;
+    a_fcomplex *workl;
+    float *rwork;
+    a_int info;
+    a_int ldz;
+    a_fcomplex *workev;
+    a_int *select;
+
+    // Results
+    a_fcomplex *d;
+    a_fcomplex *z;
+
+} cgeigsf_data;
+
+
+static cgeigsf_data *cgeigsf_alloc(a_int,
+                                   a_int);
+static void cgeigsf_init(cgeigsf_data *,
+                         ceigs_phi *,
+                         void *,
+                         const char *,
+                         bool,
+                         float,
+                         a_int);
+static void cgeigsf_data_destroy(cgeigsf_data *);
+static void arnoldi_iterations(cgeigsf_data *);
+static void iterate(cgeigsf_data *);
+static void extract(cgeigsf_data *);
+static eigs_fresult *prepare_result(cgeigsf_data *, eigs_fresult *);
+
+
+// Eigenvalues and eigenvectors
+void cgeigsf(a_int n,
+             ceigs_phi *phi,
+             void *phi_data,
+             bool evs,
+             const char *which,
+             a_int k,
+             float tol,
+             a_int maxiter,
+             eigs_fresult *result) {
+
+    // Allocate memory
+    cgeigsf_data *data = cgeigsf_alloc(n, k);
+
+    // Initialize data
+    cgeigsf_init(data,
+                 phi,
+                 phi_data,
+                 which,
+                 evs,
+                 tol,
+                 maxiter);
+
+    // Arnoldi iterations
+    arnoldi_iterations(data);
+
+    // Extract eigenvalues and (possibly) eigenvectors
+    extract(data);
+
+    // Prepare result
+    prepare_result(data, result);
+
+    // Clean up
+    cgeigsf_data_destroy(data);
+}
+
+// Allocate memory for data
+static cgeigsf_data *cgeigsf_alloc(a_int n, a_int k) {
+
+    cgeigsf_data *data = (cgeigsf_data *)eigs_malloc(sizeof(cgeigsf_data));
+    size_t nz = sizeof(a_fcomplex);
+
+    // Dimensions
+    data->n = n;
+    data->nev = k;
+    if ((data->ncv = 2*k+1) < 20) data->ncv = 20;
+    if (data->ncv > n) data->ncv = n;
+    data->ldv = n;
+    data->lworkl = 3*data->ncv*(data->ncv+2);
+    data->ldz = n;
+
+    // Internal
+    data->resid = (a_fcomplex *)eigs_malloc(n*nz);
+    data->v = (a_fcomplex *)eigs_malloc((size_t)n*data->ncv*nz);
+    data->iparam = (a_int *)eigs_malloc(11*sizeof(a_int));
+    data->ipntr = (a_int *)eigs_malloc(14*sizeof(a_int));
+    data->workd = (a_fcomplex *)eigs_malloc(3*(size_t)n*nz);
+    data->workl = (a_fcomplex *)eigs_malloc(data->lworkl*nz);
+    data->rwork = (float *)eigs_malloc(data->ncv*sizeof(float));
+    data->workev = (a_fcomplex *)eigs_malloc(3*data->ncv*nz);
+    data->select = (a_int *)eigs_malloc(data->ncv*sizeof(a_int));
+
+    // Results
+    data->d = (a_fcomplex *)eigs_malloc((data->nev+1)*nz);
+    data->z = (a_fcomplex *)eigs_malloc((size_t)n*data->nev*nz);
+
+    return data;
+}
+
+// Bytes allocated by "cgeigsf_alloc"
+size_t cgeigsf_bytes(a_int n, a_int k) {
+    size_t nn = n, m = (2*k+1 < 20) ? 20 : 2*k+1, nz = sizeof(a_fcomplex);
+    if (m > nn) m = nn;
+    return sizeof(cgeigsf_data)+(4*nn+nn*m+nn*k+3*m*(m+2)+3*m+k+1)*nz
+           +m*sizeof(float)+(25+m)*sizeof(a_int);
+}
+
+// Initialize eigenproblem
+static void cgeigsf_init(cgeigsf_data *data,
+                         ceigs_phi *phi,
+                         void *phi_data,
+                         const char *which,
+                         bool evs,
+                         float tol,
+                         a_int maxiter) {
+
+    // User set
+    data->phi = phi;
+    data->which = which;
+    data->evs = evs;
+    data->tol = tol; // Default 0. (machine precision)
+    data->mxiter = maxiter; // Default 10*n
+    data->phi_data = phi_data; // Default NULL
+
+    // Internal
+    data->ido = 0;
+    data->bmat = "I";
+    memset(data->iparam, 0, 11*sizeof(a_int));
+    data->iparam[0] = 1;
+    data->iparam[2] = maxiter;
+    data->iparam[3] = 1;
+    data->iparam[6] = 1; // Regular mode
+    memset(data->ipntr, 0, 14*sizeof(a_int));
+    memset(data->select, 0, data->ncv*sizeof(a_int));
+    data->info = 0;
+}
+
+// Free for ceigsf_data type
+static void cgeigsf_data_destroy(cgeigsf_data *data) {
+    free(data->resid); data->resid = NULL;
+    free(data->v); data->v = NULL;
+    free(data->iparam); data->iparam = NULL;
+    free(data->ipntr); data->ipntr = NULL;
+    free(data->workd); data->workd = NULL;
+    free(data->workl); data->workl = NULL;
+    free(data->rwork); data->rwork = NULL;
+    free(data->workev); data->workev = NULL;
+    free(data->select); data->select = NULL;
+    free(data->d); data->d = NULL;
+    free(data->z); data->z = NULL;
+    free(data);
+}
+
+// Do Arnoldi iterations
+static void arnoldi_iterations(cgeigsf_data *data) {
+
+    // Arnoldi iterations
+    do {
+        iterate(data);
+    } while ((data->ido == 1) || (data->ido == -1));
+
+    // Check for errors
+    if (data->ido != 99) {
+        printf("%s\n", "CEIGSF: ARNOLDI PROCESS DID NOT CONVERGE");
+        exit(1);
+    }
+}
+
+// Do a single Arnoldi iteration
+static void iterate(cgeigsf_data *data) {
+
+    // Call CNAUPD
+    cnaupd_c(&data->ido,
+             data->bmat,
+             data->n,
+             data->which,
+             data->nev,
+             data->tol,
+             data->resid,
+             data->ncv,
+             data->v,
+             data->ldv,
+             data->iparam,
+             data->ipntr,
+             data->workd,
+             data->workl,
+             data->lworkl,
+             data->rwork,
+             &data->info);
+
+    // Check for errors
+    int nerror = 0;
+    if ((data->ido != 1) && (data->ido != -1) && (data->ido != 99)) {
+        printf("CEIGSF: ERROR DURING ITERATION: IDO = %d\n", data->ido);
+        nerror++;
+    }
+    if ((data->info != 0) && (data->info != 1)) {
+        printf("CEIGSF: ERROR DURING ITERATION: INFO = %d\n", data->info);
+        nerror++;
+    }
+    if (data->info == 1) {
+        printf("%s\n", "CEIGSF: MAXIMAL ALLOWED ITERATIONS REACHED");
+        nerror++;
+    }
+    if (nerror) exit(1);
+
+    // Compute action of phi
+    a_int xpntr = data->ipntr[0]-1;
+    a_int ypntr = data->ipntr[1]-1;
+    data->phi(data->phi_data,
+              data->n,
+              &(data->workd[xpntr]),
+              &(data->workd[ypntr]));
+}
+
+// Extract eigenvalues and (possiby) eigenvectors
+static void extract(cgeigsf_data *data) {
+
+    // For internal use
+    const char *howmny = "A"; // Ritz vectors (not Schur vectors)
+    a_fcomplex sigma = CMPLXF(0., 0.); // Not referenced in regular mode
+
+    // Call CNEUPD
+    cneupd_c(data->evs,
+             howmny,
+             data->select,
+             data->d,
+             data->z,
+             data->ldz,
+             sigma,
+             data->workev,
+             data->bmat,
+             data->n,
+             data->which,
+             data->nev,
+             data->tol,
+             data->resid,
+             data->ncv,
+             data->v,
+             data->ldv,
+             data->iparam,
+             data->ipntr,
+             data->workd,
+             data->workl,
+             data->lworkl,
+             data->rwork,
+             &data->info);
+
+    // Check for errors
+    if (data->info) {
+        printf("CEIGSF: COULD NOT EXTRACT RESULTS: INFO = %d\n", data->info);
+        exit(1);
+    }
+}
+
+// Load data into result and reorder it to row major
+static eigs_fresult *prepare_result(cgeigsf_data *data,
+                                    eigs_fresult *result) {
+    a_int n, k, j;
+    n = data->n; k = data->nev;
+    result->n = n; result->k = k;
+    for (j=0; j<k; j++) result->eigvals[j] = data->d[j];
+    if (data->evs) eigs_cvecs(n, k, data->z, result->eigvecs, false, false);
+    return result;
+}
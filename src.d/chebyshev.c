@@ -0,0 +1,217 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Chebyshev polynomial filter for hermitian (symmetric) maps                 *
+ *                                                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#include <math.h>
+
+#include "../inc.d/eigs.h"
+
+
+// Minimal number of Lanczos steps for the estimation of the spectral bounds
+#define BOUNDS_STEPS 20
+
+
+static void bounds(eigs_chebyshev *, int32_t, bool);
+static void apply(eigs_chebyshev *, const double *, double *);
+static void filter(eigs_chebyshev *, const double *, double *);
+
+
+// Estimate spectral bounds and set up the filter of the given degree, which
+// damps the unwanted part of the spectrum; the wanted eigenvalues become the
+// largest algebraic ones of the filtered map
+void eigs_chebyshev_init(eigs_chebyshev *f,
+                         zeigs_phi *zphi,
+                         deigs_phi *dphi,
+                         void *phi_data,
+                         int32_t n,
+                         int32_t k,
+                         const char *which,
+                         int32_t degree) {
+
+    bool largest = false;
+    if (!strcmp(which, "LA") || !strcmp(which, "LR")) {
+        largest = true;
+    } else
+    if (strcmp(which, "SA") && strcmp(which, "SR")) {
+        printf("EIGS_CHEBYSHEV: WHICH = %s NOT SUPPORTED\n", which);
+        exit(1);
+    }
+
+    f->zphi = zphi; f->dphi = dphi; f->phi_data = phi_data;
+    f->n = n; f->degree = degree;
+    f->complex_values = (zphi != NULL);
+
+    // Complex vectors are treated as real ones of twice the length, the map
+    // stays symmetric with respect to the real part of the inner product
+    f->len = f->complex_values ? 2*(int64_t)n : n;
+    for (int32_t i=0; i<3; i++)
+        f->w[i] = (double *)malloc(f->len*sizeof(double));
+
+    bounds(f, k, largest);
+}
+
+// Bytes of the filter while a solve allocating "solve" bytes runs with it
+// (the Lanczos steps of the bounds are freed before the solve starts)
+size_t eigs_chebyshev_bytes(int32_t n,
+                            int32_t k,
+                            bool complex_values,
+                            size_t solve) {
+    size_t len = complex_values ? 2*(size_t)n : (size_t)n;
+    size_t m = 2*(size_t)k+BOUNDS_STEPS;
+    if (m > (size_t)n) m = n;
+    size_t stage = (len*(m+1)+2*m)*sizeof(double);
+    return 3*len*sizeof(double)+((stage > solve) ? stage : solve);
+}
+
+// Free for eigs_chebyshev type
+void eigs_chebyshev_destroy(eigs_chebyshev *f) {
+    for (int32_t i=0; i<3; i++) { free(f->w[i]); f->w[i] = NULL; }
+}
+
+// Filtered action for double complex maps (use as "zphi" with "phi_data"
+// being the filter)
+void eigs_chebyshev_zphi(void *f,
+                         int32_t n,
+                         const double complex *x,
+                         double complex *y) {
+    (void)n;
+    filter((eigs_chebyshev *)f, (const double *)x, (double *)y);
+}
+
+// Filtered action for double maps (use as "dphi" with "phi_data" being the
+// filter)
+void eigs_chebyshev_dphi(void *f, int32_t n, const double *x, double *y) {
+    (void)n;
+    filter((eigs_chebyshev *)f, x, y);
+}
+
+// Replace the eigenvalues of the filtered map by the Rayleigh quotients of
+// the (row-major or column-major) eigenvectors with the original map
+void eigs_chebyshev_rayleigh(eigs_chebyshev *f,
+                             eigs_result *result,
+                             bool colmajor) {
+
+    int32_t n = f->n, k = result->k, i, j;
+    double *x = f->w[0], *y = f->w[1];
+    double complex v;
+
+    for (j=0; j<k; j++) {
+        for (i=0; i<n; i++) {
+            v = colmajor ? result->eigvecs[(int64_t)n*j+i]
+                         : result->eigvecs[(int64_t)k*i+j];
+            if (f->complex_values) {
+                x[2*i] = creal(v);
+                x[2*i+1] = cimag(v);
+            } else {
+                x[i] = creal(v);
+            }
+        }
+        apply(f, x, y);
+        result->eigvals[j] = CMPLX(eigs_ddot(f->len, x, y)
+                                   /eigs_ddot(f->len, x, x), 0.);
+    }
+}
+
+// Lanczos with full reorthogonalization for a few steps; the Ritz value next
+// to the k wanted ones is the end of the damped interval, the other end is
+// pushed beyond the spectrum by the last residual norm
+static void bounds(eigs_chebyshev *f, int32_t k, bool largest) {
+
+    int64_t len = f->len;
+    int32_t m = 2*k+BOUNDS_STEPS, i, j;
+    if (m > f->n) m = f->n;
+
+    double *v = (double *)malloc(len*(m+1)*sizeof(double));
+    double *alpha = (double *)malloc(m*sizeof(double));
+    double *beta = (double *)calloc(m, sizeof(double));
+    lapack_int iseed[4] = {1, 3, 5, 7};
+
+    // Random start vector
+    LAPACKE_dlarnv(2, iseed, len, v);
+    eigs_dnrm2_scale(len, v, v, 0.);
+
+    for (j=0; j<m; j++) {
+        double *vj = &v[len*j], *w = &v[len*(j+1)];
+        apply(f, vj, w);
+        alpha[j] = eigs_ddot(len, vj, w);
+        for (i=0; i<=j; i++)
+            eigs_daxpy(len, -eigs_ddot(len, &v[len*i], w), &v[len*i], w);
+        beta[j] = eigs_dnrm2_scale(len, w, w, 1e-12*fabs(alpha[j]));
+
+        // Invariant subspace: Ritz values are eigenvalues
+        if (beta[j] <= 1e-12*fabs(alpha[j])) { m = j+1; break; }
+    }
+
+    // Ritz values (ascending)
+    double margin = beta[m-1];
+    lapack_int info = LAPACKE_dstev(LAPACK_COL_MAJOR, 'N', m, alpha, beta,
+                                    NULL, 1);
+    if (info) {
+        printf("EIGS_CHEBYSHEV: LAPACKE_dstev FAILED: INFO = %d\n", info);
+        exit(1);
+    }
+    if (k > m-1) k = m-1;
+    if (largest) {
+        f->a = alpha[0]-margin; f->b = alpha[m-1-k]; f->a0 = alpha[m-1];
+    } else {
+        f->a = alpha[k]; f->b = alpha[m-1]+margin; f->a0 = alpha[0];
+    }
+    if (!(f->a < f->b) || (f->a0 == 0.5*(f->a+f->b))) {
+        printf("%s\n", "EIGS_CHEBYSHEV: COULD NOT SEPARATE THE SPECTRUM");
+        exit(1);
+    }
+
+    free(v); free(alpha); free(beta);
+}
+
+// y = A x
+static void apply(eigs_chebyshev *f, const double *x, double *y) {
+    if (f->complex_values)
+        f->zphi(f->phi_data, f->n, (const double complex *)x,
+                (double complex *)y);
+    else
+        f->dphi(f->phi_data, f->n, x, y);
+}
+
+// y = p(A) x with p(t) = T_m((t-c)/e)/T_m((a0-c)/e), the three-term
+// recurrence is scaled such that no overflow occurs (Zhou and Saad)
+static void filter(eigs_chebyshev *f, const double *x, double *y) {
+
+    int64_t len = f->len, i;
+    int32_t j;
+    double e = 0.5*(f->b-f->a), c = 0.5*(f->b+f->a);
+    double sigma1 = e/(f->a0-c), sigma = sigma1, sigma2;
+    double *prev = f->w[0], *cur = f->w[1], *next = f->w[2], *swap;
+
+    memcpy(prev, x, len*sizeof(double));
+    apply(f, prev, cur);
+    for (i=0; i<len; i++) cur[i] = (cur[i]-c*prev[i])*sigma1/e;
+
+    for (j=2; j<=f->degree; j++) {
+        sigma2 = 1./(2./sigma1-sigma);
+        apply(f, cur, next);
+        for (i=0; i<len; i++)
+            next[i] = 2.*sigma2/e*(next[i]-c*cur[i])-sigma*sigma2*prev[i];
+        swap = prev; prev = cur; cur = next; next = swap;
+        sigma = sigma2;
+    }
+
+    memcpy(y, cur, len*sizeof(double));
+}
@@ -22,77 +22,69 @@
 #include "../inc.d/eigs.h"
 
 
-static void extract(eigs_result *, double *, double *, double *, bool);
-
-
-// Eigenvalues and eigenvectors
+// Eigenvalues and eigenvectors (the row-major input read as column-major is
+// the transposed matrix, whose left eigenvectors are the complex conjugated
+// right eigenvectors of the matrix)
 void dgeigsa(uint32_t n,
              const double *phi,
              bool evs,
+             const eigs_options *opts,
              eigs_result *result) {
 
-    // Copy matrix
-    double *phi_cpy;
-    phi_cpy = (double *)malloc(n*n*sizeof(double));
-    for (uint32_t i=0; i<n*n; i++) phi_cpy[i] = phi[i];
+    bool overwrite = opts->overwrite, colmajor = opts->colmajor;
 
+    // Work in the input or in a copy
+    double *a;
+    if (overwrite) {
+        a = (double *)phi;
+    } else {
+        a = (double *)malloc((size_t)n*n*sizeof(double));
+        memcpy(a, phi, (size_t)n*n*sizeof(double));
+    }
 
     // Solve eigenproblem using LAPACK
-    double *wr, *wi, *vs;
+    uint32_t i;
+    double *wr, *wi, *vl = NULL;
     wr = (double *)malloc(n*sizeof(double));
     wi = (double *)malloc(n*sizeof(double));
-    vs = (double *)malloc(n*n*sizeof(double));
-    lapack_int info = LAPACKE_dgeev(LAPACK_ROW_MAJOR,
-                                    'N',
-                                    'V',
-                                    n,
-                                    phi_cpy,
-                                    n,
-                                    wr,
-                                    wi,
-                                    NULL,
-                                    1,
-                                    vs,
-                                    n);
-
-    // Check result
-    if (info) {
-        printf("%s\n", "EIGS: LAPACKE_dgeev did not converge"); exit(1);
+    double *scale = (double *)malloc(n*sizeof(double));
+    lapack_int info, ilo, ihi;
+    if (evs) {
+        // Left eigenvectors of the transposed matrix
+        double abnrm;
+        vl = (double *)malloc((size_t)n*n*sizeof(double));
+        info = LAPACKE_dgeevx(LAPACK_COL_MAJOR, opts->balance, 'V', 'N', 'N',
+                              n, a, n, wr, wi, vl, n, NULL, 1, &ilo, &ihi,
+                              scale, &abnrm, NULL, NULL);
+        if (info) {
+            printf("%s\n", "EIGS: LAPACKE_dgeevx did not converge"); exit(1);
+        }
+    } else {
+        // Eigenvalues only: balancing, Hessenberg reduction and the
+        // eigenvalues of the real Schur form (LAPACK's DGEBAL, DGEHRD and
+        // DHSEQR) without Schur vectors
+        double *tau = (double *)malloc(n*sizeof(double));
+        info = LAPACKE_dgebal(LAPACK_COL_MAJOR, opts->balance, n, a, n, &ilo,
+                              &ihi, scale);
+        if (!info) info = LAPACKE_dgehrd(LAPACK_COL_MAJOR, n, ilo, ihi, a, n,
+                                         tau);
+        if (info) {
+            printf("EIGS: HESSENBERG REDUCTION FAILED: INFO = %d\n", info);
+            exit(1);
+        }
+        info = LAPACKE_dhseqr(LAPACK_COL_MAJOR, 'E', 'N', n, ilo, ihi, a, n,
+                              wr, wi, NULL, 1);
+        if (info) {
+            printf("%s\n", "EIGS: LAPACKE_dhseqr did not converge"); exit(1);
+        }
+        free(tau);
     }
 
     // Extract eigenvalues and (possibly) eigenvectors
-    extract(result, wr, wi, vs, evs);
-
-    // Clean up
-    free(wr); free(wi); free(vs); free(phi_cpy);
-}
-
-
-// Extract eigenvalues and (possiby) eigenvectors
-static void extract(eigs_result *result,
-                    double *wr,
-                    double *wi,
-                    double *vs,
-                    bool evs) {
-
-    uint32_t i, j, l, n = result->n;
-
-    // Eigenvalues
     for (i=0; i<n; i++) result->eigvals[i] = CMPLX(wr[i], wi[i]);
+    if (evs) eigs_dvecs(n, n, vl, wi, result->eigvecs, colmajor, true);
 
-    // Eigenvectors
-    if (evs) {
-        for (i=0; i<n; i++) {
-            if (wi[i] == (double)0.) {
-                for (j=0; j<n; j++)
-                    result->eigvecs[j*n+i] = CMPLX(vs[j*n+i], 0.);
-            } else {
-                l = i++;
-                for (j=0; j<n; j++) {
-                    result->eigvecs[j*n+l] = CMPLX(vs[j*n+l],  vs[j*n+i]);
-                    result->eigvecs[j*n+i] = CMPLX(vs[j*n+l], -vs[j*n+i]);
-                }
-            }
-        }
-    }
+    // Clean up
+    free(wr); free(wi); free(vl); free(scale);
+    if (!overwrite) free(a);
 }
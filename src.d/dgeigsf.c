@@ -35,6 +35,8 @@ typedef struct _DgeigsfData {
     double tol;
     a_int ncv;
     a_int mxiter;
+    a_int mode;
+    double sigma;
 
     // Internal
     a_int ido;
@@ -50,6 +52,7 @@ typedef struct _DgeigsfData {
     a_int info;
     a_int ldz;
     double *workev;
+    a_int *select;
 
     // Results
     double *dr;
@@ -59,19 +62,24 @@ typedef struct _DgeigsfData {
 } dgeigsf_data;
 
 
-static dgeigsf_data *dgeigsf_init(a_int,
-                                  deigs_phi *,
-                                  void *,
-                                  a_int,
-                                  const char *,
-                                  bool,
-                                  double,
-                                  a_int);
+static dgeigsf_data *dgeigsf_alloc(a_int,
+                                   a_int,
+                                   a_int,
+                                   const char *);
+static void dgeigsf_init(dgeigsf_data *,
+                         deigs_phi *,
+                         void *,
+                         const char *,
+                         bool,
+                         double,
+                         a_int,
+                         a_int,
+                         double);
 static void dgeigsf_data_destroy(dgeigsf_data *);
 static void arnoldi_iterations(dgeigsf_data *);
 static void iterate(dgeigsf_data *);
 static void extract(dgeigsf_data *);
-static eigs_result *prepare_result(dgeigsf_data *, eigs_result *);
+static eigs_result *prepare_result(dgeigsf_data *, eigs_result *, bool);
 
 
 // Eigenvalues and eigenvectors
@@ -81,94 +89,144 @@ void dgeigsf(a_int n,
              bool evs,
              const char *which,
              a_int k,
+             a_int ncv,
              double tol,
              a_int maxiter,
+             a_int mode,
+             double sigma,
+             bool colmajor,
+             const char *basis_dir,
+             void **work,
              eigs_result *result) {
 
+    // Workspace (kept in "*work" for further solves if "work" is not NULL
+    // and neither the dimension of the subspace nor the storage of the basis
+    // change)
+    dgeigsf_data *data = work ? (dgeigsf_data *)*work : NULL;
+    if (data && ((data->ncv != eigs_ncv(n, k, ncv)) ||
+                 (eigs_basis_mapped(data->v) != (basis_dir != NULL)))) {
+        dgeigsf_data_destroy(data);
+        data = NULL;
+    }
+    if (!data) data = dgeigsf_alloc(n, k, ncv, basis_dir);
+    if (work) *work = data;
+
     // Initialize data
-    dgeigsf_data *data = dgeigsf_init(n,
-                                      phi,
-                                      phi_data,
-                                      k,
-                                      which,
-                                      evs,
-                                      tol,
-                                      maxiter);
+    dgeigsf_init(data,
+                 phi,
+                 phi_data,
+                 which,
+                 evs,
+                 tol,
+                 maxiter,
+                 mode,
+                 sigma);
 
     // Arnoldi iterations
     arnoldi_iterations(data);
+    eigs_arpack_stats('n', data->iparam, &result->stats);
 
     // Extract eigenvalues and (possibly) eigenvectors
+    double t = eigs_clock();
     extract(data);
 
     // Prepare result
-    prepare_result(data, result);
+    prepare_result(data, result, colmajor);
+    result->stats.time_extract = eigs_clock()-t;
 
     // Clean up
-    dgeigsf_data_destroy(data);
+    if (!work) dgeigsf_data_destroy(data);
+}
+
+// Free workspace kept by "dgeigsf"
+void dgeigsf_free(void *work) {
+    if (work) dgeigsf_data_destroy((dgeigsf_data *)work);
+}
+
+// Allocate memory for data (nothing is zeroed, ARPACK does not need it)
+static dgeigsf_data *dgeigsf_alloc(a_int n, a_int k, a_int ncv,
+                                   const char *basis_dir) {
+
+    dgeigsf_data *data = (dgeigsf_data *)eigs_malloc(sizeof(dgeigsf_data));
+    size_t nd = sizeof(double);
+
+    // Dimensions
+    data->n = n;
+    data->nev = k;
+    data->ncv = eigs_ncv(n, k, ncv);
+    data->ldv = n;
+    data->lworkl = 3*data->ncv*(data->ncv+2);
+    data->ldz = n;
+
+    // Internal
+    data->resid = (double *)eigs_malloc(n*nd);
+    data->v = (double *)eigs_basis_alloc((size_t)n*data->ncv*nd, basis_dir);
+    data->iparam = (a_int *)eigs_malloc(11*sizeof(a_int));
+    data->ipntr = (a_int *)eigs_malloc(14*sizeof(a_int));
+    data->workd = (double *)eigs_malloc(3*(size_t)n*nd);
+    data->workl = (double *)eigs_malloc(data->lworkl*nd);
+    data->workev = (double *)eigs_malloc(3*data->ncv*nd);
+    data->select = (a_int *)eigs_malloc(data->ncv*sizeof(a_int));
+
+    // Results
+    data->dr = (double *)eigs_malloc((data->nev+1)*nd);
+    data->di = (double *)eigs_malloc((data->nev+1)*nd);
+    data->z = (double *)eigs_malloc((size_t)n*(data->nev+1)*nd);
+
+    return data;
+}
+
+// Bytes allocated by "dgeigsf_alloc"
+size_t dgeigsf_bytes(a_int n, a_int k, a_int ncv, const char *basis_dir) {
+    size_t nn = n, m = eigs_ncv(n, k, ncv), nd = sizeof(double);
+    return sizeof(dgeigsf_data)+(4*nn+nn*(k+1)+3*m*(m+2)+3*m+2*(k+1))*nd
+           +(25+m)*sizeof(a_int)+eigs_basis_bytes(nn*m*nd, basis_dir);
 }
 
 // Initialize eigenproblem
-static dgeigsf_data *dgeigsf_init(a_int n,
-                                  deigs_phi *phi,
-                                  void *phi_data,
-                                  a_int k,
-                                  const char *which,
-                                  bool evs,
-                                  double tol,
-                                  a_int maxiter) {
-
-    // Allocate memory for data
-    dgeigsf_data *data = (dgeigsf_data *)malloc(sizeof(dgeigsf_data));
+static void dgeigsf_init(dgeigsf_data *data,
+                         deigs_phi *phi,
+                         void *phi_data,
+                         const char *which,
+                         bool evs,
+                         double tol,
+                         a_int maxiter,
+                         a_int mode,
+                         double sigma) {
 
     // User set
-    data->n = n;
     data->phi = phi;
-    data->nev = k;
     data->which = which;
     data->evs = evs;
     data->tol = tol; // Default 0. (machine precision)
     data->mxiter = maxiter; // Default 10*n
     data->phi_data = phi_data; // Default NULL
+    data->mode = mode; // 1 (regular) or 3 (shift-invert, phi is the inverse)
+    data->sigma = sigma; // Only referenced if mode is 3
 
     // Internal
     data->ido = 0;
     data->bmat = "I";
-    data->resid = (double *)malloc(n*sizeof(double));
-    if ((data->ncv = 2*k+1) < 20) data->ncv = 20;
-    if (data->ncv > n) data->ncv = n;
-    data->v = (double *)calloc(n*data->ncv, sizeof(double));
-    data->ldv = n;
-    data->iparam = (a_int *)calloc(11, sizeof(a_int));
+    memset(data->iparam, 0, 11*sizeof(a_int));
     data->iparam[0] = 1;
     data->iparam[2] = maxiter;
     data->iparam[3] = 1;
-    data->iparam[6] = 1;
-    data->ipntr = (a_int *)calloc(14, sizeof(a_int));
-    data->workd = (double *)calloc(3*n, sizeof(double));
-    data->lworkl = 3*data->ncv*(data->ncv+2);
-    data->workl = (double *)calloc(data->lworkl, sizeof(double));
+    data->iparam[6] = mode;
+    memset(data->ipntr, 0, 14*sizeof(a_int));
+    memset(data->select, 0, data->ncv*sizeof(a_int));
     data->info = 0;
-    data->ldz = n;
-    data->workev = (double *)calloc(3*data->ncv, sizeof(double));
-
-    // Results
-    data->dr = (double *)calloc(data->nev+1, sizeof(double));
-    data->di = (double *)calloc(data->nev+1, sizeof(double));
-    data->z = (double *)calloc(n*(data->nev+1), sizeof(double));
-
-    return data;
 }
 
-// Free for zeigsf_data type
+// Free for dgeigsf_data type
 static void dgeigsf_data_destroy(dgeigsf_data *data) {
     free(data->resid); data->resid = NULL;
-    free(data->v); data->v = NULL;
+    eigs_basis_free(data->v); data->v = NULL;
     free(data->iparam); data->iparam = NULL;
     free(data->ipntr); data->ipntr = NULL;
     free(data->workd); data->workd = NULL;
     free(data->workl); data->workl = NULL;
     free(data->workev); data->workev = NULL;
+    free(data->select); data->select = NULL;
     free(data->dr); data->dr = NULL;
     free(data->di); data->di = NULL;
     free(data->z); data->z = NULL;
@@ -193,7 +251,7 @@ static void arnoldi_iterations(dgeigsf_data *data) {
 // Do a single Arnoldi iteration
 static void iterate(dgeigsf_data *data) {
 
-    // Call ZNAUPD
+    // Call DNAUPD
     dnaupd_c(&data->ido,
              data->bmat,
              data->n,
@@ -240,15 +298,13 @@ static void iterate(dgeigsf_data *data) {
 static void extract(dgeigsf_data *data) {
 
     // For internal use
-    const char *howmny = "A"; if (data->evs) howmny = "P";
-    a_int *select = (a_int *)calloc(data->ncv, sizeof(a_int));
-    double sigmar, sigmai; sigmar = sigmai = 0.; // Not referenced
+    const char *howmny = "A"; // Ritz vectors (not Schur vectors)
+    double sigmar = data->sigma, sigmai = 0.; // Only referenced in mode 3
 
-    // Call ZNEUPD // HERE THINGS GET FUCKED UP            aaaaaaaaaaaaaaaaaaaaaaaaaaaaa
-    printf("%d\n", 1000000);
+    // Call DNEUPD
     dneupd_c(data->evs,
              howmny,
-             select,
+             data->select,
              data->dr,
              data->di,
              data->z,
@@ -272,9 +328,6 @@ static void extract(dgeigsf_data *data) {
              data->lworkl,
              &data->info);
 
-    // Clean up
-    free(select);
-
     // Check for errors
     if (data->info) {
         printf("DEIGSF: COULD NOT EXTRACT RESULTS: INFO = %d\n", data->info);
@@ -282,20 +335,16 @@ static void extract(dgeigsf_data *data) {
     }
 }
 
-// Load data into result and reorder it to row major
-static eigs_result *prepare_result(dgeigsf_data *data, eigs_result *result) {
-    a_int n, k, i, j, count;
-    n = data->n; k = data->nev; count = 0;
+// Load data into result (eigenvectors row-major unless "colmajor")
+static eigs_result *prepare_result(dgeigsf_data *data,
+                                   eigs_result *result,
+                                   bool colmajor) {
+    a_int n, k, j;
+    n = data->n; k = data->nev;
     result->n = n; result->k = k;
     for (j=0; j<k; j++) result->eigvals[j] = CMPLX(data->dr[j], data->di[j]);
-    if (data->evs) {
-        for (i=0; i<n; i++) {
-            for (j=0; j<k; j++) {
-                result->eigvecs[count++] = data->z[n*j+i];
-            }
-        }
-    } else {
-        result->eigvecs = NULL;
-    }
+    if (data->evs)
+        eigs_dvecs(n, k, data->z, data->di, result->eigvecs, colmajor,
+                   false);
     return result;
 }
@@ -15,24 +15,72 @@
  * -------------------------------------------------------------------------- *
  *                                                                            *
  * LAPACK based solver for all double eigenvalues/-vectors of a symmetric     *
- * matrix                                                                     *
+ * matrix (full, band or packed storage)                                     *
  *                                                                            *
  * -------------------------------------------------------------------------- */
 
 
+#include <math.h>
+
 #include "../inc.d/eigs.h"
 
 
-// Eigenvalues and eigenvectors
+static void selection(uint32_t,
+                      double *,
+                      bool,
+                      const eigs_options *,
+                      eigs_result *);
+static void structured(uint32_t,
+                       const double *,
+                       bool,
+                       const eigs_options *,
+                       eigs_result *);
+static double *tridiagonal(uint32_t,
+                           double *,
+                           double *,
+                           bool,
+                           const eigs_options *,
+                           eigs_result *);
+static lapack_int count_below(uint32_t, const double *, const double *,
+                              double);
+
+
+// Eigenvalues and eigenvectors (the row-major input read as column-major is
+// the transposed, i.e. the same, matrix)
 void dseigsa(uint32_t n,
              const double *phi,
              bool evs,
+             const eigs_options *opts,
              eigs_result *result) {
 
-    // Copy matrix
-    double *phi_cpy;
-    phi_cpy = (double *)malloc(n*n*sizeof(double));
-    for (uint32_t i=0; i<n*n; i++) phi_cpy[i] = phi[i];
+    bool overwrite = opts->overwrite, colmajor = opts->colmajor;
+    bool all = (opts->range == 'A');
+
+    // Band or packed storage
+    if (opts->storage != 'F') {
+        structured(n, phi, evs, opts, result);
+        return;
+    }
+
+    // Work in the input or in a copy; all column-major eigenvectors are
+    // computed in the second half of the eigenvector buffer and widened in
+    // place
+    double *a;
+    bool inplace = evs && colmajor && all;
+    if (overwrite) {
+        a = (double *)phi;
+    } else {
+        if (inplace) a = (double *)result->eigvecs+(size_t)n*n;
+        else a = (double *)malloc((size_t)n*n*sizeof(double));
+        memcpy(a, phi, (size_t)n*n*sizeof(double));
+    }
+
+    // Selected eigenvalues only
+    if (!all) {
+        selection(n, a, evs, opts, result);
+        if (!overwrite) free(a);
+        return;
+    }
 
     // Check if eigenvectors are desired
     char jobz;
@@ -42,28 +90,220 @@ void dseigsa(uint32_t n,
         jobz = 'N';
     }
 
-    // Solve eigenproblem using LAPACK
+    // Solve eigenproblem using LAPACK (divide and conquer)
     uint32_t i;
     double *eigvals = (double *)malloc(n*sizeof(double));
-    lapack_int info = LAPACKE_dsyev(LAPACK_ROW_MAJOR,
-                                    jobz,
-                                    'U',
-                                    n,
-                                    phi_cpy,
-                                    n,
-                                    eigvals);
+    lapack_int info = LAPACKE_dsyevd(LAPACK_COL_MAJOR,
+                                     jobz,
+                                     'L',
+                                     n,
+                                     a,
+                                     n,
+                                     eigvals);
     for (i=0; i<n; i++) result->eigvals[i] = CMPLX(eigvals[i], 0.);
 
     // Check result
     if (info) {
-        printf("%s\n", "EIGS: LAPACKE_dsyev did not converge"); exit(1);
+        printf("%s\n", "EIGS: LAPACKE_dsyevd did not converge"); exit(1);
     }
 
     // Check if eigenvectors are desired
-    if (evs) {
-        for (uint32_t i=0; i<n*n; i++) result->eigvecs[i] = phi_cpy[i];
+    if (evs) eigs_dvecs(n, n, a, NULL, result->eigvecs, colmajor, false);
+
+    // Clean up
+    if (!overwrite && !inplace) free(a);
+    free(eigvals);
+}
+
+// Eigenvalues il,...,il+k-1 (range 'I') or at most k eigenvalues in
+// [vl, vu) (range 'V') by MRRR, as for "zheigsa"
+static void selection(uint32_t n,
+                      double *a,
+                      bool evs,
+                      const eigs_options *opts,
+                      eigs_result *result) {
+
+    lapack_int info, m;
+
+    double *d = (double *)malloc(n*sizeof(double));
+    double *e = (double *)malloc(n*sizeof(double));
+    double *tau = (double *)malloc(n*sizeof(double));
+
+    // Householder reduction (LAPACK's DSYTRD)
+    info = LAPACKE_dsytrd(LAPACK_COL_MAJOR, 'L', n, a, n, d, e, tau);
+    if (info) {
+        printf("EIGS: LAPACKE_dsytrd FAILED: INFO = %d\n", info); exit(1);
+    }
+    double *z = tridiagonal(n, d, e, evs, opts, result);
+    m = result->k;
+
+    // Back transformation (LAPACK's DORMTR)
+    if (evs && m) {
+        info = LAPACKE_dormtr(LAPACK_COL_MAJOR, 'L', 'L', 'N', n, m, a, n,
+                              tau, z, n);
+        if (info) {
+            printf("EIGS: LAPACKE_dormtr FAILED: INFO = %d\n", info);
+            exit(1);
+        }
+        eigs_dvecs(n, m, z, NULL, result->eigvecs, opts->colmajor, false);
     }
 
     // Clean up
-    free(phi_cpy); free(eigvals);
+    free(d); free(e); free(tau); free(z);
+}
+
+// Band ('B') or packed ('P') upper triangle, as for "zheigsa" (read as the
+// lower triangle of the same matrix)
+static void structured(uint32_t n,
+                       const double *phi,
+                       bool evs,
+                       const eigs_options *opts,
+                       eigs_result *result) {
+
+    bool band = (opts->storage == 'B'), colmajor = opts->colmajor;
+    lapack_int kd = opts->kd, info, m, ldz = evs ? n : 1;
+    size_t len = band ? (size_t)(kd+1)*n : (size_t)n*(n+1)/2;
+
+    // Work in the input or in a copy of the band or triangle
+    double *a;
+    if (opts->overwrite) {
+        a = (double *)phi;
+    } else {
+        a = (double *)malloc(len*sizeof(double));
+        memcpy(a, phi, len*sizeof(double));
+    }
+
+    // All eigenvalues (LAPACK's DSBEVD or DSPEVD), column-major eigenvectors
+    // in the second half of the eigenvector buffer and widened in place
+    if (opts->range == 'A') {
+        double *w = (double *)malloc(n*sizeof(double)), *z = NULL;
+        if (evs && colmajor) z = (double *)result->eigvecs+(size_t)n*n;
+        else if (evs) z = (double *)malloc((size_t)n*n*sizeof(double));
+        if (band)
+            info = LAPACKE_dsbevd(LAPACK_COL_MAJOR, evs ? 'V' : 'N', 'L', n,
+                                  kd, a, kd+1, w, z, ldz);
+        else
+            info = LAPACKE_dspevd(LAPACK_COL_MAJOR, evs ? 'V' : 'N', 'L', n,
+                                  a, w, z, ldz);
+        if (info) {
+            printf("EIGS: LAPACKE_%s did not converge\n",
+                   band ? "dsbevd" : "dspevd");
+            exit(1);
+        }
+        for (uint32_t i=0; i<n; i++) result->eigvals[i] = CMPLX(w[i], 0.);
+        if (evs) eigs_dvecs(n, n, z, NULL, result->eigvecs, colmajor, false);
+        if (evs && !colmajor) free(z);
+        if (!opts->overwrite) free(a);
+        free(w);
+        return;
+    }
+
+    // Reduction to tridiagonal form (LAPACK's DSBTRD, which forms the n x n
+    // transformation for eigenvectors, or DSPTRD)
+    double *d = (double *)malloc(n*sizeof(double));
+    double *e = (double *)malloc(n*sizeof(double));
+    double *q = NULL, *tau = NULL;
+    if (band) {
+        if (evs) q = (double *)malloc((size_t)n*n*sizeof(double));
+        info = LAPACKE_dsbtrd(LAPACK_COL_MAJOR, evs ? 'V' : 'N', 'L', n, kd,
+                              a, kd+1, d, e, q, ldz);
+    } else {
+        tau = (double *)malloc(n*sizeof(double));
+        info = LAPACKE_dsptrd(LAPACK_COL_MAJOR, 'L', n, a, d, e, tau);
+    }
+    if (info) {
+        printf("EIGS: LAPACKE_%s FAILED: INFO = %d\n",
+               band ? "dsbtrd" : "dsptrd", info);
+        exit(1);
+    }
+    double *z = tridiagonal(n, d, e, evs, opts, result);
+    m = result->k;
+
+    // Back transformation (a product with the transformation or LAPACK's
+    // DOPMTR)
+    if (evs && m) {
+        if (band) {
+            double *qz = (double *)malloc((size_t)n*m*sizeof(double));
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, m, n,
+                        1., q, n, z, n, 0., qz, n);
+            free(z); z = qz;
+        } else {
+            info = LAPACKE_dopmtr(LAPACK_COL_MAJOR, 'L', 'L', 'N', n, m, a,
+                                  tau, z, n);
+            if (info) {
+                printf("EIGS: LAPACKE_dopmtr FAILED: INFO = %d\n", info);
+                exit(1);
+            }
+        }
+        eigs_dvecs(n, m, z, NULL, result->eigvecs, colmajor, false);
+    }
+
+    // Clean up
+    if (!opts->overwrite) free(a);
+    free(d); free(e); free(q); free(tau); free(z);
+}
+
+// Eigenvalues of the tridiagonal matrix (d, e), as for "zheigsa"
+static double *tridiagonal(uint32_t n,
+                           double *d,
+                           double *e,
+                           bool evs,
+                           const eigs_options *opts,
+                           eigs_result *result) {
+
+    int32_t k = result->k;
+    lapack_int il = opts->il+1, iu = opts->il+k, m, nzc = k, j;
+    lapack_logical tryrac = 1;
+    lapack_int info;
+
+    // The interval becomes the index range of its eigenvalues
+    if (opts->range == 'V') {
+        il = count_below(n, d, e, opts->vl)+1;
+        iu = count_below(n, d, e, opts->vu);
+        nzc = iu-il+1;
+        if (nzc > k) {
+            printf("EIGS: %d EIGENVALUES IN [VL, VU), K = %d IS TOO SMALL\n",
+                   nzc, k);
+            exit(1);
+        }
+    }
+
+    // Eigenpairs of the tridiagonal matrix (LAPACK's DSTEMR)
+    double *w = (double *)malloc(n*sizeof(double));
+    double *z = NULL;
+    if (evs) z = (double *)malloc((size_t)n*(nzc ? nzc : 1)*sizeof(double));
+    lapack_int *isuppz = (lapack_int *)malloc(2*(nzc+1)*sizeof(lapack_int));
+    m = 0; info = 0;
+    if (nzc > 0)
+        info = LAPACKE_dstemr(LAPACK_COL_MAJOR, evs ? 'V' : 'N', 'I', n, d,
+                              e, 0., 0., il, iu, &m, w, z, evs ? n : 1, nzc,
+                              isuppz, &tryrac);
+    if (info) {
+        printf("EIGS: LAPACKE_dstemr FAILED: INFO = %d\n", info); exit(1);
+    }
+    result->k = m;
+    for (j=0; j<m; j++) result->eigvals[j] = CMPLX(w[j], 0.);
+
+    free(w); free(isuppz);
+    return z;
+}
+
+// Number of eigenvalues of the tridiagonal matrix (d, e) below x (Sturm
+// count, i.e. negative pivots of the LDL^T factorization of T - x I)
+static lapack_int count_below(uint32_t n,
+                              const double *d,
+                              const double *e,
+                              double x) {
+
+    const double tiny = 1e-300;
+    lapack_int count = 0;
+    double q = 1.;
+
+    for (uint32_t i=0; i<n; i++) {
+        q = d[i]-x-((i > 0) ? e[i-1]*e[i-1]/q : 0.);
+        if (fabs(q) < tiny) q = -tiny;
+        if (q < 0.) count++;
+    }
+
+    return count;
 }
@@ -0,0 +1,340 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * ARPACK based solver for a few eigenvalues/-vectors of a symmetric double   *
+ * endomorphism                                                               *
+ * -------------------------------------------------------------------------- */
+
+
+#include "../inc.d/eigs.h"
+
+
+// Data for internal usage
+typedef struct _DseigsfData {
+
+    // User set
+    a_int n;
+    deigs_phi *phi;
+    void *phi_data;
+    a_int nev;
+    const char *which;
+    bool evs;
+    double tol;
+    a_int ncv;
+    a_int mxiter;
+    a_int mode;
+    double sigma;
+
+    // Internal
+    a_int ido;
+    const char *bmat;
+    double *resid;
+    double *v;
+    a_int ldv;
+    a_int *iparam;
+    a_int *ipntr;
+    double *workd;
+    a_int lworkl;
+    double *workl;
+    a_int info;
+    a_int ldz;
+    a_int *select;
+
+    // Results
+    double *d;
+    double *z;
+
+} dseigsf_data;
+
+
+static dseigsf_data *dseigsf_alloc(a_int,
+                                   a_int,
+                                   a_int,
+                                   const char *);
+static void dseigsf_init(dseigsf_data *,
+                         deigs_phi *,
+                         void *,
+                         const char *,
+                         bool,
+                         double,
+                         a_int,
+                         a_int,
+                         double);
+static void dseigsf_data_destroy(dseigsf_data *);
+static void lanczos_iterations(dseigsf_data *);
+static void iterate(dseigsf_data *);
+static void extract(dseigsf_data *);
+static eigs_result *prepare_result(dseigsf_data *, eigs_result *, bool);
+
+
+// Eigenvalues and eigenvectors
+void dseigsf(a_int n,
+             deigs_phi *phi,
+             void *phi_data,
+             bool evs,
+             const char *which,
+             a_int k,
+             a_int ncv,
+             double tol,
+             a_int maxiter,
+             a_int mode,
+             double sigma,
+             bool colmajor,
+             const char *basis_dir,
+             void **work,
+             eigs_result *result) {
+
+    // Workspace (kept in "*work" for further solves if "work" is not NULL
+    // and neither the dimension of the subspace nor the storage of the basis
+    // change)
+    dseigsf_data *data = work ? (dseigsf_data *)*work : NULL;
+    if (data && ((data->ncv != eigs_ncv(n, k, ncv)) ||
+                 (eigs_basis_mapped(data->v) != (basis_dir != NULL)))) {
+        dseigsf_data_destroy(data);
+        data = NULL;
+    }
+    if (!data) data = dseigsf_alloc(n, k, ncv, basis_dir);
+    if (work) *work = data;
+
+    // Initialize data
+    dseigsf_init(data,
+                 phi,
+                 phi_data,
+                 which,
+                 evs,
+                 tol,
+                 maxiter,
+                 mode,
+                 sigma);
+
+    // Lanczos iterations
+    lanczos_iterations(data);
+    eigs_arpack_stats('s', data->iparam, &result->stats);
+
+    // Extract eigenvalues and (possibly) eigenvectors
+    double t = eigs_clock();
+    extract(data);
+
+    // Prepare result
+    prepare_result(data, result, colmajor);
+    result->stats.time_extract = eigs_clock()-t;
+
+    // Clean up
+    if (!work) dseigsf_data_destroy(data);
+}
+
+// Free workspace kept by "dseigsf"
+void dseigsf_free(void *work) {
+    if (work) dseigsf_data_destroy((dseigsf_data *)work);
+}
+
+// Allocate memory for data (nothing is zeroed, ARPACK does not need it)
+static dseigsf_data *dseigsf_alloc(a_int n, a_int k, a_int ncv,
+                                   const char *basis_dir) {
+
+    dseigsf_data *data = (dseigsf_data *)eigs_malloc(sizeof(dseigsf_data));
+    size_t nd = sizeof(double);
+
+    // Dimensions
+    data->n = n;
+    data->nev = k;
+    data->ncv = eigs_ncv(n, k, ncv);
+    data->ldv = n;
+    data->lworkl = data->ncv*(data->ncv+8);
+    data->ldz = n;
+
+    // Internal
+    data->resid = (double *)eigs_malloc(n*nd);
+    data->v = (double *)eigs_basis_alloc((size_t)n*data->ncv*nd, basis_dir);
+    data->iparam = (a_int *)eigs_malloc(11*sizeof(a_int));
+    data->ipntr = (a_int *)eigs_malloc(11*sizeof(a_int));
+    data->workd = (double *)eigs_malloc(3*(size_t)n*nd);
+    data->workl = (double *)eigs_malloc(data->lworkl*nd);
+    data->select = (a_int *)eigs_malloc(data->ncv*sizeof(a_int));
+
+    // Results
+    data->d = (double *)eigs_malloc(data->nev*nd);
+    data->z = (double *)eigs_malloc((size_t)n*data->nev*nd);
+
+    return data;
+}
+
+// Bytes allocated by "dseigsf_alloc"
+size_t dseigsf_bytes(a_int n, a_int k, a_int ncv, const char *basis_dir) {
+    size_t nn = n, m = eigs_ncv(n, k, ncv), nd = sizeof(double);
+    return sizeof(dseigsf_data)+(4*nn+nn*k+m*(m+8)+k)*nd
+           +(22+m)*sizeof(a_int)+eigs_basis_bytes(nn*m*nd, basis_dir);
+}
+
+// Initialize eigenproblem
+static void dseigsf_init(dseigsf_data *data,
+                         deigs_phi *phi,
+                         void *phi_data,
+                         const char *which,
+                         bool evs,
+                         double tol,
+                         a_int maxiter,
+                         a_int mode,
+                         double sigma) {
+
+    // User set
+    data->phi = phi;
+    data->which = which;
+    data->evs = evs;
+    data->tol = tol; // Default 0. (machine precision)
+    data->mxiter = maxiter; // Default 10*n
+    data->phi_data = phi_data; // Default NULL
+    data->mode = mode; // 1 (regular) or 3 (shift-invert, phi is the inverse)
+    data->sigma = sigma; // Only referenced if mode is 3
+
+    // Internal
+    data->ido = 0;
+    data->bmat = "I";
+    memset(data->iparam, 0, 11*sizeof(a_int));
+    data->iparam[0] = 1;
+    data->iparam[2] = maxiter;
+    data->iparam[3] = 1;
+    data->iparam[6] = mode;
+    memset(data->ipntr, 0, 11*sizeof(a_int));
+    memset(data->select, 0, data->ncv*sizeof(a_int));
+    data->info = 0;
+}
+
+// Free for dseigsf_data type
+static void dseigsf_data_destroy(dseigsf_data *data) {
+    free(data->resid); data->resid = NULL;
+    eigs_basis_free(data->v); data->v = NULL;
+    free(data->iparam); data->iparam = NULL;
+    free(data->ipntr); data->ipntr = NULL;
+    free(data->workd); data->workd = NULL;
+    free(data->workl); data->workl = NULL;
+    free(data->select); data->select = NULL;
+    free(data->d); data->d = NULL;
+    free(data->z); data->z = NULL;
+    free(data);
+}
+
+// Do Lanczos iterations
+static void lanczos_iterations(dseigsf_data *data) {
+
+    // Lanczos iterations
+    do {
+        iterate(data);
+    } while ((data->ido == 1) || (data->ido == -1));
+
+    // Check for errors
+    if (data->ido != 99) {
+        printf("%s\n", "DSEIGSF: LANCZOS PROCESS DID NOT CONVERGE");
+        exit(1);
+    }
+}
+
+// Do a single Lanczos iteration
+static void iterate(dseigsf_data *data) {
+
+    // Call DSAUPD
+    dsaupd_c(&data->ido,
+             data->bmat,
+             data->n,
+             data->which,
+             data->nev,
+             data->tol,
+             data->resid,
+             data->ncv,
+             data->v,
+             data->ldv,
+             data->iparam,
+             data->ipntr,
+             data->workd,
+             data->workl,
+             data->lworkl,
+             &data->info);
+
+    // Check for errors
+    int nerror = 0;
+    if ((data->ido != 1) && (data->ido != -1) && (data->ido != 99)) {
+        printf("DSEIGSF: ERROR DURING ITERATION: IDO = %d\n", data->ido);
+        nerror++;
+    }
+    if ((data->info != 0) && (data->info != 1)) {
+        printf("DSEIGSF: ERROR DURING ITERATION: INFO = %d\n", data->info);
+        nerror++;
+    }
+    if (data->info == 1) {
+        printf("%s\n", "DSEIGSF: MAXIMAL ALLOWED ITERATIONS REACHED");
+        nerror++;
+    }
+    if (nerror) exit(1);
+
+    // Compute action of phi
+    a_int xpntr = data->ipntr[0]-1;
+    a_int ypntr = data->ipntr[1]-1;
+    data->phi(data->phi_data,
+              data->n,
+              &(data->workd[xpntr]),
+              &(data->workd[ypntr]));
+}
+
+// Extract eigenvalues and (possiby) eigenvectors
+static void extract(dseigsf_data *data) {
+
+    // For internal use
+    const char *howmny = "A";
+    double sigma = data->sigma; // Only referenced in mode 3
+
+    // Call DSEUPD
+    dseupd_c(data->evs,
+             howmny,
+             data->select,
+             data->d,
+             data->z,
+             data->ldz,
+             sigma,
+             data->bmat,
+             data->n,
+             data->which,
+             data->nev,
+             data->tol,
+             data->resid,
+             data->ncv,
+             data->v,
+             data->ldv,
+             data->iparam,
+             data->ipntr,
+             data->workd,
+             data->workl,
+             data->lworkl,
+             &data->info);
+
+    // Check for errors
+    if (data->info) {
+        printf("DSEIGSF: COULD NOT EXTRACT RESULTS: INFO = %d\n", data->info);
+        exit(1);
+    }
+}
+
+// Load data into result (eigenvectors row-major unless "colmajor")
+static eigs_result *prepare_result(dseigsf_data *data,
+                                   eigs_result *result,
+                                   bool colmajor) {
+    a_int n, k, j;
+    n = data->n; k = data->nev;
+    result->n = n; result->k = k;
+    for (j=0; j<k; j++) result->eigvals[j] = CMPLX(data->d[j], 0.);
+    if (data->evs)
+        eigs_dvecs(n, k, data->z, NULL, result->eigvecs, colmajor, false);
+    return result;
+}
@@ -19,10 +19,47 @@
  * -------------------------------------------------------------------------- */
 
 
+#define _POSIX_C_SOURCE 200112L
+
 #include "../inc.d/eigs.h"
 
 
+// Alignment of internal memory (cache line)
+#define ALIGNMENT 64
+
+
+// Workspaces kept between solves of the same kind of problem
+struct _EigsContext {
+    char solver[3];
+    int32_t n;
+    int32_t k;
+    void *zg;              // Workspaces of the iterative solvers (allocated
+    void *dg;              // on first use)
+    void *zh;
+    void *ds;
+    void *block;
+    void *ks;
+    eigs_result result;
+    double complex *eigvecs;
+};
+
+
+static eigs_result *run(const char *,
+                        zeigs_phi *,
+                        deigs_phi *,
+                        const double complex *,
+                        const double *,
+                        void *,
+                        int32_t,
+                        int32_t,
+                        const char *,
+                        int32_t,
+                        double,
+                        bool,
+                        const eigs_options *,
+                        eigs_context *);
 static eigs_result *eigs_result_alloc(int32_t, int32_t, bool);
+static eigs_result *context_result(eigs_context *, bool);
 
 
 // Eigensolver
@@ -38,11 +75,284 @@ eigs_result *eigs(const char *solver,
                   int32_t maxiter,
                   double tol,
                   bool evs) {
+    return eigsx(solver, zphi, dphi, zphi_matrix, dphi_matrix, phi_data, n, k,
+                 which, maxiter, tol, evs, NULL);
+}
+
+// Eigensolver with options (NULL for defaults)
+eigs_result *eigsx(const char *solver,
+                   zeigs_phi *zphi,
+                   deigs_phi *dphi,
+                   const double complex *zphi_matrix,
+                   const double *dphi_matrix,
+                   void *phi_data,
+                   int32_t n,
+                   int32_t k,
+                   const char *which,
+                   int32_t maxiter,
+                   double tol,
+                   bool evs,
+                   const eigs_options *opts) {
+    return run(solver, zphi, dphi, zphi_matrix, dphi_matrix, phi_data, n, k,
+               which, maxiter, tol, evs, opts, NULL);
+}
+
+// Create context for repeated solves of problems with the same solver type,
+// dimension and number of eigenvalues
+eigs_context *eigs_context_init(const char *solver, int32_t n, int32_t k) {
+
+    if (strcmp(solver, "zg") && strcmp(solver, "dg") &&
+        strcmp(solver, "zh") && strcmp(solver, "ds")) {
+        printf("EIGS: Solver *%s* not implemented\n", solver);
+        exit(1);
+    }
+
+    eigs_context *ctx = (eigs_context *)eigs_malloc(sizeof(eigs_context));
+    strcpy(ctx->solver, solver);
+    ctx->n = n; ctx->k = k;
+    ctx->zg = ctx->dg = ctx->zh = ctx->ds = ctx->block = ctx->ks = NULL;
+    ctx->result.n = n; ctx->result.k = k;
+    ctx->result.eigvals =
+        (double complex *)eigs_malloc(k*sizeof(double complex));
+    ctx->result.eigvecs = NULL;
+    ctx->eigvecs = NULL;
+
+    return ctx;
+}
+
+// Eigensolver reusing the workspaces of the context, the result belongs to
+// the context and is valid until the next solve
+eigs_result *eigs_solve(eigs_context *ctx,
+                        zeigs_phi *zphi,
+                        deigs_phi *dphi,
+                        const double complex *zphi_matrix,
+                        const double *dphi_matrix,
+                        void *phi_data,
+                        const char *which,
+                        int32_t maxiter,
+                        double tol,
+                        bool evs,
+                        const eigs_options *opts) {
+    return run(ctx->solver, zphi, dphi, zphi_matrix, dphi_matrix, phi_data,
+               ctx->n, ctx->k, which, maxiter, tol, evs, opts, ctx);
+}
+
+// Free context including its result
+void eigs_context_free(eigs_context *ctx) {
+    zgeigsf_free(ctx->zg); dgeigsf_free(ctx->dg);
+    zheigsf_free(ctx->zh); dseigsf_free(ctx->ds);
+    zheigsf_block_free(ctx->block); zgeigsf_ks_free(ctx->ks);
+    free(ctx->result.eigvals);
+    free(ctx->eigvecs);
+    free(ctx);
+}
+
+// Memory aligned to cache lines (free with "free")
+void *eigs_malloc(size_t size) {
+    void *ptr = NULL;
+    if (posix_memalign(&ptr, ALIGNMENT, size ? size : 1)) {
+        printf("%s\n", "EIGS: OUT OF MEMORY"); exit(1);
+    }
+    return ptr;
+}
+
+// Dimension of the Krylov subspace: "ncv" if positive, otherwise 2k+1 and at
+// least 20, at most n
+a_int eigs_ncv(a_int n, a_int k, a_int ncv) {
+    a_int m = ncv;
+    if ((m <= 0) && ((m = 2*k+1) < 20)) m = 20;
+    if (m > n) m = n;
+    if (m <= k) {
+        printf("%s\n", "EIGS: NCV MUST EXCEED K"); exit(1);
+    }
+    return m;
+}
+
+// Number of vectors kept at a restart: "nkeep" if positive, otherwise halfway
+// between k and ncv, always within k,...,ncv-1
+a_int eigs_nkeep(a_int k, a_int ncv, a_int nkeep) {
+    if (nkeep <= 0) nkeep = k+(ncv-k)/2;
+    if (nkeep < k) nkeep = k;
+    if (nkeep > ncv-1) nkeep = ncv-1;
+    return nkeep;
+}
+
+// Apply solver to problem (with the workspaces of "ctx" if not NULL)
+static eigs_result *run(const char *solver,
+                        zeigs_phi *zphi,
+                        deigs_phi *dphi,
+                        const double complex *zphi_matrix,
+                        const double *dphi_matrix,
+                        void *phi_data,
+                        int32_t n,
+                        int32_t k,
+                        const char *which,
+                        int32_t maxiter,
+                        double tol,
+                        bool evs,
+                        const eigs_options *opts,
+                        eigs_context *ctx) {
+
+    // Time of the whole solve
+    double start = eigs_clock();
+
+    // Options
+    eigs_options defaults;
+    if (!opts) { eigs_options_init(&defaults); opts = &defaults; }
+
+    // Dense solvers for all eigenvalues or a selected range of "zh"/"ds"
+    bool dense = (k == n) || (opts->range != 'A');
+    if (opts->range != 'A') {
+        if (strcmp(solver, "zh") && strcmp(solver, "ds")) {
+            printf("%s\n", "EIGS: RANGE NEEDS SOLVER zh OR ds");
+            exit(1);
+        }
+        if (!zphi_matrix && !dphi_matrix) {
+            printf("%s\n", "EIGS: RANGE NEEDS A DENSE MATRIX");
+            exit(1);
+        }
+        if ((opts->range == 'I') &&
+            ((opts->il < 0) || ((int64_t)opts->il+k > n))) {
+            printf("%s\n", "EIGS: RANGE IL,...,IL+K-1 OUT OF BOUNDS");
+            exit(1);
+        }
+        if ((opts->range != 'I') && (opts->range != 'V')) {
+            printf("EIGS: RANGE = %c NOT SUPPORTED\n", opts->range);
+            exit(1);
+        }
+    }
+
+    // Balancing of the dense "zg"/"dg" solvers
+    if ((opts->balance != 'B') && (opts->balance != 'P') &&
+        (opts->balance != 'S') && (opts->balance != 'N')) {
+        printf("EIGS: BALANCE = %c NOT SUPPORTED\n", opts->balance);
+        exit(1);
+    }
+
+    // Band and packed matrices for the dense solvers of "zh"/"ds"
+    if (opts->storage != 'F') {
+        if (strcmp(solver, "zh") && strcmp(solver, "ds")) {
+            printf("%s\n", "EIGS: STORAGE NEEDS SOLVER zh OR ds");
+            exit(1);
+        }
+        if (!dense || (!zphi_matrix && !dphi_matrix)) {
+            printf("%s\n", "EIGS: STORAGE NEEDS A DENSE MATRIX AND K = N "
+                           "OR A RANGE");
+            exit(1);
+        }
+        if ((opts->storage != 'B') && (opts->storage != 'P')) {
+            printf("EIGS: STORAGE = %c NOT SUPPORTED\n", opts->storage);
+            exit(1);
+        }
+        if ((opts->storage == 'B') && ((opts->kd < 0) || (opts->kd >= n))) {
+            printf("EIGS: BANDWIDTH KD = %d OUT OF BOUNDS\n", opts->kd);
+            exit(1);
+        }
+    }
+
+    // Dimension of the subspace within the memory budget
+    a_int ncv = eigs_budget_ncv(solver, phi_data, n, k, evs, opts);
+
+    // Shift-invert: the map becomes (A - sigma I)^(-1) of a sparse matrix A
+    eigs_factor *factor = NULL;
+    eigs_inverse inverse;
+    eigs_sparse *sparse = (eigs_sparse *)phi_data;
+    a_int mode = 1;
+    a_dcomplex sigma = opts->sigma;
+    if (opts->shift_invert && !dense) {
+        if ((zphi != eigs_sparse_zphi) && (dphi != eigs_sparse_dphi)) {
+            printf("%s\n", "EIGS: SHIFT-INVERT NEEDS A SPARSE MATRIX");
+            exit(1);
+        }
+        if (dphi && (cimag(sigma) != 0.)) {
+            printf("%s\n", "EIGS: SHIFT-INVERT NEEDS A REAL SIGMA");
+            exit(1);
+        }
+        factor = eigs_factor_get(sparse, sigma);
+        eigs_inverse_init(&inverse, factor);
+        if (zphi) zphi = eigs_factor_zsolve;
+        if (dphi) dphi = eigs_factor_dsolve;
+        phi_data = &inverse;
+        mode = 3;
+    }
+
+    // Chebyshev filter: the solver iterates with p(A), the wanted eigenvalues
+    // of A become the largest ones of p(A); eigenvectors are always computed
+    // to recover the eigenvalues by Rayleigh quotients
+    eigs_chebyshev cheb;
+    bool filtered = false, keep = evs;
+    if ((opts->chebyshev > 0) && !dense) {
+        if (mode == 3) {
+            printf("%s\n", "EIGS: USE EITHER SHIFT-INVERT OR CHEBYSHEV FILTER");
+            exit(1);
+        }
+        if (strcmp(solver, "zh") && strcmp(solver, "ds")) {
+            printf("%s\n", "EIGS: CHEBYSHEV FILTER NEEDS SOLVER zh OR ds");
+            exit(1);
+        }
+        eigs_chebyshev_init(&cheb, zphi, dphi, phi_data, n, k, which,
+                            opts->chebyshev);
+        if (zphi) zphi = eigs_chebyshev_zphi;
+        if (dphi) dphi = eigs_chebyshev_dphi;
+        phi_data = &cheb;
+        which = "LA";
+        evs = filtered = true;
+    }
+
+    // Mixed precision: float Arnoldi, then refinement with the double map
+    bool mixed = (opts->cphi || opts->sphi) && !dense;
+    if (mixed && ((mode == 3) || filtered)) {
+        printf("%s\n", "EIGS: MIXED PRECISION NEEDS THE REGULAR MODE");
+        exit(1);
+    }
+
+    // Block Lanczos: nb vectors per step, orthogonalized by matrix products;
+    // the block map replaces the map in the regular mode only
+    bool block = (opts->block > 1) && !dense && !mixed;
+    if (block && strcmp(solver, "zh") && strcmp(solver, "ds")) {
+        printf("%s\n", "EIGS: BLOCK SIZE > 1 NEEDS SOLVER zh OR ds");
+        exit(1);
+    }
+    bool regular = (mode == 1) && !filtered;
+
+    // Krylov-Schur: "zg"/"dg" without ARPACK, "ds" by thick-restart Lanczos
+    // (the Krylov-Schur method of a symmetric map, "zh" always uses it)
+    bool schur = opts->krylov_schur && !dense && !mixed;
+    if (schur && !strcmp(solver, "ds")) block = true;
+    a_int nb = (opts->block > 1) ? opts->block : 1;
+    zeigs_block_phi *zphi_block = regular ? opts->zphi_block : NULL;
+    deigs_block_phi *dphi_block = regular ? opts->dphi_block : NULL;
+
+    // Eigenvectors go to the caller's buffer, or replace the overwritten
+    // input matrix of a full hermitian problem
+    double complex *vecs = opts->eigvecs;
+    if (!vecs && opts->overwrite && (k == n) && (opts->range == 'A') &&
+        (opts->storage == 'F') && !strcmp(solver, "zh"))
+        vecs = (double complex *)zphi_matrix;
 
     // Allocate memory for result
-    eigs_result *result = eigs_result_alloc(n, k, evs);
+    eigs_result *result;
+    if (ctx) result = context_result(ctx, evs && !vecs);
+    else result = eigs_result_alloc(n, k, evs && !vecs);
+    if (evs && vecs) { result->eigvecs = vecs; result->borrowed = true; }
+    memset(&result->stats, 0, sizeof(eigs_stats));
+    bool colmajor = opts->colmajor;
+    const char *dir = opts->basis_dir;
 
     // Apply solver to problem
+    if (mixed && (!strcmp(solver, "zg") || !strcmp(solver, "dg") ||
+                  !strcmp(solver, "zh") || !strcmp(solver, "ds"))) {
+
+        // Apply defaults if nessesary
+        if (maxiter <= 0) maxiter = 10*n;
+
+        // ARPACK's CNAUPD, SNAUPD or SSAUPD and double refinement
+        int32_t nconv = eigs_mixed(solver, zphi, dphi, phi_data, n, k, which,
+                                   maxiter, tol, evs, ncv, opts, result);
+        result->stats.nmatvec = result->nmatvec_float+result->nmatvec_refine;
+        result->stats.nconv = nconv;
+
+    } else
     if (!strcmp(solver, "zg")) { /* --- DOUBLE COMPLEX GENERAL --- */
 
         // Apply defaults if nessesary
@@ -54,11 +364,18 @@ eigs_result *eigs(const char *solver,
             // LAPACK(E)'s (LAPACK_)ZGEEV
             (void)zphi; (void)dphi; (void)dphi_matrix; (void)which;
             (void)maxiter; (void)tol; (void)evs;
-            zgeigsa(n, zphi_matrix, evs, result);
+            zgeigsa(n, zphi_matrix, evs, opts, result);
         } else {
             // ARPACK's ZNAUPD and ZNEUPD (Carefull, make sure k < n-1!)
             (void)dphi; (void)zphi_matrix; (void)dphi_matrix;
-            zgeigsf(n, zphi, phi_data, evs, which, k, tol, maxiter, result);
+            if (schur)
+                zgeigsf_ks(n, zphi, NULL, phi_data, NULL, evs, which, k, ncv,
+                           opts->nkeep, tol, maxiter, mode, sigma, colmajor,
+                           dir, ctx ? &ctx->ks : NULL, result);
+            else
+                zgeigsf(n, zphi, phi_data, evs, which, k, ncv, tol,
+                        maxiter, mode, sigma, colmajor, dir,
+                        ctx ? &ctx->zg : NULL, result);
         }
 
     } else
@@ -73,11 +390,19 @@ eigs_result *eigs(const char *solver,
             // LAPACK(E)'s (LAPACK_)DGEEV
             (void)zphi; (void)dphi; (void)zphi_matrix; (void)which;
             (void)maxiter; (void)tol; (void)evs;
-            dgeigsa(n, dphi_matrix, evs, result);
+            dgeigsa(n, dphi_matrix, evs, opts, result);
         } else {
-            // ARPACK's DNAUPD and DNEUPD (Carefull, make sure k < n-1!)
-            (void)dphi; (void)zphi_matrix; (void)dphi_matrix;
-            dgeigsf(n, dphi, phi_data, evs, which, k, tol, maxiter, result);
+            // ARPACK's DNAUPD and DNEUPD (Carefull, make sure k < n-1!) or
+            // Krylov-Schur on real and imaginary parts
+            (void)zphi; (void)zphi_matrix; (void)dphi_matrix;
+            if (schur)
+                zgeigsf_ks(n, NULL, dphi, phi_data, NULL, evs, which, k, ncv,
+                           opts->nkeep, tol, maxiter, mode, sigma, colmajor,
+                           dir, ctx ? &ctx->ks : NULL, result);
+            else
+                dgeigsf(n, dphi, phi_data, evs, which, k, ncv, tol,
+                        maxiter, mode, creal(sigma), colmajor, dir,
+                        ctx ? &ctx->dg : NULL, result);
         }
 
     } else
@@ -88,15 +413,29 @@ eigs_result *eigs(const char *solver,
         if (maxiter <= 0) maxiter = 10*n;
 
         // Either solve for all or a few eigenvalues/-vectors
-        if (k == n) {
-            // LAPACK(E)'s (LAPACK_)DGEEV
+        if (dense) {
+            // LAPACK(E)'s (LAPACK_)ZHEEVD or MRRR for a selected range
             (void)zphi; (void)dphi; (void)dphi_matrix; (void)which;
             (void)maxiter; (void)tol; (void)evs;
-            zheigsa(n, zphi_matrix, evs, result);
+            zheigsa(n, zphi_matrix, evs, opts, result);
         } else {
-            // ARPACK's ZNAUPD and ZNEUPD (Carefull, make sure k < n-1!)
+            // Thick-restart Lanczos (Carefull, make sure k < n!), a complex
+            // shift makes the map non-hermitian and needs ARPACK's ZNAUPD
             (void)zphi_matrix; (void)dphi; (void)dphi_matrix;
-            zgeigsf(n, zphi, phi_data, evs, which, k, tol, maxiter, result);
+            if (cimag(sigma) != 0.)
+                zgeigsf(n, zphi, phi_data, evs, which, k, ncv, tol,
+                        maxiter, mode, sigma, colmajor, dir,
+                        ctx ? &ctx->zg : NULL, result);
+            else
+            if (block)
+                zheigsf_block(n, zphi, NULL, zphi_block, NULL, phi_data, evs,
+                              which, k, nb, ncv, opts->nkeep, tol,
+                              maxiter, mode, creal(sigma), colmajor, dir,
+                              ctx ? &ctx->block : NULL, result);
+            else
+                zheigsf(n, zphi, phi_data, evs, which, k, ncv,
+                        opts->nkeep, tol, maxiter, mode, creal(sigma),
+                        colmajor, dir, ctx ? &ctx->zh : NULL, result);
         }
 
     } else
@@ -107,14 +446,24 @@ eigs_result *eigs(const char *solver,
         if (maxiter <= 0) maxiter = 10*n;
 
         // Either solve for all or a few eigenvalues/-vectors
-        if (k == n) {
-            // LAPACK(E)'s (LAPACK_)DGEEV
+        if (dense) {
+            // LAPACK(E)'s (LAPACK_)DSYEVD or MRRR for a selected range
             (void)zphi; (void)dphi; (void)zphi_matrix; (void)which;
             (void)maxiter; (void)tol; (void)evs;
-            dseigsa(n, dphi_matrix, evs, result);
+            dseigsa(n, dphi_matrix, evs, opts, result);
         } else {
-            // ARPACK's ?NAUPD and ?NEUPD (Carefull, make sure k < n-1!)
-            printf("%s\n", "Not implemented yet");
+            // ARPACK's DSAUPD and DSEUPD (Carefull, make sure k < n!) or the
+            // (block) thick-restart Lanczos solver on real and imaginary parts
+            (void)zphi; (void)zphi_matrix; (void)dphi_matrix;
+            if (block)
+                zheigsf_block(n, NULL, dphi, NULL, dphi_block, phi_data, evs,
+                              which, k, nb, ncv, opts->nkeep, tol,
+                              maxiter, mode, creal(sigma), colmajor, dir,
+                              ctx ? &ctx->block : NULL, result);
+            else
+                dseigsf(n, dphi, phi_data, evs, which, k, ncv, tol,
+                        maxiter, mode, creal(sigma), colmajor, dir,
+                        ctx ? &ctx->ds : NULL, result);
         }
 
     } else {
@@ -124,9 +473,58 @@ eigs_result *eigs(const char *solver,
 
     }
 
+    // Dense solvers converge for all eigenvalues they return
+    if (dense) result->stats.nconv = result->k;
+
+    // Factorization stays cached at the matrix
+    if (factor) {
+        eigs_inverse_destroy(&inverse);
+        eigs_factor_release(sparse, factor);
+    }
+
+    // Eigenvalues of A
+    if (filtered) {
+        eigs_chebyshev_rayleigh(&cheb, result, colmajor);
+        eigs_chebyshev_destroy(&cheb);
+        if (!keep) {
+            if (!ctx && !result->borrowed) free(result->eigvecs);
+            result->eigvecs = NULL;
+            result->borrowed = false;
+        }
+    }
+
+    result->stats.time_total = eigs_clock()-start;
     return result;
 }
 
+// Default options
+void eigs_options_init(eigs_options *opts) {
+    opts->shift_invert = false;
+    opts->sigma = CMPLX(0., 0.);
+    opts->chebyshev = 0;
+    opts->overwrite = false;
+    opts->colmajor = false;
+    opts->eigvecs = NULL;
+    opts->range = 'A';
+    opts->il = 0;
+    opts->vl = 0.;
+    opts->vu = 0.;
+    opts->storage = 'F';
+    opts->kd = 0;
+    opts->balance = 'B';
+    opts->cphi = NULL;
+    opts->sphi = NULL;
+    opts->fphi_data = NULL;
+    opts->block = 1;
+    opts->zphi_block = NULL;
+    opts->dphi_block = NULL;
+    opts->ncv = 0;
+    opts->nkeep = 0;
+    opts->krylov_schur = false;
+    opts->memory = 0;
+    opts->basis_dir = NULL;
+}
+
 // Allocater for result type
 static eigs_result *eigs_result_alloc(int32_t n, int32_t k, bool evs) {
     eigs_result *result = (eigs_result *)malloc(sizeof(eigs_result));
@@ -136,12 +534,29 @@ static eigs_result *eigs_result_alloc(int32_t n, int32_t k, bool evs) {
         result->eigvecs = (double complex *)malloc(n*k*sizeof(double complex));
     else
         result->eigvecs = NULL;
+    result->borrowed = false;
+    result->nmatvec_float = 0;
+    result->nmatvec_refine = 0;
+    return result;
+}
+
+// Result of a context (eigenvectors are allocated on first request)
+static eigs_result *context_result(eigs_context *ctx, bool evs) {
+    eigs_result *result = &ctx->result;
+    result->n = ctx->n; result->k = ctx->k;
+    if (evs && !ctx->eigvecs)
+        ctx->eigvecs = (double complex *)eigs_malloc((size_t)ctx->n*ctx->k
+                                                     *sizeof(double complex));
+    result->eigvecs = evs ? ctx->eigvecs : NULL;
+    result->borrowed = false;
+    result->nmatvec_float = 0;
+    result->nmatvec_refine = 0;
     return result;
 }
 
 // Free memory allocated by result
 void eigs_result_free(eigs_result *result) {
     free(result->eigvals);
-    if (result->eigvecs) free(result->eigvecs);
+    if (result->eigvecs && !result->borrowed) free(result->eigvecs);
     free(result);
 }
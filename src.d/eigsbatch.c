@@ -0,0 +1,218 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Batched LAPACK based solver for all eigenvalues/-vectors of many hermitian *
+ * (symmetric) matrices                                                       *
+ * -------------------------------------------------------------------------- */
+
+
+#include "../inc.d/eigs.h"
+
+
+// Workspace of a single participant of the pool (allocated by its first
+// task, so a small batch does not allocate one for every participant)
+typedef struct _BatchWork {
+    void *a;
+    double *w;
+    void *work;
+    double *rwork;
+    lapack_int *iwork;
+} batch_work;
+
+// Data for internal usage
+typedef struct _EigsBatchData {
+
+    // User set
+    bool hermitian;
+    const double complex *const *zphi;
+    const double *const *dphi;
+    const int32_t *n;
+    bool evs;
+
+    // Internal
+    char jobz;
+    int32_t nmax;
+    lapack_int lwork;      // Divide and conquer workspaces for the largest
+    lapack_int lrwork;     // matrix
+    lapack_int liwork;
+    batch_work *work;
+
+    // Results
+    eigs_result *results;
+
+} eigs_batch_data;
+
+
+static void batch_task(void *, int32_t, int32_t);
+static void work_alloc(eigs_batch_data *, batch_work *);
+
+
+// Eigenvalues and eigenvectors of "count" matrices at once
+eigs_result *eigs_batch(const char *solver,
+                        const double complex *const *zphi_matrices,
+                        const double *const *dphi_matrices,
+                        const int32_t *n,
+                        int32_t count,
+                        bool evs) {
+
+    eigs_batch_data data;
+    int32_t i, nmax;
+    size_t head, size;
+
+    // Check solver
+    if (!strcmp(solver, "zh")) {
+        data.hermitian = true;
+    } else
+    if (!strcmp(solver, "ds")) {
+        data.hermitian = false;
+    } else {
+        printf("EIGS_BATCH: Solver *%s* not implemented\n", solver);
+        exit(1);
+    }
+    data.zphi = zphi_matrices; data.dphi = dphi_matrices;
+    data.n = n; data.evs = evs;
+    data.jobz = evs ? 'V' : 'N';
+
+    // Allocate results and a single arena for all eigenvalues/-vectors
+    head = (count*sizeof(eigs_result)+63)/64*64;
+    size = 0; nmax = 1;
+    for (i=0; i<count; i++) {
+        size += (size_t)n[i]*(evs ? n[i]+1 : 1);
+        if (n[i] > nmax) nmax = n[i];
+    }
+    char *arena = (char *)malloc(head+size*sizeof(double complex));
+    data.results = (eigs_result *)arena;
+    double complex *next = (double complex *)(arena+head);
+    for (i=0; i<count; i++) {
+        data.results[i].n = data.results[i].k = n[i];
+        data.results[i].eigvals = next; next += n[i];
+        data.results[i].eigvecs = NULL;
+        data.results[i].borrowed = false;
+        data.results[i].nmatvec_float = 0;
+        data.results[i].nmatvec_refine = 0;
+        memset(&data.results[i].stats, 0, sizeof(eigs_stats));
+        if (evs) { data.results[i].eigvecs = next; next += n[i]*n[i]; }
+    }
+
+    // Query optimal LAPACK workspaces once for the largest matrix (divide and
+    // conquer as for a single dense problem)
+    lapack_int info, iquery;
+    data.nmax = nmax; data.lrwork = 0;
+    if (data.hermitian) {
+        double complex query;
+        double rquery;
+        info = LAPACKE_zheevd_work(LAPACK_COL_MAJOR, data.jobz, 'L', nmax,
+                                   NULL, nmax, NULL, &query, -1, &rquery, -1,
+                                   &iquery, -1);
+        data.lwork = (lapack_int)creal(query);
+        data.lrwork = (lapack_int)rquery;
+    } else {
+        double query;
+        info = LAPACKE_dsyevd_work(LAPACK_COL_MAJOR, data.jobz, 'L', nmax,
+                                   NULL, nmax, NULL, &query, -1, &iquery, -1);
+        data.lwork = (lapack_int)query;
+    }
+    data.liwork = iquery;
+    if (info) {
+        printf("%s\n", "EIGS_BATCH: WORKSPACE QUERY FAILED"); exit(1);
+    }
+
+    // Workspaces of the participants, allocated on first use
+    int32_t size_pool = eigs_pool_size();
+    data.work = (batch_work *)calloc(size_pool, sizeof(batch_work));
+
+    // Solve all eigenproblems
+    eigs_pool_run(count, batch_task, &data);
+
+    // Clean up
+    for (i=0; i<size_pool; i++) {
+        free(data.work[i].a); free(data.work[i].w);
+        free(data.work[i].work); free(data.work[i].rwork);
+        free(data.work[i].iwork);
+    }
+    free(data.work);
+
+    return data.results;
+}
+
+// Free memory allocated by "eigs_batch"
+void eigs_batch_free(eigs_result *results) {
+    free(results);
+}
+
+// Solve a single eigenproblem of the batch
+static void batch_task(void *arg, int32_t task, int32_t worker) {
+
+    eigs_batch_data *data = (eigs_batch_data *)arg;
+    batch_work *work = &data->work[worker];
+    eigs_result *result = &data->results[task];
+    int32_t i, n = data->n[task];
+    lapack_int info;
+    double start = eigs_clock();
+
+    if (!work->a) work_alloc(data, work);
+
+    // The row-major input read as column-major is the transposed matrix,
+    // which has the same eigenvalues and complex conjugated eigenvectors
+    if (data->hermitian) {
+        memcpy(work->a, data->zphi[task], (size_t)n*n*sizeof(double complex));
+        info = LAPACKE_zheevd_work(LAPACK_COL_MAJOR, data->jobz, 'L', n,
+                                   (double complex *)work->a, n, work->w,
+                                   (double complex *)work->work, data->lwork,
+                                   work->rwork, data->lrwork, work->iwork,
+                                   data->liwork);
+    } else {
+        memcpy(work->a, data->dphi[task], (size_t)n*n*sizeof(double));
+        info = LAPACKE_dsyevd_work(LAPACK_COL_MAJOR, data->jobz, 'L', n,
+                                   (double *)work->a, n, work->w,
+                                   (double *)work->work, data->lwork,
+                                   work->iwork, data->liwork);
+    }
+
+    // Check result
+    if (info) {
+        printf("EIGS_BATCH: MATRIX %d DID NOT CONVERGE: INFO = %d\n",
+               task, info);
+        exit(1);
+    }
+
+    // Eigenvalues
+    for (i=0; i<n; i++) result->eigvals[i] = CMPLX(work->w[i], 0.);
+
+    // Eigenvectors (back to row-major)
+    if (data->evs && data->hermitian)
+        eigs_zvecs(n, n, (const double complex *)work->a, result->eigvecs,
+                   false, true);
+    else if (data->evs)
+        eigs_dvecs(n, n, (const double *)work->a, NULL, result->eigvecs,
+                   false, false);
+
+    result->stats.nconv = n;
+    result->stats.time_total = eigs_clock()-start;
+}
+
+// Workspace of a participant for matrices up to the largest one
+static void work_alloc(eigs_batch_data *data, batch_work *work) {
+    size_t nmax = data->nmax;
+    size_t elem = data->hermitian ? sizeof(double complex) : sizeof(double);
+    work->a = malloc(nmax*nmax*elem);
+    work->w = (double *)malloc(nmax*sizeof(double));
+    work->work = malloc(data->lwork*elem);
+    work->rwork = NULL;
+    if (data->hermitian)
+        work->rwork = (double *)malloc(data->lrwork*sizeof(double));
+    work->iwork = (lapack_int *)malloc(data->liwork*sizeof(lapack_int));
+}
@@ -0,0 +1,131 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Single precision eigensolver *eigs_float* (float and float complex maps)   *
+ *                                                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#include "../inc.d/eigs.h"
+
+
+static eigs_fresult *eigs_fresult_alloc(int32_t, int32_t, bool);
+
+
+// Eigensolver for float (complex) maps, the solvers are "cg", "sg", "ch" and
+// "ss", the arguments are the same as for "eigs" (results are float complex)
+eigs_fresult *eigs_float(const char *solver,
+                         ceigs_phi *cphi,
+                         seigs_phi *sphi,
+                         const float complex *cphi_matrix,
+                         const float *sphi_matrix,
+                         void *phi_data,
+                         int32_t n,
+                         int32_t k,
+                         const char *which,
+                         int32_t maxiter,
+                         float tol,
+                         bool evs) {
+
+    // Apply defaults if nessesary
+    if (tol < 0.f) tol = 0.f;
+    if (maxiter <= 0) maxiter = 10*n;
+
+    // Allocate memory for result
+    eigs_fresult *result = eigs_fresult_alloc(n, k, evs);
+
+    // Apply solver to problem
+    if (!strcmp(solver, "cg")) { /* --- FLOAT COMPLEX GENERAL --- */
+
+        // Either solve for all or a few eigenvalues/-vectors
+        if (k == n) {
+            // LAPACK(E)'s (LAPACK_)CGEEV
+            cgeigsa(n, cphi_matrix, evs, result);
+        } else {
+            // ARPACK's CNAUPD and CNEUPD (Carefull, make sure k < n-1!)
+            cgeigsf(n, cphi, phi_data, evs, which, k, tol, maxiter, result);
+        }
+
+    } else
+    if (!strcmp(solver, "sg")) { /* --- FLOAT GENERAL --- */
+
+        // Either solve for all or a few eigenvalues/-vectors
+        if (k == n) {
+            // LAPACK(E)'s (LAPACK_)SGEEV
+            sgeigsa(n, sphi_matrix, evs, result);
+        } else {
+            // ARPACK's SNAUPD and SNEUPD (Carefull, make sure k < n-1!)
+            sgeigsf(n, sphi, phi_data, evs, which, k, tol, maxiter, result);
+        }
+
+    } else
+    if (!strcmp(solver, "ch")) { /* --- FLOAT COMPLEX HERMITIAN --- */
+
+        // Either solve for all or a few eigenvalues/-vectors
+        if (k == n) {
+            // LAPACK(E)'s (LAPACK_)CHEEVD
+            cheigsa(n, cphi_matrix, evs, result);
+        } else {
+            // ARPACK's CNAUPD and CNEUPD (Carefull, make sure k < n-1!), the
+            // eigenvalues are real
+            if (!strcmp(which, "LA")) which = "LR";
+            if (!strcmp(which, "SA")) which = "SR";
+            cgeigsf(n, cphi, phi_data, evs, which, k, tol, maxiter, result);
+            for (int32_t j=0; j<k; j++)
+                result->eigvals[j] = CMPLXF(crealf(result->eigvals[j]), 0.f);
+        }
+
+    } else
+    if (!strcmp(solver, "ss")) { /* --- FLOAT SYMMETRIC --- */
+
+        // Either solve for all or a few eigenvalues/-vectors
+        if (k == n) {
+            // LAPACK(E)'s (LAPACK_)SSYEVD
+            sseigsa(n, sphi_matrix, evs, result);
+        } else {
+            // ARPACK's SSAUPD and SSEUPD (Carefull, make sure k < n!)
+            sseigsf(n, sphi, phi_data, evs, which, k, tol, maxiter, result);
+        }
+
+    } else {
+
+        printf("EIGS_FLOAT: Solver *%s* not implemented\n", solver);
+        exit(1);
+
+    }
+
+    return result;
+}
+
+// Free memory allocated by result of "eigs_float"
+void eigs_fresult_free(eigs_fresult *result) {
+    free(result->eigvals);
+    if (result->eigvecs) free(result->eigvecs);
+    free(result);
+}
+
+// Allocater for float result type
+static eigs_fresult *eigs_fresult_alloc(int32_t n, int32_t k, bool evs) {
+    eigs_fresult *result = (eigs_fresult *)malloc(sizeof(eigs_fresult));
+    result->n = n; result->k = k;
+    result->eigvals = (float complex *)malloc(k*sizeof(float complex));
+    if (evs)
+        result->eigvecs =
+            (float complex *)malloc((size_t)n*k*sizeof(float complex));
+    else
+        result->eigvecs = NULL;
+    return result;
+}
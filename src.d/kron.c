@@ -0,0 +1,447 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Matrix-free sums of Kronecker products (tensor-product operators)          *
+ *                                                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+
+#include "../inc.d/eigs.h"
+
+
+// Factors of at least this dimension are applied by GEMM, smaller ones (spin
+// or Pauli matrices) by loops which skip their zeros
+#define GEMM_DIM 8
+
+// Columns (contiguous indices of the later modes) per block of a product
+#define BLOCK_COLS 512
+
+// Tasks per participant of the pool and the smallest product (in doubles)
+// worth distributing
+#define BLOCKS_PER_THREAD 4
+#define PARALLEL_SIZE 32768
+
+
+// Term c O_0 x ... x O_{nmodes-1} with nfactors non-identity factors
+typedef struct _EigsKronTerm {
+    double complex c;
+    int32_t nfactors;
+    int32_t *mode;         // Modes of the factors (ascending)
+    double complex **z;    // Factors (row-major)
+    double **d;            // Real parts of the factors
+} kron_term;
+
+// Product of a factor along one mode: x and y are L x d x R arrays (of
+// doubles or double complex numbers), y = alpha A x + beta y
+typedef struct _KronJob {
+    bool complex_values;
+    const double complex *za;
+    const double *da;
+    int32_t d;
+    int64_t l;
+    int64_t r;
+    const double *x;
+    double *y;
+    double complex alpha;
+    double beta;
+    bool gemm;
+    int64_t nrb;           // Column blocks per index l (loops and GEMM)
+    int64_t units;
+    int32_t ntasks;
+} kron_job;
+
+// Product of the diagonal with x (w doubles per element of the diagonal)
+typedef struct _KronDiagJob {
+    const eigs_kron *h;
+    const double *x;
+    double *y;
+    int32_t w;
+    int32_t ntasks;
+} kron_diag_job;
+
+
+static bool diagonal(const eigs_kron *, const double complex *const *,
+                     const double *const *);
+static void add_diagonal(eigs_kron *, double complex,
+                         const double complex *const *,
+                         const double *const *);
+static void apply(eigs_kron *, const double *, double *, int32_t);
+static void diag_task(void *, int32_t, int32_t);
+static void mode_product(kron_job *);
+static void mode_task(void *, int32_t, int32_t);
+static void dloops(const kron_job *, int64_t, int64_t, int64_t);
+static void zloops(const kron_job *, int64_t, int64_t, int64_t);
+
+
+// Operator on the tensor product of spaces of dimensions dims[0],...,
+// dims[nmodes-1] (mode 0 is the slowest index); add terms with
+// "eigs_kron_add"
+eigs_kron *eigs_kron_init(int32_t nmodes, const int32_t *dims) {
+
+    int64_t n = 1;
+    for (int32_t i=0; i<nmodes; i++) {
+        if (dims[i] < 1) {
+            printf("EIGS_KRON: DIMENSION %d OF MODE %d\n", dims[i], i);
+            exit(1);
+        }
+        n *= dims[i];
+        if (n > INT32_MAX) {
+            printf("%s\n", "EIGS_KRON: DIMENSION OF THE PRODUCT TOO LARGE");
+            exit(1);
+        }
+    }
+
+    eigs_kron *h = (eigs_kron *)malloc(sizeof(eigs_kron));
+    h->nmodes = nmodes;
+    h->dims = (int32_t *)malloc(nmodes*sizeof(int32_t));
+    memcpy(h->dims, dims, nmodes*sizeof(int32_t));
+    h->n = (int32_t)n;
+    h->complex_values = false;
+    h->nterms = 0;
+    h->terms = NULL;
+    h->diag = NULL;
+
+    // Intermediate products of terms with several factors
+    h->buf = (double *)eigs_malloc(4*(size_t)n*sizeof(double));
+    pthread_mutex_init(&h->lock, NULL);
+
+    return h;
+}
+
+// Add the term c O_0 x ... x O_{nmodes-1}: "zfactors" or "dfactors" (the
+// other one is NULL) holds a row-major dims[i] x dims[i] matrix per mode or
+// NULL for the identity; both NULL adds c times the identity (the factors
+// are copied)
+void eigs_kron_add(eigs_kron *h,
+                   double complex c,
+                   const double complex *const *zfactors,
+                   const double *const *dfactors) {
+
+    int32_t i, f, nf = 0;
+    size_t dd;
+
+    // Diagonal terms (fields, Ising couplings, the identity) are summed up
+    // in a single diagonal applied in one pass
+    if (diagonal(h, zfactors, dfactors)) {
+        add_diagonal(h, c, zfactors, dfactors);
+        return;
+    }
+
+    // Room for the term (capacity doubles at powers of two)
+    if ((h->nterms & (h->nterms-1)) == 0) {
+        int32_t cap = h->nterms ? 2*h->nterms : 1;
+        h->terms = (kron_term *)realloc(h->terms, cap*sizeof(kron_term));
+    }
+    kron_term *t = &h->terms[h->nterms++];
+
+    for (i=0; i<h->nmodes; i++)
+        if ((zfactors && zfactors[i]) || (dfactors && dfactors[i])) nf++;
+    t->c = c;
+    t->nfactors = nf;
+    t->mode = (int32_t *)malloc(nf*sizeof(int32_t));
+    t->z = (double complex **)malloc(nf*sizeof(double complex *));
+    t->d = (double **)malloc(nf*sizeof(double *));
+    if (cimag(c) != 0.) h->complex_values = true;
+
+    for (i=0, f=0; i<h->nmodes; i++) {
+        if (!((zfactors && zfactors[i]) || (dfactors && dfactors[i])))
+            continue;
+        dd = (size_t)h->dims[i]*h->dims[i];
+        t->mode[f] = i;
+        t->z[f] = (double complex *)malloc(dd*sizeof(double complex));
+        t->d[f] = (double *)malloc(dd*sizeof(double));
+        for (size_t j=0; j<dd; j++) {
+            t->z[f][j] = zfactors ? zfactors[i][j]
+                                  : CMPLX(dfactors[i][j], 0.);
+            t->d[f][j] = creal(t->z[f][j]);
+            if (cimag(t->z[f][j]) != 0.) h->complex_values = true;
+        }
+        f++;
+    }
+}
+
+// Free memory allocated by the operator
+void eigs_kron_free(eigs_kron *h) {
+    for (int32_t j=0; j<h->nterms; j++) {
+        kron_term *t = &h->terms[j];
+        for (int32_t f=0; f<t->nfactors; f++) { free(t->z[f]); free(t->d[f]); }
+        free(t->mode); free(t->z); free(t->d);
+    }
+    free(h->terms);
+    free(h->diag);
+    free(h->dims);
+    free(h->buf);
+    pthread_mutex_destroy(&h->lock);
+    free(h);
+}
+
+// Action of the operator on a double complex vector (use as "zphi" with
+// "phi_data" being the operator)
+void eigs_kron_zphi(void *h, int32_t n, const double complex *x,
+                    double complex *y) {
+    eigs_kron *op = (eigs_kron *)h;
+    if (n != op->n) {
+        printf("EIGS_KRON: N = %d, OPERATOR HAS DIMENSION %d\n", n, op->n);
+        exit(1);
+    }
+    // A real operator acts on real and imaginary parts alike, i.e. on a
+    // further mode of dimension 2
+    apply(op, (const double *)x, (double *)y, op->complex_values ? 1 : 2);
+}
+
+// Action of a real operator on a double vector (use as "dphi" with
+// "phi_data" being the operator)
+void eigs_kron_dphi(void *h, int32_t n, const double *x, double *y) {
+    eigs_kron *op = (eigs_kron *)h;
+    if (n != op->n) {
+        printf("EIGS_KRON: N = %d, OPERATOR HAS DIMENSION %d\n", n, op->n);
+        exit(1);
+    }
+    if (op->complex_values) {
+        printf("%s\n", "EIGS_KRON: OPERATOR IS COMPLEX, USE eigs_kron_zphi");
+        exit(1);
+    }
+    apply(op, x, y, 1);
+}
+
+// y = H x, the terms one after the other: factors are applied mode by mode
+// through two buffers, the last one adds c O x to y; w is 2 for a real
+// operator on complex vectors (doubles are then the unit), else 1
+static void apply(eigs_kron *h, const double *x, double *y, int32_t w) {
+
+    bool cplx = h->complex_values;
+    size_t len = (size_t)h->n*(cplx ? 2 : w);
+    int32_t j, f, i;
+
+    // Buffers are in use by another thread: work with own ones
+    double *buf = h->buf;
+    bool own = pthread_mutex_trylock(&h->lock);
+    if (own) buf = (double *)eigs_malloc(2*len*sizeof(double));
+
+    // Diagonal part
+    if (h->diag) {
+        kron_diag_job job = { h, x, y, cplx ? 1 : w, 1 };
+        if (len >= PARALLEL_SIZE)
+            job.ntasks = BLOCKS_PER_THREAD*eigs_pool_size();
+        eigs_pool_run(job.ntasks, diag_task, &job);
+    } else {
+        memset(y, 0, len*sizeof(double));
+    }
+
+    for (j=0; j<h->nterms; j++) {
+        kron_term *t = &h->terms[j];
+        const double *src = x;
+        for (f=0; f<t->nfactors; f++) {
+            bool last = (f == t->nfactors-1);
+            int32_t m = t->mode[f];
+            kron_job job;
+            job.complex_values = cplx;
+            job.za = t->z[f]; job.da = t->d[f];
+            job.d = h->dims[m];
+            job.l = 1; job.r = cplx ? 1 : w;
+            for (i=0; i<m; i++) job.l *= h->dims[i];
+            for (i=m+1; i<h->nmodes; i++) job.r *= h->dims[i];
+            job.x = src;
+            job.y = last ? y : &buf[(f%2)*len];
+            job.alpha = last ? t->c : CMPLX(1., 0.);
+            job.beta = last ? 1. : 0.;
+            mode_product(&job);
+            src = job.y;
+        }
+    }
+
+    if (own) free(buf);
+    else pthread_mutex_unlock(&h->lock);
+}
+
+// Elements of block "task" of y = D x
+static void diag_task(void *arg, int32_t task, int32_t worker) {
+
+    const kron_diag_job *job = (const kron_diag_job *)arg;
+    const eigs_kron *h = job->h;
+    int64_t i0 = ((int64_t)h->n*task)/job->ntasks;
+    int64_t i1 = ((int64_t)h->n*(task+1))/job->ntasks, i;
+    (void)worker;
+
+    if (h->complex_values) {
+        const double complex *x = (const double complex *)job->x;
+        double complex *y = (double complex *)job->y;
+        for (i=i0; i<i1; i++) y[i] = h->diag[i]*x[i];
+    } else
+    if (job->w == 2) {
+        for (i=i0; i<i1; i++) {
+            job->y[2*i] = creal(h->diag[i])*job->x[2*i];
+            job->y[2*i+1] = creal(h->diag[i])*job->x[2*i+1];
+        }
+    } else {
+        for (i=i0; i<i1; i++) job->y[i] = creal(h->diag[i])*job->x[i];
+    }
+}
+
+// All factors of a term are diagonal
+static bool diagonal(const eigs_kron *h,
+                     const double complex *const *zfactors,
+                     const double *const *dfactors) {
+
+    int32_t i, a, b, d;
+    for (i=0; i<h->nmodes; i++) {
+        d = h->dims[i];
+        for (a=0; a<d; a++) for (b=0; b<d; b++) {
+            if (a == b) continue;
+            if (zfactors && zfactors[i] && (zfactors[i][d*a+b] != 0.))
+                return false;
+            if (dfactors && dfactors[i] && (dfactors[i][d*a+b] != 0.))
+                return false;
+        }
+    }
+    return true;
+}
+
+// Add the diagonal term c O_0 x ... x O_{nmodes-1} to the diagonal
+static void add_diagonal(eigs_kron *h,
+                         double complex c,
+                         const double complex *const *zfactors,
+                         const double *const *dfactors) {
+
+    int32_t i, m, a, d;
+    double complex v;
+
+    if (!h->diag)
+        h->diag = (double complex *)calloc(h->n, sizeof(double complex));
+
+    for (i=0; i<h->n; i++) {
+        v = c;
+        for (m=h->nmodes-1, a=i; m>=0; m--) {
+            d = h->dims[m];
+            if (zfactors && zfactors[m]) v *= zfactors[m][(d+1)*(a%d)];
+            if (dfactors && dfactors[m]) v *= dfactors[m][(d+1)*(a%d)];
+            a /= d;
+        }
+        h->diag[i] += v;
+        if (cimag(v) != 0.) h->complex_values = true;
+    }
+}
+
+// Split a product along one mode into tasks for the pool: blocks of
+// indices l for the last mode with GEMM, else blocks of (l, column block)
+static void mode_product(kron_job *job) {
+
+    job->gemm = (job->d >= GEMM_DIM);
+    job->nrb = (job->gemm && (job->r == 1)) ? 1
+                                            : (job->r+BLOCK_COLS-1)/BLOCK_COLS;
+    job->units = job->l*job->nrb;
+
+    int64_t size = job->l*job->d*job->r*(job->complex_values ? 2 : 1);
+    int64_t ntasks = (int64_t)BLOCKS_PER_THREAD*eigs_pool_size();
+    if (ntasks > job->units) ntasks = job->units;
+    if (size < PARALLEL_SIZE) ntasks = 1;
+    job->ntasks = (int32_t)ntasks;
+
+    eigs_pool_run(job->ntasks, mode_task, job);
+}
+
+// Units u0,...,u1-1 of a product along one mode
+static void mode_task(void *arg, int32_t task, int32_t worker) {
+
+    const kron_job *job = (const kron_job *)arg;
+    int64_t u0 = (job->units*task)/job->ntasks;
+    int64_t u1 = (job->units*(task+1))/job->ntasks;
+    int64_t d = job->d, r = job->r, u, l, c0, c1;
+    (void)worker;
+
+    // Last mode: Y = alpha X A^T + beta Y with X, Y of u1-u0 rows
+    if (job->gemm && (r == 1)) {
+        if (job->complex_values) {
+            double complex beta = CMPLX(job->beta, 0.);
+            cblas_zgemm(CblasRowMajor, CblasNoTrans, CblasTrans, u1-u0, d, d,
+                        &job->alpha, &job->x[2*u0*d], d, job->za, d, &beta,
+                        &job->y[2*u0*d], d);
+        } else {
+            cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasTrans, u1-u0, d, d,
+                        creal(job->alpha), &job->x[u0*d], d, job->da, d,
+                        job->beta, &job->y[u0*d], d);
+        }
+        return;
+    }
+
+    for (u=u0; u<u1; u++) {
+        l = u/job->nrb;
+        c0 = (u%job->nrb)*BLOCK_COLS;
+        c1 = (c0+BLOCK_COLS < r) ? c0+BLOCK_COLS : r;
+
+        // Y_l = alpha A X_l + beta Y_l on the columns c0,...,c1-1
+        if (!job->gemm) {
+            if (job->complex_values) zloops(job, l, c0, c1);
+            else dloops(job, l, c0, c1);
+        } else
+        if (job->complex_values) {
+            double complex beta = CMPLX(job->beta, 0.);
+            size_t off = 2*((size_t)l*d*r+c0);
+            cblas_zgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, d, c1-c0,
+                        d, &job->alpha, job->za, d, &job->x[off], r, &beta,
+                        &job->y[off], r);
+        } else {
+            size_t off = (size_t)l*d*r+c0;
+            cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, d, c1-c0,
+                        d, creal(job->alpha), job->da, d, &job->x[off], r,
+                        job->beta, &job->y[off], r);
+        }
+    }
+}
+
+// Small real factor on the index l and the columns c0,...,c1-1
+static void dloops(const kron_job *job, int64_t l, int64_t c0, int64_t c1) {
+
+    int64_t d = job->d, r = job->r, a, b, c;
+    double alpha = creal(job->alpha), s;
+    const double *x = &job->x[l*d*r];
+    double *y = &job->y[l*d*r];
+
+    for (a=0; a<d; a++) {
+        double *ya = &y[a*r];
+        if (job->beta == 0.) for (c=c0; c<c1; c++) ya[c] = 0.;
+        for (b=0; b<d; b++) {
+            s = alpha*job->da[d*a+b];
+            if (s == 0.) continue;
+            const double *xb = &x[b*r];
+            for (c=c0; c<c1; c++) ya[c] += s*xb[c];
+        }
+    }
+}
+
+// Small complex factor on the index l and the columns c0,...,c1-1
+static void zloops(const kron_job *job, int64_t l, int64_t c0, int64_t c1) {
+
+    int64_t d = job->d, r = job->r, a, b, c;
+    double complex s;
+    const double complex *x = &((const double complex *)job->x)[l*d*r];
+    double complex *y = &((double complex *)job->y)[l*d*r];
+
+    for (a=0; a<d; a++) {
+        double complex *ya = &y[a*r];
+        if (job->beta == 0.) for (c=c0; c<c1; c++) ya[c] = 0.;
+        for (b=0; b<d; b++) {
+            s = job->alpha*job->za[d*a+b];
+            if (s == 0.) continue;
+            const double complex *xb = &x[b*r];
+            for (c=c0; c<c1; c++) ya[c] += s*xb[c];
+        }
+    }
+}
@@ -0,0 +1,661 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Krylov-Schur solver for a few eigenvalues/-vectors of a general double     *
+ * complex (or double) endomorphism                                           *
+ * -------------------------------------------------------------------------- */
+
+
+#include <math.h>
+
+#include "../inc.d/eigs.h"
+
+
+// Data for internal usage
+typedef struct _KrylovSchurData {
+
+    // User set
+    a_int n;            // Length of the (local slices of the) vectors
+    a_int nglobal;      // Dimension of the problem
+    eigs_reduce *reduce; // Sum over the slices of a distributed basis (NULL:
+    void *reduce_data;   // the vectors are not distributed)
+    a_int stream;       // Random numbers of this slice (rank of the process)
+    zeigs_phi *zphi;
+    deigs_phi *dphi;
+    void *phi_data;
+    a_int nev;
+    const char *which;
+    bool evs;
+    double tol;
+    a_int ncv;
+    a_int mxiter;
+    a_int mode;
+    a_dcomplex sigma;
+
+    // Internal
+    a_dcomplex *v;      // Krylov basis, n x (ncv+1), column-major
+    a_dcomplex *w;      // Work vector of length n
+    double *split;      // Real and imaginary parts for a real map, n x 4
+    a_dcomplex *h;      // Rayleigh quotient, (ncv+1) x ncv
+    a_dcomplex *c;      // Reorthogonalization coefficients of length ncv+1
+    a_dcomplex *t;      // Schur form of the Rayleigh quotient, ncv x ncv
+    a_dcomplex *s;      // Schur form of its active (unlocked) part
+    a_dcomplex *q;      // Schur vectors of the active part
+    a_dcomplex *y;      // Eigenvectors of the leading nev x nev Schur form
+    a_dcomplex *qy;     // Eigenvectors of the Rayleigh quotient, ncv x nev
+    a_dcomplex *b;      // Residual coupling of the Schur vectors, length ncv
+    a_dcomplex *tmp;    // Buffer for basis rotations, EIGS_ROTATE_ROWS x
+                        // ncv
+    a_dcomplex *theta;  // Ritz values (diagonal of t), length ncv
+    a_int *order;       // Wanted Ritz values ordered by "which"
+    a_int nkeep;        // Number of Schur vectors kept at restart
+    a_int p;            // Size of the decomposition before an expansion
+    a_int nlock;        // Number of locked (converged) Schur vectors
+    a_int nconv;
+    a_int iter;
+    a_int iseed[4];
+    double eps;
+    eigs_stats stats;   // Counters and timers
+
+    // Results
+    a_dcomplex *d;
+    a_dcomplex *z;
+
+} ks_data;
+
+
+static ks_data *ks_alloc(a_int,
+                         a_int,
+                         a_int,
+                         a_int,
+                         const char *);
+static void ks_init(ks_data *,
+                    zeigs_phi *,
+                    deigs_phi *,
+                    void *,
+                    const a_dcomplex *,
+                    const char *,
+                    bool,
+                    double,
+                    a_int,
+                    a_int,
+                    a_int,
+                    a_dcomplex);
+static void ks_data_destroy(ks_data *);
+static void krylov_schur_iterations(ks_data *);
+static void expand(ks_data *);
+static void apply(ks_data *, const a_dcomplex *, a_dcomplex *);
+static void orthogonalize(ks_data *, a_int, a_dcomplex *);
+static double normalize(ks_data *,
+                        const a_dcomplex *,
+                        a_dcomplex *,
+                        double);
+static bool wanted(const char *, a_dcomplex, a_dcomplex);
+static void schur(ks_data *);
+static void restart(ks_data *);
+static void extract(ks_data *, a_dcomplex *);
+static eigs_result *prepare_result(ks_data *, eigs_result *, bool);
+
+
+// Eigenvalues and eigenvectors ("zphi" or "dphi" is NULL, a real map acts on
+// the real and imaginary parts of the complex basis); the iteration starts
+// from "start" (the real part for a real map) or, if NULL, a random vector
+void zgeigsf_ks(a_int n,
+                zeigs_phi *zphi,
+                deigs_phi *dphi,
+                void *phi_data,
+                const a_dcomplex *start,
+                bool evs,
+                const char *which,
+                a_int k,
+                a_int ncv,
+                a_int nkeep,
+                double tol,
+                a_int maxiter,
+                a_int mode,
+                a_dcomplex sigma,
+                bool colmajor,
+                const char *basis_dir,
+                void **work,
+                eigs_result *result) {
+
+    // Workspace (kept in "*work" for further solves if "work" is not NULL
+    // and neither the dimension of the subspace nor the storage of the basis
+    // change)
+    ks_data *data = work ? (ks_data *)*work : NULL;
+    if (data && ((data->ncv != eigs_ncv(n, k, ncv)) ||
+                 (eigs_basis_mapped(data->v) != (basis_dir != NULL)))) {
+        ks_data_destroy(data);
+        data = NULL;
+    }
+    if (!data) data = ks_alloc(n, n, k, ncv, basis_dir);
+    if (work) *work = data;
+    data->reduce = NULL;
+    data->reduce_data = NULL;
+    data->stream = 0;
+
+    // Initialize data
+    ks_init(data,
+            zphi,
+            dphi,
+            phi_data,
+            start,
+            which,
+            evs,
+            tol,
+            nkeep,
+            maxiter,
+            mode,
+            sigma);
+
+    // Krylov-Schur iterations
+    krylov_schur_iterations(data);
+    result->stats = data->stats;
+
+    // Extract eigenvalues and (possibly) eigenvectors, column-major ones
+    // directly into the result
+    double t = eigs_clock();
+    extract(data, (evs && colmajor) ? result->eigvecs : data->z);
+
+    // Prepare result
+    prepare_result(data, result, colmajor);
+    result->stats.time_extract = eigs_clock()-t;
+
+    // Clean up
+    if (!work) ks_data_destroy(data);
+}
+
+// Eigenvalues and (local slices of the) eigenvectors of a map acting on
+// vectors distributed over several processes: each process owns "nloc" rows
+// of the basis, "reduce" sums the projections over all processes, "stream"
+// (the rank) selects the random numbers of the slice
+void zgeigsf_ks_dist(a_int n,
+                     a_int nloc,
+                     eigs_reduce *reduce,
+                     void *reduce_data,
+                     a_int stream,
+                     zeigs_phi *zphi,
+                     deigs_phi *dphi,
+                     void *phi_data,
+                     bool evs,
+                     const char *which,
+                     a_int k,
+                     a_int ncv,
+                     a_int nkeep,
+                     double tol,
+                     a_int maxiter,
+                     a_int mode,
+                     a_dcomplex sigma,
+                     bool colmajor,
+                     const char *basis_dir,
+                     eigs_result *result) {
+
+    ks_data *data = ks_alloc(n, nloc, k, ncv, basis_dir);
+    data->reduce = reduce;
+    data->reduce_data = reduce_data;
+    data->stream = stream;
+
+    ks_init(data, zphi, dphi, phi_data, NULL, which, evs, tol, nkeep,
+            maxiter, mode, sigma);
+    krylov_schur_iterations(data);
+    result->stats = data->stats;
+
+    double t = eigs_clock();
+    extract(data, (evs && colmajor) ? result->eigvecs : data->z);
+    prepare_result(data, result, colmajor);
+    result->stats.time_extract = eigs_clock()-t;
+
+    ks_data_destroy(data);
+}
+
+// Free workspace kept by "zgeigsf_ks"
+void zgeigsf_ks_free(void *work) {
+    if (work) ks_data_destroy((ks_data *)work);
+}
+
+// Allocate memory for data (vectors of length "nloc" of a problem of
+// dimension n)
+static ks_data *ks_alloc(a_int n, a_int nloc, a_int k, a_int ncv,
+                         const char *basis_dir) {
+
+    ks_data *data = (ks_data *)eigs_malloc(sizeof(ks_data));
+    size_t nz = sizeof(a_dcomplex), nd = sizeof(double);
+
+    // Dimensions
+    data->n = nloc;
+    data->nglobal = n;
+    data->nev = k;
+    data->ncv = eigs_ncv(n, k, ncv);
+    a_int m = data->ncv;
+    n = nloc;
+
+    // Internal
+    data->v = (a_dcomplex *)eigs_basis_alloc((size_t)n*(m+1)*nz, basis_dir);
+    data->w = (a_dcomplex *)eigs_malloc(n*nz);
+    data->split = (double *)eigs_malloc((size_t)4*n*nd);
+    data->h = (a_dcomplex *)eigs_malloc((m+1)*m*nz);
+    data->c = (a_dcomplex *)eigs_malloc((m+1)*nz);
+    data->t = (a_dcomplex *)eigs_malloc(m*m*nz);
+    data->s = (a_dcomplex *)eigs_malloc(m*m*nz);
+    data->q = (a_dcomplex *)eigs_malloc(m*m*nz);
+    data->y = (a_dcomplex *)eigs_malloc(m*k*nz);
+    data->qy = (a_dcomplex *)eigs_malloc(m*k*nz);
+    data->b = (a_dcomplex *)eigs_malloc(m*nz);
+    data->tmp = (a_dcomplex *)eigs_malloc(EIGS_ROTATE_ROWS*m*nz);
+    data->theta = (a_dcomplex *)eigs_malloc(m*nz);
+    data->order = (a_int *)eigs_malloc(k*sizeof(a_int));
+
+    // Results
+    data->d = (a_dcomplex *)eigs_malloc(k*nz);
+    data->z = (a_dcomplex *)eigs_malloc((size_t)n*k*nz);
+
+    return data;
+}
+
+// Bytes allocated by "ks_alloc"
+size_t zgeigsf_ks_bytes(a_int n, a_int k, a_int ncv, const char *basis_dir) {
+    size_t nn = n, m = eigs_ncv(n, k, ncv), nz = sizeof(a_dcomplex);
+    return sizeof(ks_data)
+           +(nn+(m+1)*(m+1)+3*m*m+2*m*k+2*m+EIGS_ROTATE_ROWS*m+k+nn*k)*nz
+           +4*nn*sizeof(double)+k*sizeof(a_int)
+           +eigs_basis_bytes(nn*(m+1)*nz, basis_dir);
+}
+
+// Initialize eigenproblem
+static void ks_init(ks_data *data,
+                    zeigs_phi *zphi,
+                    deigs_phi *dphi,
+                    void *phi_data,
+                    const a_dcomplex *start,
+                    const char *which,
+                    bool evs,
+                    double tol,
+                    a_int nkeep,
+                    a_int maxiter,
+                    a_int mode,
+                    a_dcomplex sigma) {
+
+    a_int n = data->n, i;
+
+    // Check which
+    if (strcmp(which, "LM") && strcmp(which, "SM") &&
+        strcmp(which, "LR") && strcmp(which, "SR") &&
+        strcmp(which, "LI") && strcmp(which, "SI")) {
+        printf("EIGS_KS: WHICH = %s NOT SUPPORTED\n", which);
+        exit(1);
+    }
+
+    // User set
+    data->zphi = zphi;
+    data->dphi = dphi;
+    data->which = which;
+    data->evs = evs;
+    data->eps = LAPACKE_dlamch('E');
+    data->tol = (tol > 0.) ? tol : data->eps; // Default machine precision
+    data->nkeep = eigs_nkeep(data->nev, data->ncv, nkeep);
+    data->mxiter = maxiter; // Default 10*n
+    data->phi_data = phi_data; // Default NULL
+    data->mode = mode; // 1 (regular) or 3 (shift-invert, phi is the inverse)
+    data->sigma = sigma; // Only referenced if mode is 3
+
+    // Internal (the Rayleigh quotient has to start out as zero)
+    memset(data->h, 0, (data->ncv+1)*data->ncv*sizeof(a_dcomplex));
+    data->p = 0;
+    data->nlock = 0;
+    data->nconv = 0;
+    data->iter = 0;
+    memset(&data->stats, 0, sizeof(eigs_stats));
+    data->iseed[0] = (1+data->stream)%4096;
+    data->iseed[1] = (3+data->stream/4096)%4096;
+    data->iseed[2] = 5; data->iseed[3] = 7;
+
+    // Given or random starting vector (real for a real map, the basis stays
+    // real up to the first restart)
+    if (start) {
+        for (i=0; i<n; i++)
+            data->v[i] = dphi ? CMPLX(creal(start[i]), 0.) : start[i];
+        if (normalize(data, data->v, data->v, 0.) > 0.) return;
+    }
+    eigs_basis_random(data->v, data->n, 0, data->iseed, data->w, data->tmp,
+                      data->reduce, data->reduce_data);
+    if (dphi) {
+        for (i=0; i<n; i++) data->v[i] = CMPLX(creal(data->v[i]), 0.);
+        normalize(data, data->v, data->v, 0.);
+    }
+}
+
+// Free for ks_data type
+static void ks_data_destroy(ks_data *data) {
+    eigs_basis_free(data->v); data->v = NULL;
+    free(data->w); data->w = NULL;
+    free(data->split); data->split = NULL;
+    free(data->h); data->h = NULL;
+    free(data->c); data->c = NULL;
+    free(data->t); data->t = NULL;
+    free(data->s); data->s = NULL;
+    free(data->q); data->q = NULL;
+    free(data->y); data->y = NULL;
+    free(data->qy); data->qy = NULL;
+    free(data->b); data->b = NULL;
+    free(data->tmp); data->tmp = NULL;
+    free(data->theta); data->theta = NULL;
+    free(data->order); data->order = NULL;
+    free(data->d); data->d = NULL;
+    free(data->z); data->z = NULL;
+    free(data);
+}
+
+// Do Krylov-Schur iterations
+static void krylov_schur_iterations(ks_data *data) {
+
+    double t;
+
+    for (data->iter=1; data->iter<=data->mxiter; data->iter++) {
+
+        // Extend the Krylov-Schur decomposition to ncv vectors
+        expand(data);
+
+        // Schur form, Ritz values and their residuals
+        t = eigs_clock();
+        schur(data);
+        data->stats.nconv = data->nconv;
+        if (data->nconv >= data->nev) {
+            data->stats.time_restart += eigs_clock()-t;
+            return;
+        }
+
+        // Lock converged Schur vectors, keep the best ones and start over
+        restart(data);
+        data->stats.nrestart++;
+        data->stats.time_restart += eigs_clock()-t;
+    }
+
+    printf("%s\n", "EIGS_KS: MAXIMAL ALLOWED ITERATIONS REACHED");
+    exit(1);
+}
+
+// Arnoldi steps p,...,ncv-1 (with full reorthogonalization), p is zero at
+// the start and nkeep after a restart
+static void expand(ks_data *data) {
+
+    a_int n = data->n, m = data->ncv, ld = m+1, p = data->p, j;
+    double beta, t0 = eigs_clock(), t, tphi = 0.;
+
+    for (j=p; j<m; j++) {
+
+        // Compute action of phi
+        t = eigs_clock();
+        apply(data, &data->v[(size_t)n*j], data->w);
+        tphi += eigs_clock()-t;
+        double wnorm = normalize(data, data->w, NULL, 0.);
+
+        // Orthogonalize against v_0,...,v_j, the coefficients form column j
+        // of the Rayleigh quotient
+        orthogonalize(data, j+1, &data->h[ld*j]);
+        data->stats.nreorth++;
+
+        // Next basis vector
+        beta = normalize(data, data->w, &data->v[(size_t)n*(j+1)],
+                         data->eps*wnorm);
+        if (beta <= data->eps*wnorm) {
+            // Invariant subspace found, continue with a random vector
+            beta = 0.;
+            if (j+1 < data->nglobal)
+                eigs_basis_random(data->v, n, j+1, data->iseed, data->w,
+                                  data->tmp, data->reduce, data->reduce_data);
+        }
+        data->h[ld*j+j+1] = CMPLX(beta, 0.);
+    }
+    data->stats.time_phi += tphi;
+    data->stats.time_orth += eigs_clock()-t0-tphi;
+}
+
+// Action of the map on x, a real map acts on the real and imaginary parts
+// (the latter only if it does not vanish on any process)
+static void apply(ks_data *data, const a_dcomplex *x, a_dcomplex *y) {
+
+    if (data->zphi) {
+        data->zphi(data->phi_data, data->n, x, y);
+        data->stats.nmatvec++;
+        return;
+    }
+    data->stats.nmatvec += eigs_basis_dapply(data->dphi, NULL,
+                                             data->phi_data, data->n, 1, x,
+                                             y, data->split, data->reduce,
+                                             data->reduce_data);
+}
+
+// Classical Gram-Schmidt with one reorthogonalization (CGS2) of w against
+// the first "nv" basis vectors, the coefficients are stored in h
+static void orthogonalize(ks_data *data, a_int nv, a_dcomplex *h) {
+
+    a_int n = data->n, ldv = (n > 0) ? n : 1, i;
+    const a_dcomplex one = CMPLX(1., 0.), mone = CMPLX(-1., 0.);
+    const a_dcomplex zero = CMPLX(0., 0.);
+
+    // An empty slice (distributed) adds nothing to the projections, BLAS
+    // returns early without touching them
+    if (!n) {
+        memset(h, 0, nv*sizeof(a_dcomplex));
+        memset(data->c, 0, nv*sizeof(a_dcomplex));
+    }
+
+    // First pass: h = V^H w, w = w - V h
+    cblas_zgemv(CblasColMajor, CblasConjTrans, n, nv, &one, data->v, ldv,
+                data->w, 1, &zero, h, 1);
+    if (data->reduce) data->reduce(data->reduce_data, h, nv);
+    cblas_zgemv(CblasColMajor, CblasNoTrans, n, nv, &mone, data->v, ldv,
+                h, 1, &one, data->w, 1);
+
+    // Second pass: c = V^H w, w = w - V c, h = h + c
+    cblas_zgemv(CblasColMajor, CblasConjTrans, n, nv, &one, data->v, ldv,
+                data->w, 1, &zero, data->c, 1);
+    if (data->reduce) data->reduce(data->reduce_data, data->c, nv);
+    cblas_zgemv(CblasColMajor, CblasNoTrans, n, nv, &mone, data->v, ldv,
+                data->c, 1, &one, data->w, 1);
+    for (i=0; i<nv; i++) h[i] += data->c[i];
+}
+
+// Euclidean norm of a (distributed) vector x and, if it exceeds "tiny" and
+// y is not NULL, y = x/|x|
+static double normalize(ks_data *data,
+                        const a_dcomplex *x,
+                        a_dcomplex *y,
+                        double tiny) {
+
+    if (!data->reduce) return eigs_znrm2_scale(data->n, x, y, tiny);
+
+    a_dcomplex s = eigs_zdotc(data->n, x, x);
+    data->reduce(data->reduce_data, &s, 1);
+    double nrm = sqrt(creal(s));
+    if (y && (nrm > tiny))
+        for (a_int i=0; i<data->n; i++) y[i] = x[i]/nrm;
+    return nrm;
+}
+
+// Ritz value a is wanted before b
+static bool wanted(const char *which, a_dcomplex a, a_dcomplex b) {
+    if (!strcmp(which, "LM")) return cabs(a) > cabs(b);
+    if (!strcmp(which, "SM")) return cabs(a) < cabs(b);
+    if (!strcmp(which, "LR")) return creal(a) > creal(b);
+    if (!strcmp(which, "SR")) return creal(a) < creal(b);
+    if (!strcmp(which, "LI")) return cimag(a) > cimag(b);
+    return cimag(a) < cimag(b);
+}
+
+// Schur form of the Rayleigh quotient with the locked part kept fixed and
+// the active part ordered by "which", residuals of the wanted Ritz vectors
+// and number of converged Ritz values
+static void schur(ks_data *data) {
+
+    a_int m = data->ncv, ld = m+1, L = data->nlock, ma = m-L, k = data->nev;
+    a_int i, j, r, best;
+    double eps23 = pow(data->eps, 2./3.), beta = creal(data->h[ld*(m-1)+m]);
+    const a_dcomplex one = CMPLX(1., 0.), zero = CMPLX(0., 0.);
+    lapack_int info, sdim, mout;
+
+    // Schur form S = Q^H H(L:m,L:m) Q of the active part
+    for (j=0; j<ma; j++)
+        memcpy(&data->s[ma*j], &data->h[ld*(L+j)+L], ma*sizeof(a_dcomplex));
+    info = LAPACKE_zgees(LAPACK_COL_MAJOR, 'V', 'N', NULL, ma, data->s, ma,
+                         &sdim, &data->theta[L], data->q, ma);
+    if (info) {
+        printf("EIGS_KS: LAPACKE_zgees FAILED: INFO = %d\n", info);
+        exit(1);
+    }
+
+    // Move the wanted Ritz values to the front in the order of "which" (only
+    // the kept ones, the remaining ones are discarded at the restart)
+    for (r=0; r<data->nkeep-L; r++) {
+        best = r;
+        for (i=r+1; i<ma; i++)
+            if (wanted(data->which, data->s[ma*i+i], data->s[ma*best+best]))
+                best = i;
+        if (best != r) {
+            info = LAPACKE_ztrexc(LAPACK_COL_MAJOR, 'V', ma, data->s, ma,
+                                  data->q, ma, best+1, r+1);
+            if (info) {
+                printf("EIGS_KS: LAPACKE_ztrexc FAILED: INFO = %d\n", info);
+                exit(1);
+            }
+        }
+    }
+
+    // Schur form of the whole Rayleigh quotient: the locked part is upper
+    // triangular already, its coupling to the active part is rotated by Q
+    for (j=0; j<L; j++) {
+        memcpy(&data->t[m*j], &data->h[ld*j], (j+1)*sizeof(a_dcomplex));
+        memset(&data->t[m*j+j+1], 0, (m-j-1)*sizeof(a_dcomplex));
+    }
+    if (L)
+        cblas_zgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, L, ma, ma,
+                    &one, &data->h[ld*L], ld, data->q, ma, &zero,
+                    &data->t[m*L], m);
+    for (j=0; j<ma; j++) {
+        memcpy(&data->t[m*(L+j)+L], &data->s[ma*j],
+               (j+1)*sizeof(a_dcomplex));
+        memset(&data->t[m*(L+j)+L+j+1], 0, (ma-j-1)*sizeof(a_dcomplex));
+    }
+    for (i=0; i<m; i++) data->theta[i] = data->t[m*i+i];
+
+    // Residual coupling b = beta e_m^T diag(I, Q) (vanishes for the locked
+    // part)
+    memset(data->b, 0, L*sizeof(a_dcomplex));
+    for (j=0; j<ma; j++) data->b[L+j] = beta*data->q[ma*j+ma-1];
+
+    // Eigenvectors of the leading nev x nev Schur form, the residual of the
+    // Ritz vector V Q y is |b^T y| (for normalized y)
+    info = LAPACKE_ztrevc(LAPACK_COL_MAJOR, 'R', 'A', NULL, k, data->t, m,
+                          NULL, 1, data->y, k, k, &mout);
+    if (info) {
+        printf("EIGS_KS: LAPACKE_ztrevc FAILED: INFO = %d\n", info);
+        exit(1);
+    }
+    data->nconv = 0;
+    for (j=0; j<k; j++) {
+        a_dcomplex *y = &data->y[k*j], res;
+        a_dcomplex scale = CMPLX(1./cblas_dznrm2(k, y, 1), 0.);
+        cblas_zscal(k, &scale, y, 1);
+        cblas_zdotu_sub(k, data->b, 1, y, 1, &res);
+        if (cabs(res) <= data->tol*fmax(eps23, cabs(data->theta[j])))
+            data->nconv++;
+    }
+}
+
+// Lock the leading converged Schur vectors and restart with the nkeep most
+// wanted ones: V(:,0:nkeep) = V diag(I, Q)(:,0:nkeep)
+static void restart(ks_data *data) {
+
+    a_int n = data->n, m = data->ncv, ld = m+1, L = data->nlock;
+    a_int p = data->nkeep, i, j;
+    double eps23 = pow(data->eps, 2./3.);
+
+    // Locking: the coupling of a converged leading Schur vector to the
+    // residual is dropped, the vector is not rotated anymore
+    for (i=L; i<data->nev; i++) {
+        if (cabs(data->b[i]) > data->tol*fmax(eps23, cabs(data->theta[i])))
+            break;
+        data->b[i] = CMPLX(0., 0.);
+    }
+
+    // Rotate the active part of the basis by one matrix product
+    eigs_basis_rotate(data->v, data->n, L, m-L, p-L, data->q, m-L,
+                      data->tmp);
+    data->nlock = i;
+
+    // The residual vector becomes v_nkeep
+    memcpy(&data->v[(size_t)n*p], &data->v[(size_t)n*m],
+           n*sizeof(a_dcomplex));
+
+    // Rayleigh quotient is upper triangular plus the coupling b in row nkeep
+    memset(data->h, 0, ld*m*sizeof(a_dcomplex));
+    for (j=0; j<p; j++) {
+        memcpy(&data->h[ld*j], &data->t[m*j], (j+1)*sizeof(a_dcomplex));
+        data->h[ld*j+p] = data->b[j];
+    }
+    data->p = p;
+}
+
+// Extract eigenvalues and (possiby) eigenvectors ordered by "which"
+static void extract(ks_data *data, a_dcomplex *z) {
+
+    a_int n = data->n, m = data->ncv, k = data->nev, L = data->nlock;
+    a_int i, j, l;
+    const a_dcomplex one = CMPLX(1., 0.), zero = CMPLX(0., 0.);
+
+    // Order by which (insertion sort, the locked ones were ordered when they
+    // were still active)
+    for (i=0; i<k; i++) {
+        l = i;
+        for (j=i; j>0; j--) {
+            if (!wanted(data->which, data->theta[l],
+                        data->theta[data->order[j-1]])) break;
+            data->order[j] = data->order[j-1];
+        }
+        data->order[j] = l;
+    }
+    for (i=0; i<k; i++) data->d[i] = data->theta[data->order[i]];
+
+    // Shift-invert: theta = 1/(lambda-sigma)
+    if (data->mode == 3)
+        for (i=0; i<k; i++) data->d[i] = data->sigma+1./data->d[i];
+
+    if (data->evs) {
+        // Eigenvectors of the Rayleigh quotient: diag(I, Q)(:,0:nev) y
+        for (i=0; i<k; i++) {
+            a_dcomplex *y = &data->y[k*data->order[i]], *x = &data->qy[m*i];
+            memcpy(x, y, L*sizeof(a_dcomplex));
+            cblas_zgemv(CblasColMajor, CblasNoTrans, m-L, k-L, &one, data->q,
+                        m-L, &y[L], 1, &zero, &x[L], 1);
+        }
+        a_int ldv = (n > 0) ? n : 1;
+        cblas_zgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, k, m, &one,
+                    data->v, ldv, data->qy, m, &zero, z, ldv);
+    }
+}
+
+// Load data into result (eigenvectors row-major unless "colmajor")
+static eigs_result *prepare_result(ks_data *data,
+                                   eigs_result *result,
+                                   bool colmajor) {
+    a_int n, k, j;
+    n = data->n; k = data->nev;
+    result->n = n; result->k = k;
+    for (j=0; j<k; j++) result->eigvals[j] = data->d[j];
+    if (data->evs && !colmajor)
+        eigs_zvecs(n, k, data->z, result->eigvecs, false, false);
+    return result;
+}
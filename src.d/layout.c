@@ -0,0 +1,234 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Conversion of column-major eigenvectors into the layout of the result      *
+ *                                                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#include "../inc.d/eigs.h"
+
+
+// Edge length of the tiles of a transposition
+#define TILE 32
+
+
+static bool dpair_first(const double *, int32_t);
+static bool spair_first(const float *, int32_t);
+static void transpose_inplace(int32_t, double complex *, bool);
+
+
+// Copy the n x k column-major eigenvectors "z" into "out", either
+// column-major or row-major and possibly complex conjugated; "z" may be
+// "out" (row-major then needs n = k)
+void eigs_zvecs(int32_t n,
+                int32_t k,
+                const double complex *z,
+                double complex *out,
+                bool colmajor,
+                bool conjugate) {
+
+    int64_t p, size = (int64_t)n*k;
+    int32_t ii, jj, i, j, imax, jmax;
+
+    if (colmajor) {
+        if (conjugate)
+            for (p=0; p<size; p++) out[p] = conj(z[p]);
+        else if (z != out)
+            memcpy(out, z, size*sizeof(double complex));
+        return;
+    }
+
+    if (z == out) { transpose_inplace(n, out, conjugate); return; }
+
+    for (ii=0; ii<n; ii+=TILE) {
+        imax = (ii+TILE < n) ? ii+TILE : n;
+        for (jj=0; jj<k; jj+=TILE) {
+            jmax = (jj+TILE < k) ? jj+TILE : k;
+            for (i=ii; i<imax; i++) {
+                for (j=jj; j<jmax; j++) {
+                    if (conjugate)
+                        out[(int64_t)k*i+j] = conj(z[(int64_t)n*j+i]);
+                    else
+                        out[(int64_t)k*i+j] = z[(int64_t)n*j+i];
+                }
+            }
+        }
+    }
+}
+
+// Same for real eigenvectors, where "wi" (NULL if all eigenvalues are real)
+// marks complex conjugate pairs as returned by LAPACK and ARPACK: the pairs
+// are consecutive, for the first member j of a pair the eigenvectors j and
+// j+1 are z_j + i z_j+1 and z_j - i z_j+1 (complex conjugated if
+// "conjugate"), whatever the sign of wi[j] (ARPACK's shift-invert mode
+// returns the negative one first); column-major output without pairs may
+// overlap "z" if "z" lies in the second half of "out"
+void eigs_dvecs(int32_t n,
+                int32_t k,
+                const double *z,
+                const double *wi,
+                double complex *out,
+                bool colmajor,
+                bool conjugate) {
+
+    int64_t p, size = (int64_t)n*k, rs, cs;
+    int32_t ii, jj, i, j, imax, jmax;
+    double s = conjugate ? -1. : 1.;
+
+    // Ascending order reads each element before it is overwritten
+    if (colmajor && !wi) {
+        for (p=0; p<size; p++) out[p] = CMPLX(z[p], 0.);
+        return;
+    }
+
+    rs = colmajor ? 1 : k;
+    cs = colmajor ? n : 1;
+    for (ii=0; ii<n; ii+=TILE) {
+        imax = (ii+TILE < n) ? ii+TILE : n;
+        for (jj=0; jj<k; jj+=TILE) {
+            jmax = (jj+TILE < k) ? jj+TILE : k;
+            for (j=jj; j<jmax; j++) {
+                const double *zj = &z[(int64_t)n*j];
+                double w = wi ? wi[j] : 0.;
+                bool first = (w != 0.) && dpair_first(wi, j);
+                for (i=ii; i<imax; i++) {
+                    if (w == 0.)
+                        out[rs*i+cs*j] = CMPLX(zj[i], 0.);
+                    else if (first)
+                        out[rs*i+cs*j] = CMPLX(zj[i], s*zj[n+i]);
+                    else
+                        out[rs*i+cs*j] = CMPLX(zj[i-n], -s*zj[i]);
+                }
+            }
+        }
+    }
+}
+
+// Single precision version of "eigs_zvecs" ("z" must not be "out" for
+// row-major output)
+void eigs_cvecs(int32_t n,
+                int32_t k,
+                const float complex *z,
+                float complex *out,
+                bool colmajor,
+                bool conjugate) {
+
+    int64_t p, size = (int64_t)n*k;
+    int32_t ii, jj, i, j, imax, jmax;
+
+    if (colmajor) {
+        if (conjugate)
+            for (p=0; p<size; p++) out[p] = conjf(z[p]);
+        else if (z != out)
+            memcpy(out, z, size*sizeof(float complex));
+        return;
+    }
+
+    for (ii=0; ii<n; ii+=TILE) {
+        imax = (ii+TILE < n) ? ii+TILE : n;
+        for (jj=0; jj<k; jj+=TILE) {
+            jmax = (jj+TILE < k) ? jj+TILE : k;
+            for (i=ii; i<imax; i++) {
+                for (j=jj; j<jmax; j++) {
+                    if (conjugate)
+                        out[(int64_t)k*i+j] = conjf(z[(int64_t)n*j+i]);
+                    else
+                        out[(int64_t)k*i+j] = z[(int64_t)n*j+i];
+                }
+            }
+        }
+    }
+}
+
+// Single precision version of "eigs_dvecs"
+void eigs_svecs(int32_t n,
+                int32_t k,
+                const float *z,
+                const float *wi,
+                float complex *out,
+                bool colmajor,
+                bool conjugate) {
+
+    int64_t p, size = (int64_t)n*k, rs, cs;
+    int32_t ii, jj, i, j, imax, jmax;
+    float s = conjugate ? -1.f : 1.f;
+
+    // Ascending order reads each element before it is overwritten
+    if (colmajor && !wi) {
+        for (p=0; p<size; p++) out[p] = CMPLXF(z[p], 0.f);
+        return;
+    }
+
+    rs = colmajor ? 1 : k;
+    cs = colmajor ? n : 1;
+    for (ii=0; ii<n; ii+=TILE) {
+        imax = (ii+TILE < n) ? ii+TILE : n;
+        for (jj=0; jj<k; jj+=TILE) {
+            jmax = (jj+TILE < k) ? jj+TILE : k;
+            for (j=jj; j<jmax; j++) {
+                const float *zj = &z[(int64_t)n*j];
+                float w = wi ? wi[j] : 0.f;
+                bool first = (w != 0.f) && spair_first(wi, j);
+                for (i=ii; i<imax; i++) {
+                    if (w == 0.f)
+                        out[rs*i+cs*j] = CMPLXF(zj[i], 0.f);
+                    else if (first)
+                        out[rs*i+cs*j] = CMPLXF(zj[i], s*zj[n+i]);
+                    else
+                        out[rs*i+cs*j] = CMPLXF(zj[i-n], -s*zj[i]);
+                }
+            }
+        }
+    }
+}
+
+// Column j is the first member of a complex conjugate pair (wi[j] != 0)
+static bool dpair_first(const double *wi, int32_t j) {
+    int32_t l = j;
+    while ((l > 0) && (wi[l-1] != 0.)) l--;
+    return (j-l)%2 == 0;
+}
+
+// Single precision version of "dpair_first"
+static bool spair_first(const float *wi, int32_t j) {
+    int32_t l = j;
+    while ((l > 0) && (wi[l-1] != 0.f)) l--;
+    return (j-l)%2 == 0;
+}
+
+// Transpose a square matrix in place (tile by tile)
+static void transpose_inplace(int32_t n, double complex *a, bool conjugate) {
+
+    int32_t ii, jj, i, j, imax, jmax;
+    double complex t;
+
+    for (ii=0; ii<n; ii+=TILE) {
+        imax = (ii+TILE < n) ? ii+TILE : n;
+        for (jj=ii; jj<n; jj+=TILE) {
+            jmax = (jj+TILE < n) ? jj+TILE : n;
+            for (i=ii; i<imax; i++) {
+                for (j=(jj == ii) ? i+1 : jj; j<jmax; j++) {
+                    t = a[(int64_t)n*i+j];
+                    a[(int64_t)n*i+j] = a[(int64_t)n*j+i];
+                    a[(int64_t)n*j+i] = t;
+                }
+            }
+        }
+    }
+    if (conjugate)
+        for (int64_t p=0; p<(int64_t)n*n; p++) a[p] = conj(a[p]);
+}
@@ -0,0 +1,546 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Mixed precision: Arnoldi in single precision, refinement of the Ritz pairs *
+ * in double precision                                                        *
+ *                                                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#include <math.h>
+#include <float.h>
+
+#include "../inc.d/eigs.h"
+
+
+// Maximal number of refinement steps
+#define MAX_STEPS 100
+
+// The refinement stalls if the largest residual of the unconverged wanted
+// pairs does not drop by STALL_FACTOR within STALL_STEPS steps
+#define STALL_STEPS 5
+#define STALL_FACTOR 0.5
+
+// Size of the refined block in units of the number of wanted eigenvalues
+#define GUARD 2
+
+// Least dimension of the Krylov subspace of a stalled refinement in units of
+// the size of the block
+#define RESTART_BLOCKS 3
+
+// Default relative residual of the refined eigenpairs
+#define REFINE_TOL 1e-12
+
+// Columns which lose more than this part of their norm by orthogonalization
+// are dropped, below the second bound their images are computed anew (the
+// linear combinations of the images lose accuracy with the norm)
+#define DROP_TOL 1e-10
+#define REFRESH_TOL 1e-2
+
+
+// Float map counting its applications
+typedef struct {
+    ceigs_phi *cphi;
+    seigs_phi *sphi;
+    void *phi_data;
+    int64_t count;
+} counted_map;
+
+// Refinement data (all blocks column-major)
+typedef struct {
+    zeigs_phi *zphi;       // Map in double precision, a real map is applied
+    deigs_phi *dphi;       // to real and imaginary part
+    void *phi_data;
+    int64_t count;
+    int32_t n;
+    int32_t k;
+    bool hermitian;
+    const char *which;
+    double *split;         // Parts of a complex vector for a real map
+    double complex *s;     // Basis [X, P, R] and its image (n x 3k, k the
+    double complex *as;    // size of the block)
+    double complex *x;     // Ritz vectors, search directions and images
+    double complex *ax;
+    double complex *p;
+    double complex *ap;
+    double complex *h;     // Projected map, its eigenvalues and eigenvectors
+    double complex *w;
+    double complex *y;
+    double complex *ysel;  // Wanted eigenvectors of the projected map
+    int32_t *sel;          // Order of its eigenvalues, real eigenvalues of
+    double *ev;            // the hermitian case
+    double complex *theta; // Wanted Ritz values and norms of the residuals
+    double *rnorm;
+    double anorm;          // Estimate of the norm of the map (largest image
+                           // of a basis vector so far)
+    double complex *c;     // Coefficients of the orthogonalization
+} mixed_data;
+
+
+static void count_cphi(void *, int32_t, const float complex *,
+                       float complex *);
+static void count_sphi(void *, int32_t, const float *, float *);
+static void apply(mixed_data *, const double complex *, double complex *);
+static int32_t orthonormalize(mixed_data *, int32_t, int32_t);
+static void rayleigh_ritz(mixed_data *, int32_t, int32_t, bool);
+static int32_t residuals(mixed_data *, double complex *, int32_t, double,
+                         bool *);
+static bool before(const char *, double complex, double complex);
+
+
+// Few eigenvalues of "zg", "dg", "zh" or "ds": the float map of the options
+// runs ARPACK's single precision routines, the Ritz pairs are refined with
+// the double precision map by a block Rayleigh-Ritz method on [X, P, R]
+// (Ritz vectors, search directions and residuals, as LOBPCG); if the
+// refinement stalls, Krylov-Schur in double precision (subspace dimension
+// "ncv", at least three blocks) starts over from the Ritz vectors; returns
+// the number of converged eigenpairs
+int32_t eigs_mixed(const char *solver,
+                   zeigs_phi *zphi,
+                   deigs_phi *dphi,
+                   void *phi_data,
+                   int32_t n,
+                   int32_t k,
+                   const char *which,
+                   int32_t maxiter,
+                   double tol,
+                   bool evs,
+                   int32_t ncv,
+                   const eigs_options *opts,
+                   eigs_result *result) {
+
+    int32_t b = (GUARD*k < n-2) ? GUARD*k : n-2, i, j, m, step;
+    if (b < k) b = k;
+    int64_t nk = (int64_t)n*b;
+    bool complex_values = !strcmp(solver, "zg") || !strcmp(solver, "zh");
+
+    if (strcmp(which, "LM") && strcmp(which, "SM") &&
+        strcmp(which, "LR") && strcmp(which, "SR") &&
+        strcmp(which, "LI") && strcmp(which, "SI") &&
+        strcmp(which, "LA") && strcmp(which, "SA")) {
+        printf("EIGS_MIXED: WHICH = %s NOT SUPPORTED\n", which);
+        exit(1);
+    }
+    if ((complex_values && !opts->cphi) || (!complex_values && !opts->sphi)) {
+        printf("%s\n", "EIGS_MIXED: MISSING FLOAT MAP (CPHI OR SPHI)");
+        exit(1);
+    }
+
+    // Single precision stage for a block of b Ritz pairs, the ones beyond the
+    // wanted k guard them against their neighbours in the spectrum
+    counted_map fmap = {opts->cphi, opts->sphi,
+                        opts->fphi_data ? opts->fphi_data : phi_data, 0};
+    eigs_fresult fresult;
+    fresult.n = n; fresult.k = b;
+    fresult.eigvals = (float complex *)malloc(b*sizeof(float complex));
+    fresult.eigvecs = (float complex *)malloc(nk*sizeof(float complex));
+    if (!strcmp(solver, "zg")) {
+        cgeigsf(n, count_cphi, &fmap, true, which, b, 0.f, maxiter,
+                &fresult);
+    } else
+    if (!strcmp(solver, "zh")) {
+        const char *cwhich = which;
+        if (!strcmp(which, "LA")) cwhich = "LR";
+        if (!strcmp(which, "SA")) cwhich = "SR";
+        cgeigsf(n, count_cphi, &fmap, true, cwhich, b, 0.f, maxiter,
+                &fresult);
+    } else
+    if (!strcmp(solver, "dg")) {
+        sgeigsf(n, count_sphi, &fmap, true, which, b, 0.f, maxiter,
+                &fresult);
+    } else {
+        sseigsf(n, count_sphi, &fmap, true, which, b, 0.f, maxiter,
+                &fresult);
+    }
+
+    // Refinement data
+    mixed_data d;
+    d.zphi = complex_values ? zphi : NULL;
+    d.dphi = complex_values ? NULL : dphi;
+    d.phi_data = phi_data;
+    d.count = 0;
+    d.n = n; d.k = b;
+    d.hermitian = !strcmp(solver, "zh") || !strcmp(solver, "ds");
+    d.which = which;
+    d.split = complex_values ? NULL : (double *)malloc(4*n*sizeof(double));
+    d.s = (double complex *)malloc(3*nk*sizeof(double complex));
+    d.as = (double complex *)malloc(3*nk*sizeof(double complex));
+    d.x = (double complex *)malloc(nk*sizeof(double complex));
+    d.ax = (double complex *)malloc(nk*sizeof(double complex));
+    d.p = (double complex *)malloc(nk*sizeof(double complex));
+    d.ap = (double complex *)malloc(nk*sizeof(double complex));
+    d.h = (double complex *)malloc(9*b*b*sizeof(double complex));
+    d.w = (double complex *)malloc(3*b*sizeof(double complex));
+    d.y = (double complex *)malloc(9*b*b*sizeof(double complex));
+    d.ysel = (double complex *)malloc(3*b*b*sizeof(double complex));
+    d.sel = (int32_t *)malloc(3*b*sizeof(int32_t));
+    d.ev = (double *)malloc(3*b*sizeof(double));
+    d.theta = (double complex *)malloc(b*sizeof(double complex));
+    d.rnorm = (double *)malloc(b*sizeof(double));
+    d.anorm = 0.;
+    d.c = (double complex *)malloc(3*b*sizeof(double complex));
+
+    // Float Ritz vectors (row-major) as first basis
+    for (j=0; j<b; j++)
+        for (i=0; i<n; i++)
+            d.s[(int64_t)n*j+i] = fresult.eigvecs[(int64_t)b*i+j];
+    free(fresult.eigvals); free(fresult.eigvecs);
+    for (j=0; j<b; j++) apply(&d, &d.s[(int64_t)n*j], &d.as[(int64_t)n*j]);
+    m = orthonormalize(&d, 0, b);
+    if (m < b) {
+        printf("%s\n", "EIGS_MIXED: BASIS LOST RANK");
+        exit(1);
+    }
+    rayleigh_ritz(&d, m, m, false);
+
+    // Refine until the residuals of the wanted pairs are small, a converged
+    // block is confirmed with fresh images of the Ritz vectors
+    if (tol <= 0.) tol = REFINE_TOL;
+    bool fresh = false, directions = false, refined = false;
+    bool *done = (bool *)malloc(k*sizeof(bool));
+    int32_t nconv = 0, last = 0;
+    double best = HUGE_VAL;
+    for (step=0; step<MAX_STEPS; step++) {
+
+        int32_t nx, np, nr = 0;
+        double complex *r = &d.s[2*nk];
+        nconv = residuals(&d, r, k, tol, done);
+        bool converged = (nconv == k);
+        if (converged && fresh) {
+            refined = true;
+            break;
+        }
+        if (converged) {
+            for (j=0; j<b; j++)
+                apply(&d, &d.x[(int64_t)n*j], &d.ax[(int64_t)n*j]);
+            fresh = true;
+            continue;
+        }
+        fresh = false;
+
+        // Stagnation (the attainable accuracy of the refinement is limited
+        // by the float Ritz vectors it starts from)
+        double worst = 0.;
+        for (j=0; j<k; j++)
+            if (!done[j] && (d.rnorm[j] > worst)) worst = d.rnorm[j];
+        if (worst < STALL_FACTOR*best) {
+            best = worst;
+            last = step;
+        } else
+        if (step-last >= STALL_STEPS) {
+            break;
+        }
+
+        // Residuals of the unconverged wanted pairs, then Ritz vectors and
+        // search directions in front of them
+        for (j=0; j<k; j++) {
+            if (done[j]) continue;
+            memmove(&d.s[2*nk+(int64_t)n*nr], &r[(int64_t)n*j],
+                    n*sizeof(double complex));
+            apply(&d, &d.s[2*nk+(int64_t)n*nr],
+                  &d.as[2*nk+(int64_t)n*nr]);
+            nr++;
+        }
+        memcpy(d.s, d.x, nk*sizeof(double complex));
+        memcpy(d.as, d.ax, nk*sizeof(double complex));
+        nx = orthonormalize(&d, 0, b);
+        np = 0;
+        if (directions) {
+            memcpy(&d.s[(int64_t)n*nx], d.p, nk*sizeof(double complex));
+            memcpy(&d.as[(int64_t)n*nx], d.ap, nk*sizeof(double complex));
+            np = orthonormalize(&d, nx, b);
+        }
+        memmove(&d.s[(int64_t)n*(nx+np)], &d.s[2*nk],
+                (int64_t)n*nr*sizeof(double complex));
+        memmove(&d.as[(int64_t)n*(nx+np)], &d.as[2*nk],
+                (int64_t)n*nr*sizeof(double complex));
+        m = nx+np+orthonormalize(&d, nx+np, nr);
+        if (m < b) {
+            printf("%s\n", "EIGS_MIXED: BASIS LOST RANK");
+            exit(1);
+        }
+        rayleigh_ritz(&d, m, nx, true);
+        directions = (m > nx);
+    }
+
+    // Result of the refinement
+    result->nmatvec_float = fmap.count;
+    if (refined) {
+        for (j=0; j<k; j++)
+            result->eigvals[j] = d.hermitian ? CMPLX(creal(d.theta[j]), 0.)
+                                             : d.theta[j];
+        if (evs)
+            eigs_zvecs(n, k, d.x, result->eigvecs, opts->colmajor, false);
+    }
+
+    // Stalled refinement: the sum of the Ritz vectors of the block (of their
+    // real and imaginary parts for a real map, which span a conjugate pair)
+    // is close to their invariant subspace and starts a Krylov-Schur solve in
+    // double precision
+    double complex *start = NULL;
+    if (!refined) {
+        start = (double complex *)calloc(n, sizeof(double complex));
+        for (j=0; j<b; j++) {
+            const double complex *x = &d.x[(int64_t)n*j];
+            for (i=0; i<n; i++)
+                start[i] += d.zphi ? x[i] : creal(x[i])+cimag(x[i]);
+        }
+    }
+
+    // Clean up the refinement
+    free(d.split); free(d.s); free(d.as); free(d.x); free(d.ax);
+    free(d.p); free(d.ap); free(d.h); free(d.w); free(d.y); free(d.ysel);
+    free(d.sel); free(d.ev); free(d.theta); free(d.rnorm); free(d.c);
+    free(done);
+
+    if (start) {
+        const char *kwhich = which;
+        if (!strcmp(which, "LA")) kwhich = "LR";
+        if (!strcmp(which, "SA")) kwhich = "SR";
+        if (ncv < RESTART_BLOCKS*b) ncv = RESTART_BLOCKS*b;
+        zgeigsf_ks(n, d.zphi, d.dphi, phi_data, start, evs, kwhich, k, ncv,
+                   opts->nkeep, tol, maxiter, 1, 0., opts->colmajor,
+                   opts->basis_dir, NULL, result);
+        if (d.hermitian)
+            for (j=0; j<k; j++)
+                result->eigvals[j] = CMPLX(creal(result->eigvals[j]), 0.);
+        d.count += result->stats.nmatvec;
+        nconv = result->stats.nconv;
+        free(start);
+    }
+    result->nmatvec_refine = d.count;
+
+    return nconv;
+}
+
+// Bytes allocated by "eigs_mixed": the float solve with its results, then
+// the refinement, then (if it stalls) the Krylov-Schur solve
+size_t eigs_mixed_bytes(const char *solver,
+                        int32_t n,
+                        int32_t k,
+                        int32_t ncv,
+                        const char *basis_dir) {
+
+    int32_t b = (GUARD*k < n-2) ? GUARD*k : n-2;
+    if (b < k) b = k;
+    size_t nk = (size_t)n*b, bb = (size_t)b*b;
+    size_t nz = sizeof(double complex), nd = sizeof(double);
+    bool complex_values = !strcmp(solver, "zg") || !strcmp(solver, "zh");
+
+    size_t fsolve = (b+nk)*sizeof(float complex);
+    if (complex_values) fsolve += cgeigsf_bytes(n, b);
+    else if (!strcmp(solver, "dg")) fsolve += sgeigsf_bytes(n, b);
+    else fsolve += sseigsf_bytes(n, b);
+
+    size_t refine = (10*nk+21*bb+7*(size_t)b)*nz+4*(size_t)b*nd
+                    +3*(size_t)b*sizeof(int32_t);
+    if (!complex_values) refine += 4*(size_t)n*nd;
+
+    if (ncv < RESTART_BLOCKS*b) ncv = RESTART_BLOCKS*b;
+    size_t restart = zgeigsf_ks_bytes(n, k, ncv, basis_dir)+(size_t)n*nz;
+    if (refine > fsolve) fsolve = refine;
+
+    return (fsolve > restart) ? fsolve : restart;
+}
+
+// Float complex map with counter
+static void count_cphi(void *c,
+                       int32_t n,
+                       const float complex *x,
+                       float complex *y) {
+    counted_map *fmap = (counted_map *)c;
+    fmap->cphi(fmap->phi_data, n, x, y);
+    fmap->count++;
+}
+
+// Float map with counter
+static void count_sphi(void *c, int32_t n, const float *x, float *y) {
+    counted_map *fmap = (counted_map *)c;
+    fmap->sphi(fmap->phi_data, n, x, y);
+    fmap->count++;
+}
+
+// y = A x in double precision (real maps act on both parts of x)
+static void apply(mixed_data *d, const double complex *x, double complex *y) {
+
+    int32_t n = d->n, i;
+
+    if (d->zphi) {
+        d->zphi(d->phi_data, n, x, y);
+        d->count++;
+        return;
+    }
+
+    double *xr = d->split, *xi = &d->split[n];
+    double *yr = &d->split[2*n], *yi = &d->split[3*n];
+    bool real_vector = true;
+    for (i=0; i<n; i++) {
+        xr[i] = creal(x[i]); xi[i] = cimag(x[i]);
+        if (xi[i] != 0.) real_vector = false;
+    }
+    d->dphi(d->phi_data, n, xr, yr);
+    d->count++;
+    if (real_vector) {
+        for (i=0; i<n; i++) y[i] = CMPLX(yr[i], 0.);
+        return;
+    }
+    d->dphi(d->phi_data, n, xi, yi);
+    d->count++;
+    for (i=0; i<n; i++) y[i] = CMPLX(yr[i], yi[i]);
+}
+
+// Orthonormalize the columns first,...,first+count-1 of the basis against
+// all columns before them and among each other (classical Gram-Schmidt
+// twice), the images follow the same linear combinations; dropped columns
+// are removed and the number of kept ones is returned
+static int32_t orthonormalize(mixed_data *d, int32_t first, int32_t count) {
+
+    int32_t n = d->n, m = first, j, pass;
+    double complex *c = d->c;
+    const double complex one = 1., mone = -1., zero = 0.;
+
+    for (j=first; j<first+count; j++) {
+        double complex *u = &d->s[(int64_t)n*j], *au = &d->as[(int64_t)n*j];
+        double norm0 = cblas_dznrm2(n, u, 1), norm;
+        if (norm0 == 0.) continue;
+        for (pass=0; pass<2 && m; pass++) {
+            cblas_zgemv(CblasColMajor, CblasConjTrans, n, m, &one, d->s, n,
+                        u, 1, &zero, c, 1);
+            cblas_zgemv(CblasColMajor, CblasNoTrans, n, m, &mone, d->s, n,
+                        c, 1, &one, u, 1);
+            cblas_zgemv(CblasColMajor, CblasNoTrans, n, m, &mone, d->as, n,
+                        c, 1, &one, au, 1);
+        }
+        norm = cblas_dznrm2(n, u, 1);
+        if (norm <= DROP_TOL*norm0) continue;
+        const double complex inv = 1./norm;
+        cblas_zscal(n, &inv, u, 1);
+        cblas_zscal(n, &inv, au, 1);
+        if (norm < REFRESH_TOL*norm0) apply(d, u, au);
+        if (j != m) {
+            memcpy(&d->s[(int64_t)n*m], u, n*sizeof(double complex));
+            memcpy(&d->as[(int64_t)n*m], au, n*sizeof(double complex));
+        }
+        m++;
+    }
+
+    return m-first;
+}
+
+// Project the map onto the m basis vectors and keep the k wanted Ritz pairs
+// in "x", "ax" and "theta"; the parts of the new Ritz vectors beyond the
+// first "nx" basis vectors become the search directions
+static void rayleigh_ritz(mixed_data *d, int32_t m, int32_t nx,
+                          bool directions) {
+
+    int32_t n = d->n, k = d->k, i, j, l;
+    int32_t *sel = d->sel;
+    double complex *h = d->h, *w = d->w, *y = d->y, *ysel = d->ysel;
+    const double complex one = 1., zero = 0.;
+    lapack_int info;
+
+    cblas_zgemm(CblasColMajor, CblasConjTrans, CblasNoTrans, m, m, n, &one,
+                d->s, n, d->as, n, &zero, h, m);
+    for (j=0; j<m; j++) {
+        double norm = cblas_dznrm2(n, &d->as[(int64_t)n*j], 1);
+        if (norm > d->anorm) d->anorm = norm;
+    }
+
+    if (d->hermitian) {
+        double *ev = d->ev;
+        for (j=0; j<m; j++)
+            for (i=0; i<=j; i++)
+                h[m*j+i] = 0.5*(h[m*j+i]+conj(h[m*i+j]));
+        info = LAPACKE_zheev(LAPACK_COL_MAJOR, 'V', 'U', m, h, m, ev);
+        memcpy(y, h, (int64_t)m*m*sizeof(double complex));
+        for (j=0; j<m; j++) w[j] = CMPLX(ev[j], 0.);
+    } else {
+        info = LAPACKE_zgeev(LAPACK_COL_MAJOR, 'N', 'V', m, h, m, w, NULL, 1,
+                             y, m);
+    }
+    if (info) {
+        printf("EIGS_MIXED: RAYLEIGH-RITZ FAILED: INFO = %d\n", info);
+        exit(1);
+    }
+
+    // Wanted Ritz values first
+    for (j=0; j<m; j++) sel[j] = j;
+    for (j=0; j<k; j++) {
+        for (l=j+1; l<m; l++) {
+            if (before(d->which, w[sel[l]], w[sel[j]])) {
+                i = sel[j]; sel[j] = sel[l]; sel[l] = i;
+            }
+        }
+        d->theta[j] = w[sel[j]];
+        memcpy(&ysel[(int64_t)m*j], &y[(int64_t)m*sel[j]],
+               m*sizeof(double complex));
+    }
+
+    // X = S Y, P = S(:, nx:) Y(nx:, :) and their images
+    cblas_zgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, k, m, &one,
+                d->s, n, ysel, m, &zero, d->x, n);
+    cblas_zgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, k, m, &one,
+                d->as, n, ysel, m, &zero, d->ax, n);
+    if (directions && (m > nx)) {
+        cblas_zgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, k, m-nx,
+                    &one, &d->s[(int64_t)n*nx], n, &ysel[nx], m, &zero, d->p,
+                    n);
+        cblas_zgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, k, m-nx,
+                    &one, &d->as[(int64_t)n*nx], n, &ysel[nx], m, &zero,
+                    d->ap, n);
+    }
+}
+
+// Residuals r_j = A x_j - theta_j x_j (x_j of unit norm) and their norms;
+// wanted pair j < k is converged if |r_j| <= max(tol |theta_j|, eps^2/3 |A|)
+// (as ARPACK, the relative residual of a small eigenvalue is limited by the
+// norm of the map), returns the number of converged wanted pairs
+static int32_t residuals(mixed_data *d,
+                         double complex *r,
+                         int32_t k,
+                         double tol,
+                         bool *done) {
+
+    int32_t n = d->n, nconv = 0, i, j;
+    double floor = pow(DBL_EPSILON, 2./3.)*d->anorm;
+
+    for (j=0; j<d->k; j++) {
+        const double complex *x = &d->x[(int64_t)n*j];
+        const double complex *ax = &d->ax[(int64_t)n*j];
+        double complex *rj = &r[(int64_t)n*j];
+        for (i=0; i<n; i++) rj[i] = ax[i]-d->theta[j]*x[i];
+        d->rnorm[j] = cblas_dznrm2(n, rj, 1);
+    }
+    for (j=0; j<k; j++) {
+        double bound = tol*cabs(d->theta[j]);
+        done[j] = (d->rnorm[j] <= ((bound > floor) ? bound : floor));
+        if (done[j]) nconv++;
+    }
+
+    return nconv;
+}
+
+// Order of the Ritz values given by "which"
+static bool before(const char *which, double complex a, double complex b) {
+    if (!strcmp(which, "LM")) return cabs(a) > cabs(b);
+    if (!strcmp(which, "SM")) return cabs(a) < cabs(b);
+    if (!strcmp(which, "LR") || !strcmp(which, "LA"))
+        return creal(a) > creal(b);
+    if (!strcmp(which, "SR") || !strcmp(which, "SA"))
+        return creal(a) < creal(b);
+    if (!strcmp(which, "LI")) return cimag(a) > cimag(b);
+    return cimag(a) < cimag(b);
+}
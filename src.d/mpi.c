@@ -0,0 +1,125 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Distributed-memory eigensolver: Krylov-Schur on vectors distributed by     *
+ * rows over the processes of an MPI communicator                             *
+ *                                                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#include "../inc.d/eigs_mpi.h"
+
+
+static void reduce(void *, double complex *, a_int);
+
+
+// Eigensolver on the processes of "comm": every process passes the number of
+// its rows "nloc" and a map acting on its slices of the vectors (exchanging
+// the halo itself), all other arguments are the same on all processes; the
+// result holds all eigenvalues and the local slices of the eigenvectors
+eigs_result *eigs_mpi(MPI_Comm comm,
+                      const char *solver,
+                      zeigs_phi *zphi,
+                      deigs_phi *dphi,
+                      void *phi_data,
+                      int32_t nloc,
+                      int32_t k,
+                      const char *which,
+                      int32_t maxiter,
+                      double tol,
+                      bool evs,
+                      const eigs_options *opts) {
+
+    double start = eigs_clock();
+    eigs_options defaults;
+    if (!opts) { eigs_options_init(&defaults); opts = &defaults; }
+
+    // Only the Krylov-Schur engine runs distributed
+    bool hermitian = !strcmp(solver, "zh") || !strcmp(solver, "ds");
+    if (strcmp(solver, "zg") && strcmp(solver, "dg") && !hermitian) {
+        printf("EIGS_MPI: Solver *%s* not implemented\n", solver);
+        exit(1);
+    }
+    if (opts->shift_invert || (opts->chebyshev > 0) || (opts->range != 'A')
+        || opts->cphi || opts->sphi || (opts->block > 1)) {
+        printf("%s\n", "EIGS_MPI: OPTION NOT SUPPORTED IN DISTRIBUTED MODE");
+        exit(1);
+    }
+    bool real = !strcmp(solver, "dg") || !strcmp(solver, "ds");
+    if ((real && !dphi) || (!real && !zphi)) {
+        printf("EIGS_MPI: Solver *%s* needs a map\n", solver);
+        exit(1);
+    }
+
+    // Dimension of the problem
+    int64_t rows = nloc, n;
+    MPI_Allreduce(&rows, &n, 1, MPI_INT64_T, MPI_SUM, comm);
+    if (n > INT32_MAX) {
+        printf("EIGS_MPI: DIMENSION %lld TOO LARGE\n", (long long)n);
+        exit(1);
+    }
+    if ((k < 1) || (k >= n)) {
+        printf("EIGS_MPI: K = %d MUST BE IN [1, %lld)\n", k, (long long)n);
+        exit(1);
+    }
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+
+    // Apply defaults if nessesary, largest/smallest algebraic eigenvalues of
+    // a Hermitian map are those with the largest/smallest real parts
+    if (tol < 0.) tol = 0.;
+    if (maxiter <= 0) maxiter = 10*(int32_t)n;
+    if (hermitian && !strcmp(which, "LA")) which = "LR";
+    if (hermitian && !strcmp(which, "SA")) which = "SR";
+
+    // Result (eigenvectors: local slices)
+    eigs_result *result = (eigs_result *)malloc(sizeof(eigs_result));
+    result->n = nloc; result->k = k;
+    result->eigvals = (double complex *)malloc(k*sizeof(double complex));
+    result->eigvecs = NULL;
+    result->borrowed = false;
+    if (evs && opts->eigvecs) {
+        result->eigvecs = opts->eigvecs; result->borrowed = true;
+    } else
+    if (evs) {
+        result->eigvecs = (double complex *)malloc((size_t)nloc*k
+                                                   *sizeof(double complex));
+    }
+    result->nmatvec_float = 0;
+    result->nmatvec_refine = 0;
+    memset(&result->stats, 0, sizeof(eigs_stats));
+
+    // Krylov-Schur with global projections and norms, the rank selects the
+    // random numbers of the local slice
+    zgeigsf_ks_dist((a_int)n, nloc, reduce, &comm, rank,
+                    real ? NULL : zphi, real ? dphi : NULL, phi_data, evs,
+                    which, k, opts->ncv, opts->nkeep, tol, maxiter, 1,
+                    CMPLX(0., 0.), opts->colmajor, opts->basis_dir, result);
+
+    // Eigenvalues of a Hermitian map are real
+    if (hermitian)
+        for (int32_t i=0; i<k; i++)
+            result->eigvals[i] = CMPLX(creal(result->eigvals[i]), 0.);
+
+    result->stats.time_total = eigs_clock()-start;
+    return result;
+}
+
+// Sum of the local projections over all processes
+static void reduce(void *comm, double complex *x, a_int count) {
+    MPI_Allreduce(MPI_IN_PLACE, x, count, MPI_C_DOUBLE_COMPLEX, MPI_SUM,
+                  *(MPI_Comm *)comm);
+}
@@ -0,0 +1,229 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Work-stealing thread pool for internal usage                               *
+ *                                                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../inc.d/eigs.h"
+
+
+// Range of task indices owned by one participant
+typedef struct _PoolQueue {
+    pthread_mutex_t lock;
+    int32_t lo;
+    int32_t hi;
+} pool_queue;
+
+// The pool (participant 0 is always the calling thread)
+typedef struct _Pool {
+
+    // Threads
+    int32_t size;
+    pthread_t *threads;
+    pool_queue *queues;
+
+    // Job
+    pthread_mutex_t job;
+    eigs_pool_task *task;
+    void *arg;
+
+    // Synchronization
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    uint64_t generation;
+    int32_t busy;
+
+} eigs_pool;
+
+
+static eigs_pool pool;
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+static pthread_key_t pool_key;
+
+static void pool_init(void);
+static void *pool_worker(void *);
+static void pool_work(int32_t);
+static bool pool_next(int32_t, int32_t *);
+static void pool_serial(int32_t, eigs_pool_task *, void *);
+
+
+// Number of participants of a job
+int32_t eigs_pool_size(void) {
+    pthread_once(&pool_once, pool_init);
+    return pool.size;
+}
+
+// Run tasks 0,...,ntasks-1 on the pool and return when all are done
+void eigs_pool_run(int32_t ntasks, eigs_pool_task *task, void *arg) {
+
+    pthread_once(&pool_once, pool_init);
+
+    // Nested jobs and jobs issued while the pool is busy run serially
+    if ((pool.size == 1) || (ntasks < 2) || pthread_getspecific(pool_key)) {
+        pool_serial(ntasks, task, arg); return;
+    }
+    if (pthread_mutex_trylock(&pool.job)) {
+        pool_serial(ntasks, task, arg); return;
+    }
+
+    // Distribute tasks evenly, stealing balances the rest
+    int32_t i;
+    for (i=0; i<pool.size; i++) {
+        pthread_mutex_lock(&pool.queues[i].lock);
+        pool.queues[i].lo = (int32_t)(((int64_t)ntasks*i)/pool.size);
+        pool.queues[i].hi = (int32_t)(((int64_t)ntasks*(i+1))/pool.size);
+        pthread_mutex_unlock(&pool.queues[i].lock);
+    }
+
+    // Wake up workers
+    pthread_mutex_lock(&pool.lock);
+    pool.task = task; pool.arg = arg;
+    pool.busy = pool.size-1;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.start);
+    pthread_mutex_unlock(&pool.lock);
+
+    // Participate
+    pthread_setspecific(pool_key, &pool);
+    pool_work(0);
+    pthread_setspecific(pool_key, NULL);
+
+    // Wait for workers
+    pthread_mutex_lock(&pool.lock);
+    while (pool.busy) pthread_cond_wait(&pool.done, &pool.lock);
+    pool.task = NULL; pool.arg = NULL;
+    pthread_mutex_unlock(&pool.lock);
+
+    pthread_mutex_unlock(&pool.job);
+}
+
+// Start threads (size may be set with the environment variable
+// EIGS_NUM_THREADS, default is the number of online processors)
+static void pool_init(void) {
+
+    long size = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *env = getenv("EIGS_NUM_THREADS");
+    if (env && (atol(env) > 0)) size = atol(env);
+    if (size < 1) size = 1;
+    pool.size = (int32_t)size;
+
+    pthread_key_create(&pool_key, NULL);
+    pthread_mutex_init(&pool.job, NULL);
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.start, NULL);
+    pthread_cond_init(&pool.done, NULL);
+    pool.generation = 0; pool.busy = 0;
+    pool.task = NULL; pool.arg = NULL;
+
+    pool.queues = (pool_queue *)malloc(pool.size*sizeof(pool_queue));
+    pool.threads = (pthread_t *)malloc(pool.size*sizeof(pthread_t));
+    for (int32_t i=0; i<pool.size; i++) {
+        pthread_mutex_init(&pool.queues[i].lock, NULL);
+        pool.queues[i].lo = pool.queues[i].hi = 0;
+    }
+    for (intptr_t i=1; i<pool.size; i++) {
+        if (pthread_create(&pool.threads[i], NULL, pool_worker, (void *)i)) {
+            printf("%s\n", "EIGS: COULD NOT START THREAD POOL"); exit(1);
+        }
+    }
+}
+
+// Main loop of a worker thread
+static void *pool_worker(void *arg) {
+
+    int32_t id = (int32_t)(intptr_t)arg;
+    uint64_t generation = 0;
+    pthread_setspecific(pool_key, &pool);
+
+    for (;;) {
+        pthread_mutex_lock(&pool.lock);
+        while (pool.generation == generation)
+            pthread_cond_wait(&pool.start, &pool.lock);
+        generation = pool.generation;
+        pthread_mutex_unlock(&pool.lock);
+
+        pool_work(id);
+
+        pthread_mutex_lock(&pool.lock);
+        if (!--pool.busy) pthread_cond_signal(&pool.done);
+        pthread_mutex_unlock(&pool.lock);
+    }
+
+    return NULL;
+}
+
+// Process tasks until no participant has any left
+static void pool_work(int32_t id) {
+    int32_t task;
+    while (pool_next(id, &task)) pool.task(pool.arg, task, id);
+}
+
+// Pop next own task or steal half of the largest remaining range
+static bool pool_next(int32_t id, int32_t *task) {
+
+    pool_queue *own = &pool.queues[id];
+
+    pthread_mutex_lock(&own->lock);
+    if (own->lo < own->hi) {
+        *task = own->lo++;
+        pthread_mutex_unlock(&own->lock);
+        return true;
+    }
+    pthread_mutex_unlock(&own->lock);
+
+    int32_t i, victim, rest, best;
+    for (;;) {
+
+        // Find victim
+        victim = -1; best = 0;
+        for (i=0; i<pool.size; i++) {
+            if (i == id) continue;
+            pthread_mutex_lock(&pool.queues[i].lock);
+            rest = pool.queues[i].hi-pool.queues[i].lo;
+            pthread_mutex_unlock(&pool.queues[i].lock);
+            if (rest > best) { best = rest; victim = i; }
+        }
+        if (victim < 0) return false;
+
+        // Steal upper half (retry if someone was faster)
+        int32_t lo, hi;
+        pool_queue *q = &pool.queues[victim];
+        pthread_mutex_lock(&q->lock);
+        rest = q->hi-q->lo;
+        if (rest <= 0) { pthread_mutex_unlock(&q->lock); continue; }
+        hi = q->hi; lo = q->hi = hi-(rest+1)/2;
+        pthread_mutex_unlock(&q->lock);
+
+        *task = lo++;
+        pthread_mutex_lock(&own->lock);
+        own->lo = lo; own->hi = hi;
+        pthread_mutex_unlock(&own->lock);
+        return true;
+    }
+}
+
+// Fallback without threads
+static void pool_serial(int32_t ntasks, eigs_pool_task *task, void *arg) {
+    for (int32_t i=0; i<ntasks; i++) task(arg, i, 0);
+}
@@ -0,0 +1,552 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Block diagonal (symmetry sector) eigenproblems: sectors are solved         *
+ * independently and merged into a single result                              *
+ *                                                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#include "../inc.d/eigs.h"
+
+
+// Sector: basis indices (ascending) and its solution
+typedef struct _Sector {
+    int32_t m;
+    int32_t *index;
+    eigs_result *result;
+} sector;
+
+// Problem split into sectors
+typedef struct _SectorJob {
+    const char *solver;
+    bool real;             // "dg" or "ds"
+    bool hermitian;        // "zh" or "ds"
+    bool dense;            // Dense matrix, all eigenvalues or a range
+    zeigs_phi *zphi;
+    deigs_phi *dphi;
+    const double complex *zphi_matrix;
+    const double *dphi_matrix;
+    void *phi_data;
+    bool sparse;           // The map is an "eigs_sparse" matrix
+    int32_t n;
+    int32_t k;
+    const char *which;
+    int32_t maxiter;
+    double tol;
+    bool evs;
+    eigs_options opts;     // Options of the sectors (column-major)
+    int32_t nsectors;
+    sector *sectors;
+    int32_t *order;        // Sectors by decreasing size (tasks of the pool)
+    int32_t *local;        // Index within its sector of each basis index
+} sector_job;
+
+// Map restricted to a sector: embedded into the full space, applied and
+// gathered (x and y are full vectors, zero outside the sector)
+typedef struct _SectorMap {
+    const sector_job *job;
+    const sector *s;
+    void *x;
+    void *y;
+} sector_map;
+
+// Eigenvalue of a sector
+typedef struct _SectorValue {
+    double complex value;
+    int32_t sector;
+    int32_t j;
+} sector_value;
+
+
+static void sector_task(void *, int32_t, int32_t);
+static eigs_result *solve_dense(const sector_job *, int32_t, void *);
+static eigs_sparse *sub_sparse(const sector_job *, const sector *);
+static void sector_zphi(void *, int32_t, const double complex *,
+                        double complex *);
+static void sector_dphi(void *, int32_t, const double *, double *);
+static eigs_result *merge(sector_job *, const eigs_options *);
+static int compare_index(const void *, const void *);
+static bool larger(const sector *, int32_t, int32_t);
+static double key(const char *, const eigs_options *, double complex);
+static int32_t find(int32_t *, int32_t);
+
+
+// Eigensolver for a matrix which does not couple the sectors: sector s holds
+// the basis indices index[off],...,index[off+sizes[s]-1] (off = sizes[0]+...
+// +sizes[s-1], every index in exactly one sector); all other arguments are
+// those of "eigsx", the result holds the k eigenpairs of the whole matrix
+eigs_result *eigs_sectors(const char *solver,
+                          zeigs_phi *zphi,
+                          deigs_phi *dphi,
+                          const double complex *zphi_matrix,
+                          const double *dphi_matrix,
+                          void *phi_data,
+                          int32_t n,
+                          int32_t k,
+                          const char *which,
+                          int32_t maxiter,
+                          double tol,
+                          bool evs,
+                          const eigs_options *opts,
+                          int32_t nsectors,
+                          const int32_t *sizes,
+                          const int32_t *index) {
+
+    double start = eigs_clock();
+    eigs_options defaults;
+    if (!opts) { eigs_options_init(&defaults); opts = &defaults; }
+
+    sector_job job;
+    int32_t s, i;
+    int64_t off;
+
+    // Check solver and options
+    if (strcmp(solver, "zg") && strcmp(solver, "dg") &&
+        strcmp(solver, "zh") && strcmp(solver, "ds")) {
+        printf("EIGS_SECTORS: Solver *%s* not implemented\n", solver);
+        exit(1);
+    }
+    if (opts->range == 'I') {
+        printf("%s\n", "EIGS_SECTORS: RANGE 'I' NOT SUPPORTED");
+        exit(1);
+    }
+    if (!strcmp(which, "BE")) {
+        printf("%s\n", "EIGS_SECTORS: WHICH = BE NOT SUPPORTED");
+        exit(1);
+    }
+    if (opts->cphi || opts->sphi || opts->zphi_block || opts->dphi_block) {
+        printf("%s\n", "EIGS_SECTORS: MAPS OF THE OPTIONS NOT SUPPORTED");
+        exit(1);
+    }
+    if (opts->storage != 'F') {
+        printf("%s\n", "EIGS_SECTORS: BAND AND PACKED STORAGE NOT SUPPORTED");
+        exit(1);
+    }
+    job.solver = solver;
+    job.real = !strcmp(solver, "dg") || !strcmp(solver, "ds");
+    job.hermitian = !strcmp(solver, "zh") || !strcmp(solver, "ds");
+    job.dense = (k == n) || (opts->range != 'A');
+    if (job.dense && !zphi_matrix && !dphi_matrix) {
+        printf("%s\n", "EIGS_SECTORS: ALL EIGENVALUES NEED A DENSE MATRIX");
+        exit(1);
+    }
+    job.zphi = zphi; job.dphi = dphi;
+    job.zphi_matrix = zphi_matrix; job.dphi_matrix = dphi_matrix;
+    job.phi_data = phi_data;
+    job.sparse = phi_data && (job.real ? (dphi == eigs_sparse_dphi)
+                                       : (zphi == eigs_sparse_zphi));
+    job.n = n; job.k = k; job.which = which;
+    job.maxiter = maxiter; job.tol = tol; job.evs = evs;
+    job.opts = *opts;
+    job.opts.colmajor = true;
+    job.opts.eigvecs = NULL;
+    job.opts.overwrite = true;
+
+    // Sectors (indices sorted, such that the upper triangle of a sparse
+    // matrix in half storage stays the upper triangle of every sector)
+    job.nsectors = nsectors;
+    job.sectors = (sector *)malloc(nsectors*sizeof(sector));
+    job.order = (int32_t *)malloc(nsectors*sizeof(int32_t));
+    job.local = (int32_t *)malloc(n*sizeof(int32_t));
+    for (i=0; i<n; i++) job.local[i] = -1;
+    for (s=0, off=0; s<nsectors; off+=sizes[s], s++) {
+        sector *sc = &job.sectors[s];
+        sc->m = sizes[s];
+        sc->index = (int32_t *)malloc(sc->m*sizeof(int32_t));
+        memcpy(sc->index, &index[off], sc->m*sizeof(int32_t));
+        qsort(sc->index, sc->m, sizeof(int32_t), compare_index);
+        for (i=0; i<sc->m; i++) {
+            if ((sc->index[i] < 0) || (sc->index[i] >= n) ||
+                (job.local[sc->index[i]] >= 0)) {
+                printf("EIGS_SECTORS: INDEX %d OF SECTOR %d INVALID OR "
+                       "REPEATED\n", sc->index[i], s);
+                exit(1);
+            }
+            job.local[sc->index[i]] = i;
+        }
+        sc->result = NULL;
+        job.order[s] = s;
+    }
+    if (off != n) {
+        printf("EIGS_SECTORS: SECTORS COVER %lld OF N = %d INDICES\n",
+               (long long)off, n);
+        exit(1);
+    }
+
+    // Largest sectors first, the pool balances the rest
+    for (s=1; s<nsectors; s++)
+        for (i=s; (i>0) && larger(job.sectors, job.order[i],
+                                  job.order[i-1]); i--) {
+            int32_t t = job.order[i]; job.order[i] = job.order[i-1];
+            job.order[i-1] = t;
+        }
+
+    // Solve sectors in parallel and merge
+    eigs_pool_run(nsectors, sector_task, &job);
+    eigs_result *result = merge(&job, opts);
+
+    // Clean up
+    for (s=0; s<nsectors; s++) {
+        free(job.sectors[s].index);
+        eigs_result_free(job.sectors[s].result);
+    }
+    free(job.sectors); free(job.order); free(job.local);
+
+    result->stats.time_total = eigs_clock()-start;
+    return result;
+}
+
+// Sectors of the connected components of the graph of a sparse matrix "a"
+// (or of a row-major dense matrix, the others are NULL); "sizes" and "index"
+// (length n each) receive the input of "eigs_sectors", returns the number of
+// sectors
+int32_t eigs_sectors_detect(int32_t n,
+                            const eigs_sparse *a,
+                            const double complex *zmatrix,
+                            const double *dmatrix,
+                            int32_t *sizes,
+                            int32_t *index) {
+
+    int32_t *parent = (int32_t *)malloc(n*sizeof(int32_t));
+    int32_t *label = (int32_t *)malloc(n*sizeof(int32_t));
+    int32_t i, j, r1, r2, nsectors = 0;
+    int64_t p;
+
+    // Union-find over the nonzeros (edges in either direction)
+    for (i=0; i<n; i++) parent[i] = i;
+    for (i=0; i<n; i++) {
+        if (a) {
+            for (p=a->ptr[i]; p<a->ptr[i+1]; p++) {
+                r1 = find(parent, i); r2 = find(parent, a->col[p]);
+                if (r1 != r2) parent[(r1 > r2) ? r1 : r2] = (r1 < r2) ? r1
+                                                                       : r2;
+            }
+            continue;
+        }
+        for (j=0; j<n; j++) {
+            if (zmatrix ? (zmatrix[(int64_t)n*i+j] == 0.)
+                        : (dmatrix[(int64_t)n*i+j] == 0.)) continue;
+            r1 = find(parent, i); r2 = find(parent, j);
+            if (r1 != r2) parent[(r1 > r2) ? r1 : r2] = (r1 < r2) ? r1 : r2;
+        }
+    }
+
+    // Components in the order of their smallest index, indices ascending
+    for (i=0; i<n; i++) {
+        r1 = find(parent, i);
+        if (r1 == i) { label[i] = nsectors; sizes[nsectors++] = 0; }
+        label[i] = label[r1];
+        sizes[label[i]]++;
+    }
+    int32_t *next = parent;
+    for (j=0, p=0; j<nsectors; p+=sizes[j], j++) next[j] = (int32_t)p;
+    for (i=0; i<n; i++) index[next[label[i]]++] = i;
+
+    free(parent); free(label);
+    return nsectors;
+}
+
+// Solve a single sector: dense, or iterative with the restricted map (dense
+// as well if the sector is too small for the iterative solvers)
+static void sector_task(void *arg, int32_t task, int32_t worker) {
+
+    sector_job *job = (sector_job *)arg;
+    sector *s = &job->sectors[job->order[task]];
+    int32_t m = s->m, i, j;
+    size_t size = job->real ? sizeof(double) : sizeof(double complex);
+    (void)worker;
+
+    // Block of the dense matrix
+    if (job->dense) {
+        void *a = malloc((size_t)m*m*size);
+        for (i=0; i<m; i++) {
+            for (j=0; j<m; j++) {
+                int64_t ij = (int64_t)job->n*s->index[i]+s->index[j];
+                if (job->real)
+                    ((double *)a)[(size_t)m*i+j] = job->dphi_matrix[ij];
+                else
+                    ((double complex *)a)[(size_t)m*i+j] = job->zphi_matrix[ij];
+            }
+        }
+        s->result = solve_dense(job, m, a);
+        return;
+    }
+
+    // Restricted map: sub-matrix of a sparse matrix or the embedded map
+    sector_map map = { job, s, NULL, NULL };
+    eigs_sparse *sub = NULL;
+    void *data = &map;
+    zeigs_phi *zphi = sector_zphi;
+    deigs_phi *dphi = sector_dphi;
+    if (job->sparse) {
+        sub = sub_sparse(job, s);
+        data = sub;
+        zphi = eigs_sparse_zphi; dphi = eigs_sparse_dphi;
+    } else {
+        map.x = calloc(job->n, size);
+        map.y = calloc(job->n, size);
+    }
+
+    if (m > job->k+1) {
+        s->result = eigsx(job->solver, job->real ? NULL : zphi,
+                          job->real ? dphi : NULL, NULL, NULL, data, m,
+                          job->k, job->which, job->maxiter, job->tol,
+                          job->evs, &job->opts);
+    } else {
+        // Too small for Arnoldi/Lanczos: matrix of the sector column by
+        // column (row-major) and all its eigenvalues
+        void *a = malloc((size_t)m*m*size), *e = calloc(m, size);
+        void *col = malloc(m*size);
+        for (j=0; j<m; j++) {
+            if (job->real) {
+                ((double *)e)[j] = 1.;
+                dphi(data, m, (double *)e, (double *)col);
+                for (i=0; i<m; i++)
+                    ((double *)a)[(size_t)m*i+j] = ((double *)col)[i];
+                ((double *)e)[j] = 0.;
+            } else {
+                ((double complex *)e)[j] = 1.;
+                zphi(data, m, (double complex *)e, (double complex *)col);
+                for (i=0; i<m; i++)
+                    ((double complex *)a)[(size_t)m*i+j] =
+                        ((double complex *)col)[i];
+                ((double complex *)e)[j] = 0.;
+            }
+        }
+        free(e); free(col);
+        s->result = solve_dense(job, m, a);
+    }
+
+    if (sub) eigs_sparse_free(sub);
+    free(map.x); free(map.y);
+}
+
+// Eigenpairs of a row-major m x m sector matrix "a" (all or those of the
+// range), takes "a" over
+static eigs_result *solve_dense(const sector_job *job, int32_t m, void *a) {
+
+    // A range keeps at most k eigenvalues per sector
+    int32_t k = ((job->opts.range != 'A') && (job->k < m)) ? job->k : m;
+    eigs_options opts = job->opts;
+    opts.shift_invert = false;
+    eigs_result *result = eigsx(job->solver, NULL, NULL,
+                                job->real ? NULL : (double complex *)a,
+                                job->real ? (double *)a : NULL, NULL, m, k,
+                                job->which, job->maxiter, job->tol, job->evs,
+                                &opts);
+
+    // Overwritten "zh" matrix holds the eigenvectors
+    if (result->eigvecs == a) result->borrowed = false;
+    else free(a);
+    return result;
+}
+
+// Rows and columns of the sector of a sparse matrix (arrays owned by it)
+static eigs_sparse *sub_sparse(const sector_job *job, const sector *s) {
+
+    const eigs_sparse *a = (const eigs_sparse *)job->phi_data;
+    int32_t m = s->m, i;
+    int64_t p, nnz = 0;
+    size_t size = a->complex_values ? 2*sizeof(double) : sizeof(double);
+
+    for (i=0; i<m; i++) nnz += a->ptr[s->index[i]+1]-a->ptr[s->index[i]];
+    int64_t *ptr = (int64_t *)malloc((m+1)*sizeof(int64_t));
+    int32_t *col = (int32_t *)malloc(nnz*sizeof(int32_t));
+    double *val = (double *)malloc(nnz*size);
+
+    // Sorted indices keep the order of the columns and the upper triangle
+    ptr[0] = 0;
+    for (i=0; i<m; i++) {
+        int32_t r = s->index[i];
+        int64_t len = a->ptr[r+1]-a->ptr[r];
+        for (p=0; p<len; p++)
+            col[ptr[i]+p] = job->local[a->col[a->ptr[r]+p]];
+        memcpy((char *)val+ptr[i]*size, (char *)a->val+a->ptr[r]*size,
+               len*size);
+        ptr[i+1] = ptr[i]+len;
+    }
+
+    eigs_sparse *sub = eigs_sparse_init("csr", a->half, m, ptr, col,
+                                        a->complex_values
+                                            ? (double complex *)val : NULL,
+                                        a->complex_values ? NULL : val);
+    sub->own = true;
+    return sub;
+}
+
+// Complex map restricted to a sector
+static void sector_zphi(void *data,
+                        int32_t m,
+                        const double complex *x,
+                        double complex *y) {
+
+    sector_map *map = (sector_map *)data;
+    const int32_t *index = map->s->index;
+    double complex *xf = (double complex *)map->x;
+    double complex *yf = (double complex *)map->y;
+    int32_t i;
+
+    for (i=0; i<m; i++) xf[index[i]] = x[i];
+    map->job->zphi(map->job->phi_data, map->job->n, xf, yf);
+    for (i=0; i<m; i++) y[i] = yf[index[i]];
+}
+
+// Real map restricted to a sector
+static void sector_dphi(void *data, int32_t m, const double *x, double *y) {
+
+    sector_map *map = (sector_map *)data;
+    const int32_t *index = map->s->index;
+    double *xf = (double *)map->x, *yf = (double *)map->y;
+    int32_t i;
+
+    for (i=0; i<m; i++) xf[index[i]] = x[i];
+    map->job->dphi(map->job->phi_data, map->job->n, xf, yf);
+    for (i=0; i<m; i++) y[i] = yf[index[i]];
+}
+
+// Eigenpairs of all sectors: the k wanted ones of a few, all of a dense
+// problem (Hermitian: ascending) or those of the range
+static eigs_result *merge(sector_job *job, const eigs_options *opts) {
+
+    int32_t n = job->n, k = job->k, total = 0, s, i, j;
+    for (s=0; s<job->nsectors; s++) total += job->sectors[s].result->k;
+
+    // Candidates in sector order
+    sector_value *v = (sector_value *)malloc(total*sizeof(sector_value));
+    for (s=0, i=0; s<job->nsectors; s++)
+        for (j=0; j<job->sectors[s].result->k; j++, i++) {
+            v[i].value = job->sectors[s].result->eigvals[j];
+            v[i].sector = s; v[i].j = j;
+        }
+
+    // Wanted eigenvalues first (stable insertion sort, the sectors sorted
+    // them already), or ascending eigenvalues of a dense Hermitian problem
+    int32_t kk = total;
+    if (!job->dense || job->hermitian) {
+        for (i=1; i<total; i++) {
+            sector_value t = v[i];
+            double kt = job->dense ? -creal(t.value)
+                                   : key(job->which, opts, t.value);
+            for (j=i; j>0; j--) {
+                double kj = job->dense ? -creal(v[j-1].value)
+                                       : key(job->which, opts, v[j-1].value);
+                if (kj >= kt) break;
+                v[j] = v[j-1];
+            }
+            v[j] = t;
+        }
+    }
+    if (!job->dense) {
+        if (total < k) {
+            printf("EIGS_SECTORS: ONLY %d EIGENVALUES FOUND\n", total);
+            exit(1);
+        }
+        kk = k;
+    } else
+    if (total > k) {
+        printf("EIGS_SECTORS: %d > K = %d EIGENVALUES IN RANGE\n", total, k);
+        exit(1);
+    }
+
+    // Result
+    eigs_result *result = (eigs_result *)malloc(sizeof(eigs_result));
+    result->n = n; result->k = kk;
+    result->eigvals = (double complex *)malloc(k*sizeof(double complex));
+    result->eigvecs = NULL;
+    result->borrowed = false;
+    if (job->evs && opts->eigvecs) {
+        result->eigvecs = opts->eigvecs; result->borrowed = true;
+    } else
+    if (job->evs) {
+        result->eigvecs = (double complex *)malloc((size_t)n*k
+                                                   *sizeof(double complex));
+    }
+    result->nmatvec_float = 0;
+    result->nmatvec_refine = 0;
+    memset(&result->stats, 0, sizeof(eigs_stats));
+
+    // Eigenvalues and eigenvectors (zero outside of their sector)
+    if (job->evs)
+        memset(result->eigvecs, 0, (size_t)n*kk*sizeof(double complex));
+    for (j=0; j<kk; j++) {
+        const sector *sc = &job->sectors[v[j].sector];
+        result->eigvals[j] = v[j].value;
+        if (!job->evs) continue;
+        const double complex *x = sc->result->eigvecs
+                                  +(size_t)sc->m*v[j].j;
+        for (i=0; i<sc->m; i++) {
+            if (opts->colmajor)
+                result->eigvecs[(size_t)n*j+sc->index[i]] = x[i];
+            else
+                result->eigvecs[(size_t)kk*sc->index[i]+j] = x[i];
+        }
+    }
+
+    // Statistics summed over the sectors
+    for (s=0; s<job->nsectors; s++) {
+        const eigs_stats *st = &job->sectors[s].result->stats;
+        result->stats.nmatvec += st->nmatvec;
+        result->stats.nrestart += st->nrestart;
+        result->stats.nreorth += st->nreorth;
+        result->stats.time_phi += st->time_phi;
+        result->stats.time_orth += st->time_orth;
+        result->stats.time_restart += st->time_restart;
+        result->stats.time_extract += st->time_extract;
+        result->nmatvec_float += job->sectors[s].result->nmatvec_float;
+        result->nmatvec_refine += job->sectors[s].result->nmatvec_refine;
+    }
+    result->stats.nconv = kk;
+
+    free(v);
+    return result;
+}
+
+// Ascending basis indices
+static int compare_index(const void *a, const void *b) {
+    int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+    return (x > y)-(x < y);
+}
+
+// Sector s is larger than sector t
+static bool larger(const sector *sectors, int32_t s, int32_t t) {
+    return sectors[s].m > sectors[t].m;
+}
+
+// Larger is wanted first (shift-invert: of the eigenvalues of the inverse)
+static double key(const char *which,
+                  const eigs_options *opts,
+                  double complex lambda) {
+
+    double complex v = opts->shift_invert ? 1./(lambda-opts->sigma) : lambda;
+    if (!strcmp(which, "LM")) return cabs(v);
+    if (!strcmp(which, "SM")) return -cabs(v);
+    if (!strcmp(which, "LR") || !strcmp(which, "LA")) return creal(v);
+    if (!strcmp(which, "SR") || !strcmp(which, "SA")) return -creal(v);
+    if (!strcmp(which, "LI")) return cimag(v);
+    if (!strcmp(which, "SI")) return -cimag(v);
+    printf("EIGS_SECTORS: WHICH = %s NOT SUPPORTED\n", which);
+    exit(1);
+}
+
+// Root of the component of i (path halving)
+static int32_t find(int32_t *parent, int32_t i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
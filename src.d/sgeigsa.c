@@ -0,0 +1,68 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LAPACK based solver for all float eigenvalues/-vectors of a general        *
+ * matrix                                                                     *
+ *                                                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#include "../inc.d/eigs.h"
+
+
+// Eigenvalues and eigenvectors (the row-major input read as column-major is
+// the transposed matrix, whose left eigenvectors are the complex conjugated
+// right eigenvectors of the matrix)
+void sgeigsa(uint32_t n,
+             const float *phi,
+             bool evs,
+             eigs_fresult *result) {
+
+    // Copy input, LAPACK overwrites it
+    float *a = (float *)malloc((size_t)n*n*sizeof(float));
+    memcpy(a, phi, (size_t)n*n*sizeof(float));
+
+    // Solve eigenproblem using LAPACK
+    uint32_t i;
+    float *wr, *wi, *vl = NULL;
+    wr = (float *)malloc(n*sizeof(float));
+    wi = (float *)malloc(n*sizeof(float));
+    if (evs) vl = (float *)malloc((size_t)n*n*sizeof(float));
+    lapack_int info = LAPACKE_sgeev(LAPACK_COL_MAJOR,
+                                    evs ? 'V' : 'N',
+                                    'N',
+                                    n,
+                                    a,
+                                    n,
+                                    wr,
+                                    wi,
+                                    vl,
+                                    evs ? n : 1,
+                                    NULL,
+                                    1);
+
+    // Check result
+    if (info) {
+        printf("%s\n", "EIGS: LAPACKE_sgeev did not converge"); exit(1);
+    }
+
+    // Extract eigenvalues and (possibly) eigenvectors
+    for (i=0; i<n; i++) result->eigvals[i] = CMPLXF(wr[i], wi[i]);
+    if (evs) eigs_svecs(n, n, vl, wi, result->eigvecs, false, true);
+
+    // Clean up
+    free(a); free(wr); free(wi); free(vl);
+}
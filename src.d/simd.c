@@ -0,0 +1,489 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Vectorized level-1 and sparse row kernels (AVX-512, AVX2 or plain C,       *
+ * chosen at runtime)                                                         *
+ *                                                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#include <math.h>
+#include <float.h>
+
+#include "../inc.d/eigs.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define SIMD_X86
+#include <immintrin.h>
+#endif
+
+
+// Kernels of the CPU
+typedef struct _SimdKernels {
+    const char *name;
+    double (*dot)(int64_t, const double *, const double *);
+    double (*sumsq)(int64_t, const double *);
+    void (*axpy)(int64_t, double, const double *, double *);
+    void (*scale)(int64_t, double, const double *, double *);
+    void (*dotc)(int64_t, const double *, const double *, double *);
+    void (*dcsr)(int32_t, const int64_t *, const int32_t *, const double *,
+                 const double *, double *);
+    void (*zcsr)(int32_t, const int64_t *, const int32_t *, const double *,
+                 const double *, double *);
+} simd_kernels;
+
+
+static void simd_init(void);
+static double dot_c(int64_t, const double *, const double *);
+static double sumsq_c(int64_t, const double *);
+static void axpy_c(int64_t, double, const double *, double *);
+static void scale_c(int64_t, double, const double *, double *);
+static void dotc_c(int64_t, const double *, const double *, double *);
+static void dcsr_c(int32_t, const int64_t *, const int32_t *, const double *,
+                   const double *, double *);
+static void zcsr_c(int32_t, const int64_t *, const int32_t *, const double *,
+                   const double *, double *);
+#ifdef SIMD_X86
+static double dot_avx2(int64_t, const double *, const double *);
+static double sumsq_avx2(int64_t, const double *);
+static void axpy_avx2(int64_t, double, const double *, double *);
+static void scale_avx2(int64_t, double, const double *, double *);
+static void dotc_avx2(int64_t, const double *, const double *, double *);
+static void dcsr_avx2(int32_t, const int64_t *, const int32_t *,
+                      const double *, const double *, double *);
+static void zcsr_avx2(int32_t, const int64_t *, const int32_t *,
+                      const double *, const double *, double *);
+static double dot_avx512(int64_t, const double *, const double *);
+static double sumsq_avx512(int64_t, const double *);
+static void axpy_avx512(int64_t, double, const double *, double *);
+static void scale_avx512(int64_t, double, const double *, double *);
+static void dotc_avx512(int64_t, const double *, const double *, double *);
+#endif
+
+
+static pthread_once_t simd_once = PTHREAD_ONCE_INIT;
+static simd_kernels simd;
+
+
+// x^T y
+double eigs_ddot(int64_t n, const double *x, const double *y) {
+    pthread_once(&simd_once, simd_init);
+    return simd.dot(n, x, y);
+}
+
+// y = y + a x
+void eigs_daxpy(int64_t n, double a, const double *x, double *y) {
+    pthread_once(&simd_once, simd_init);
+    simd.axpy(n, a, x, y);
+}
+
+// Norm of x and, if it exceeds "tiny", y = x/|x| (y may be x); one pass for
+// the norm and one for the scaled copy instead of nrm2, copy and scal
+double eigs_dnrm2_scale(int64_t n, const double *x, double *y, double tiny) {
+    pthread_once(&simd_once, simd_init);
+
+    // The plain sum of squares is exact enough unless it under- or
+    // overflows, then the scaled sum of BLAS takes over
+    double s = simd.sumsq(n, x), nrm;
+    if ((s > DBL_MIN/DBL_EPSILON) && (s < DBL_MAX)) {
+        nrm = sqrt(s);
+    } else {
+        nrm = 0.;
+        for (int64_t i=0; i<n; i+=INT32_MAX)
+            nrm = hypot(nrm, cblas_dnrm2((n-i < INT32_MAX) ? n-i : INT32_MAX,
+                                         &x[i], 1));
+    }
+    if (y && (nrm > tiny)) simd.scale(n, 1./nrm, x, y);
+    return nrm;
+}
+
+// x^H y
+double complex eigs_zdotc(int64_t n,
+                          const double complex *x,
+                          const double complex *y) {
+    pthread_once(&simd_once, simd_init);
+    double s[2];
+    simd.dotc(n, (const double *)x, (const double *)y, s);
+    return CMPLX(s[0], s[1]);
+}
+
+// Norm of the complex x and, if it exceeds "tiny", y = x/|x|
+double eigs_znrm2_scale(int64_t n,
+                        const double complex *x,
+                        double complex *y,
+                        double tiny) {
+    return eigs_dnrm2_scale(2*n, (const double *)x, (double *)y, tiny);
+}
+
+// y_i = sum_k val_k x_{col_k} over k = ptr[i],...,ptr[i+1]-1 for the rows
+// i = 0,...,m-1 of a CSR matrix (ptr of the first row, indices absolute)
+void eigs_dcsr_rows(int32_t m,
+                    const int64_t *ptr,
+                    const int32_t *col,
+                    const double *val,
+                    const double *x,
+                    double *y) {
+    pthread_once(&simd_once, simd_init);
+    simd.dcsr(m, ptr, col, val, x, y);
+}
+
+// Rows of a double complex CSR matrix, values and vectors as pairs of doubles
+void eigs_zcsr_rows(int32_t m,
+                    const int64_t *ptr,
+                    const int32_t *col,
+                    const double *val,
+                    const double *x,
+                    double *y) {
+    pthread_once(&simd_once, simd_init);
+    simd.zcsr(m, ptr, col, val, x, y);
+}
+
+// Kernels for the Arnoldi loops of ARPACK's double precision routines
+// (Fortran calling convention: arguments by reference, unit strides), which
+// call them instead of the linked BLAS
+
+// x^T y (DDOT)
+double eigs_fddot_(const a_int *n, const double *x, const double *y) {
+    return eigs_ddot(*n, x, y);
+}
+
+// |x| (DNRM2)
+double eigs_fdnrm2_(const a_int *n, const double *x) {
+    return eigs_dnrm2_scale(*n, x, NULL, 0.);
+}
+
+// y = y + a x (DAXPY)
+void eigs_fdaxpy_(const a_int *n, const double *a, const double *x,
+                  double *y) {
+    eigs_daxpy(*n, *a, x, y);
+}
+
+// x = a x (DSCAL)
+void eigs_fdscal_(const a_int *n, const double *a, double *x) {
+    pthread_once(&simd_once, simd_init);
+    simd.scale(*n, *a, x, x);
+}
+
+// x^H y (ZDOTC)
+double complex eigs_fzdotc_(const a_int *n,
+                            const double complex *x,
+                            const double complex *y) {
+    return eigs_zdotc(*n, x, y);
+}
+
+// |x| of a complex x (DZNRM2)
+double eigs_fdznrm2_(const a_int *n, const double complex *x) {
+    return eigs_znrm2_scale(*n, x, NULL, 0.);
+}
+
+// Instruction set of the kernels ("avx512", "avx2" or "c")
+const char *eigs_simd(void) {
+    pthread_once(&simd_once, simd_init);
+    return simd.name;
+}
+
+// Widest instruction set of the CPU (and the operating system)
+static void simd_init(void) {
+
+    simd = (simd_kernels){"c", dot_c, sumsq_c, axpy_c, scale_c, dotc_c,
+                          dcsr_c, zcsr_c};
+
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        simd = (simd_kernels){"avx512", dot_avx512, sumsq_avx512,
+                              axpy_avx512, scale_avx512, dotc_avx512,
+                              dcsr_avx2, zcsr_avx2};
+    } else
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        simd = (simd_kernels){"avx2", dot_avx2, sumsq_avx2, axpy_avx2,
+                              scale_avx2, dotc_avx2, dcsr_avx2, zcsr_avx2};
+    }
+#endif
+}
+
+
+/* --- Plain C -------------------------------------------------------------- */
+
+static double dot_c(int64_t n, const double *x, const double *y) {
+    double s0 = 0., s1 = 0., s2 = 0., s3 = 0.;
+    int64_t i;
+    for (i=0; i+4<=n; i+=4) {
+        s0 += x[i]*y[i]; s1 += x[i+1]*y[i+1];
+        s2 += x[i+2]*y[i+2]; s3 += x[i+3]*y[i+3];
+    }
+    for (; i<n; i++) s0 += x[i]*y[i];
+    return (s0+s1)+(s2+s3);
+}
+
+static double sumsq_c(int64_t n, const double *x) {
+    return dot_c(n, x, x);
+}
+
+static void axpy_c(int64_t n, double a, const double *x, double *y) {
+    for (int64_t i=0; i<n; i++) y[i] += a*x[i];
+}
+
+static void scale_c(int64_t n, double a, const double *x, double *y) {
+    for (int64_t i=0; i<n; i++) y[i] = a*x[i];
+}
+
+// Real and imaginary part of x^H y of n complex numbers (interleaved)
+static void dotc_c(int64_t n, const double *x, const double *y, double *s) {
+    double re = 0., im = 0.;
+    for (int64_t i=0; i<2*n; i+=2) {
+        re += x[i]*y[i]+x[i+1]*y[i+1];
+        im += x[i]*y[i+1]-x[i+1]*y[i];
+    }
+    s[0] = re; s[1] = im;
+}
+
+static void dcsr_c(int32_t m, const int64_t *ptr, const int32_t *col,
+                   const double *val, const double *x, double *y) {
+    for (int32_t i=0; i<m; i++) {
+        double s0 = 0., s1 = 0.;
+        int64_t k = ptr[i], end = ptr[i+1];
+        for (; k+2<=end; k+=2) {
+            s0 += val[k]*x[col[k]];
+            s1 += val[k+1]*x[col[k+1]];
+        }
+        if (k < end) s0 += val[k]*x[col[k]];
+        y[i] = s0+s1;
+    }
+}
+
+static void zcsr_c(int32_t m, const int64_t *ptr, const int32_t *col,
+                   const double *val, const double *x, double *y) {
+    for (int32_t i=0; i<m; i++) {
+        double re = 0., im = 0.;
+        for (int64_t k=ptr[i]; k<ptr[i+1]; k++) {
+            const double *v = &val[2*k], *xk = &x[2*(int64_t)col[k]];
+            re += v[0]*xk[0]-v[1]*xk[1];
+            im += v[0]*xk[1]+v[1]*xk[0];
+        }
+        y[2*i] = re; y[2*i+1] = im;
+    }
+}
+
+
+#ifdef SIMD_X86
+/* --- AVX2 and FMA (4 doubles per register) -------------------------------- */
+
+__attribute__((target("avx2,fma")))
+static double hsum_avx2(__m256d a) {
+    __m128d s = _mm_add_pd(_mm256_castpd256_pd128(a),
+                           _mm256_extractf128_pd(a, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+
+__attribute__((target("avx2,fma")))
+static double dot_avx2(int64_t n, const double *x, const double *y) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    int64_t i;
+    for (i=0; i+8<=n; i+=8) {
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(&x[i]), _mm256_loadu_pd(&y[i]),
+                             s0);
+        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(&x[i+4]),
+                             _mm256_loadu_pd(&y[i+4]), s1);
+    }
+    double s = hsum_avx2(_mm256_add_pd(s0, s1));
+    for (; i<n; i++) s += x[i]*y[i];
+    return s;
+}
+
+__attribute__((target("avx2,fma")))
+static double sumsq_avx2(int64_t n, const double *x) {
+    return dot_avx2(n, x, x);
+}
+
+__attribute__((target("avx2,fma")))
+static void axpy_avx2(int64_t n, double a, const double *x, double *y) {
+    __m256d va = _mm256_set1_pd(a);
+    int64_t i;
+    for (i=0; i+4<=n; i+=4)
+        _mm256_storeu_pd(&y[i], _mm256_fmadd_pd(va, _mm256_loadu_pd(&x[i]),
+                                                _mm256_loadu_pd(&y[i])));
+    for (; i<n; i++) y[i] += a*x[i];
+}
+
+__attribute__((target("avx2,fma")))
+static void scale_avx2(int64_t n, double a, const double *x, double *y) {
+    __m256d va = _mm256_set1_pd(a);
+    int64_t i;
+    for (i=0; i+4<=n; i+=4)
+        _mm256_storeu_pd(&y[i], _mm256_mul_pd(va, _mm256_loadu_pd(&x[i])));
+    for (; i<n; i++) y[i] = a*x[i];
+}
+
+// Real part: sum of x*y; imaginary part: alternating sum of x*swap(y), where
+// swap exchanges real and imaginary parts
+__attribute__((target("avx2,fma")))
+static void dotc_avx2(int64_t n, const double *x, const double *y,
+                      double *s) {
+    __m256d re = _mm256_setzero_pd(), im = _mm256_setzero_pd();
+    int64_t i, len = 2*n;
+    for (i=0; i+4<=len; i+=4) {
+        __m256d vx = _mm256_loadu_pd(&x[i]), vy = _mm256_loadu_pd(&y[i]);
+        re = _mm256_fmadd_pd(vx, vy, re);
+        im = _mm256_fmadd_pd(vx, _mm256_permute_pd(vy, 0x5), im);
+    }
+    double t[4];
+    _mm256_storeu_pd(t, im);
+    s[0] = hsum_avx2(re);
+    s[1] = (t[0]-t[1])+(t[2]-t[3]);
+    for (; i<len; i+=2) {
+        s[0] += x[i]*y[i]+x[i+1]*y[i+1];
+        s[1] += x[i]*y[i+1]-x[i+1]*y[i];
+    }
+}
+
+// Four entries of a row per gather, the rest (and rows shorter than a
+// register) in plain C; the CPUs with AVX-512 use these sparse kernels as
+// well, their 512 bit and masked gathers are slower for the short rows of
+// typical sparse matrices
+__attribute__((target("avx2,fma")))
+static void dcsr_avx2(int32_t m, const int64_t *ptr, const int32_t *col,
+                      const double *val, const double *x, double *y) {
+    for (int32_t i=0; i<m; i++) {
+        int64_t k = ptr[i], end = ptr[i+1];
+        double s = 0.;
+        if (end-k >= 4) {
+            __m256d acc = _mm256_setzero_pd();
+            for (; k+4<=end; k+=4) {
+                __m128i idx = _mm_loadu_si128((const __m128i *)&col[k]);
+                acc = _mm256_fmadd_pd(_mm256_loadu_pd(&val[k]),
+                                      _mm256_i32gather_pd(x, idx, 8), acc);
+            }
+            s = hsum_avx2(acc);
+        }
+        for (; k<end; k++) s += val[k]*x[col[k]];
+        y[i] = s;
+    }
+}
+
+// Two complex entries per register, gathered as pairs (a complex index 2*col
+// may not fit the 32 bit gather offsets); real part: alternating sum of
+// val*x, imaginary part: sum of val*swap(x)
+__attribute__((target("avx2,fma")))
+static void zcsr_avx2(int32_t m, const int64_t *ptr, const int32_t *col,
+                      const double *val, const double *x, double *y) {
+    for (int32_t i=0; i<m; i++) {
+        __m256d re = _mm256_setzero_pd(), im = _mm256_setzero_pd();
+        int64_t k = ptr[i], end = ptr[i+1];
+        for (; k+2<=end; k+=2) {
+            __m256d vx = _mm256_insertf128_pd(
+                _mm256_castpd128_pd256(_mm_loadu_pd(&x[2*(int64_t)col[k]])),
+                _mm_loadu_pd(&x[2*(int64_t)col[k+1]]), 1);
+            __m256d vv = _mm256_loadu_pd(&val[2*k]);
+            re = _mm256_fmadd_pd(vv, vx, re);
+            im = _mm256_fmadd_pd(vv, _mm256_permute_pd(vx, 0x5), im);
+        }
+        double t[4];
+        _mm256_storeu_pd(t, re);
+        double sr = (t[0]-t[1])+(t[2]-t[3]), si = hsum_avx2(im);
+        if (k < end) {
+            const double *v = &val[2*k], *xk = &x[2*(int64_t)col[k]];
+            sr += v[0]*xk[0]-v[1]*xk[1];
+            si += v[0]*xk[1]+v[1]*xk[0];
+        }
+        y[2*i] = sr; y[2*i+1] = si;
+    }
+}
+
+
+/* --- AVX-512 (8 doubles per register) ------------------------------------- */
+
+__attribute__((target("avx512f")))
+static double dot_avx512(int64_t n, const double *x, const double *y) {
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+    int64_t i;
+    for (i=0; i+16<=n; i+=16) {
+        s0 = _mm512_fmadd_pd(_mm512_loadu_pd(&x[i]), _mm512_loadu_pd(&y[i]),
+                             s0);
+        s1 = _mm512_fmadd_pd(_mm512_loadu_pd(&x[i+8]),
+                             _mm512_loadu_pd(&y[i+8]), s1);
+    }
+    if (i+8 <= n) {
+        s0 = _mm512_fmadd_pd(_mm512_loadu_pd(&x[i]), _mm512_loadu_pd(&y[i]),
+                             s0);
+        i += 8;
+    }
+    if (i < n) {
+        __mmask8 m = (__mmask8)((1u << (n-i))-1);
+        s1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(m, &x[i]),
+                             _mm512_maskz_loadu_pd(m, &y[i]), s1);
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+}
+
+__attribute__((target("avx512f")))
+static double sumsq_avx512(int64_t n, const double *x) {
+    return dot_avx512(n, x, x);
+}
+
+__attribute__((target("avx512f")))
+static void axpy_avx512(int64_t n, double a, const double *x, double *y) {
+    __m512d va = _mm512_set1_pd(a);
+    int64_t i;
+    for (i=0; i+8<=n; i+=8)
+        _mm512_storeu_pd(&y[i], _mm512_fmadd_pd(va, _mm512_loadu_pd(&x[i]),
+                                                _mm512_loadu_pd(&y[i])));
+    if (i < n) {
+        __mmask8 m = (__mmask8)((1u << (n-i))-1);
+        _mm512_mask_storeu_pd(&y[i], m,
+                              _mm512_fmadd_pd(va,
+                                              _mm512_maskz_loadu_pd(m, &x[i]),
+                                              _mm512_maskz_loadu_pd(m, &y[i])));
+    }
+}
+
+__attribute__((target("avx512f")))
+static void scale_avx512(int64_t n, double a, const double *x, double *y) {
+    __m512d va = _mm512_set1_pd(a);
+    int64_t i;
+    for (i=0; i+8<=n; i+=8)
+        _mm512_storeu_pd(&y[i], _mm512_mul_pd(va, _mm512_loadu_pd(&x[i])));
+    if (i < n) {
+        __mmask8 m = (__mmask8)((1u << (n-i))-1);
+        _mm512_mask_storeu_pd(&y[i], m,
+                              _mm512_mul_pd(va,
+                                            _mm512_maskz_loadu_pd(m, &x[i])));
+    }
+}
+
+__attribute__((target("avx512f")))
+static void dotc_avx512(int64_t n, const double *x, const double *y,
+                        double *s) {
+    const __m512d sign = _mm512_set_pd(-1., 1., -1., 1., -1., 1., -1., 1.);
+    __m512d re = _mm512_setzero_pd(), im = _mm512_setzero_pd();
+    __m512d vx, vy;
+    int64_t i, len = 2*n;
+    for (i=0; i+8<=len; i+=8) {
+        vx = _mm512_loadu_pd(&x[i]); vy = _mm512_loadu_pd(&y[i]);
+        re = _mm512_fmadd_pd(vx, vy, re);
+        im = _mm512_fmadd_pd(vx, _mm512_permute_pd(vy, 0x55), im);
+    }
+    if (i < len) {
+        __mmask8 m = (__mmask8)((1u << (len-i))-1);
+        vx = _mm512_maskz_loadu_pd(m, &x[i]);
+        vy = _mm512_maskz_loadu_pd(m, &y[i]);
+        re = _mm512_fmadd_pd(vx, vy, re);
+        im = _mm512_fmadd_pd(vx, _mm512_permute_pd(vy, 0x55), im);
+    }
+    s[0] = _mm512_reduce_add_pd(re);
+    s[1] = _mm512_reduce_add_pd(_mm512_mul_pd(sign, im));
+}
+#endif
@@ -0,0 +1,524 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Shift-invert: cached band LU factorizations of (A - sigma I) for sparse    *
+ * matrices reordered by reverse Cuthill-McKee, inertia by band LDL^H         *
+ * -------------------------------------------------------------------------- */
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <float.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "../inc.d/eigs.h"
+
+
+// Maximal number of unused factorizations kept per matrix
+#define FACTOR_CACHE 4
+
+
+// Symmetrized sparsity pattern without diagonal
+typedef struct _Graph {
+    int32_t n;
+    int64_t *ptr;
+    int32_t *adj;
+    int32_t *deg;
+} graph;
+
+
+static void ordering(eigs_sparse *);
+static void graph_init(const eigs_sparse *, graph *);
+static void graph_destroy(graph *);
+static int32_t bfs(const graph *, int32_t, int32_t *, int32_t, int32_t *,
+                   int32_t *, int32_t *);
+static eigs_factor *factorize(const eigs_sparse *, double complex);
+static int32_t zinertia(const eigs_sparse *, double);
+static int32_t dinertia(const eigs_sparse *, double);
+static void factor_destroy(eigs_factor *);
+static void trim(eigs_sparse *);
+
+
+// Factorization of (A - sigma I), taken from the cache of the matrix if
+// possible (release with "eigs_factor_release")
+eigs_factor *eigs_factor_get(eigs_sparse *a, double complex sigma) {
+
+    eigs_factor *f;
+
+    // Ordering depends only on the pattern and is computed once
+    pthread_mutex_lock(&a->factor_lock);
+    if (!a->perm) ordering(a);
+    for (f=a->factors; f; f=f->next) {
+        if (f->sigma == sigma) {
+            f->refs++;
+            pthread_mutex_unlock(&a->factor_lock);
+            return f;
+        }
+    }
+    pthread_mutex_unlock(&a->factor_lock);
+
+    // Factorize outside of the lock, such that different shifts can be
+    // factorized at the same time
+    eigs_factor *g = factorize(a, sigma);
+
+    // Another thread may have been faster with the same shift
+    pthread_mutex_lock(&a->factor_lock);
+    for (f=a->factors; f; f=f->next) if (f->sigma == sigma) break;
+    if (f) {
+        factor_destroy(g);
+    } else {
+        f = g;
+        f->next = a->factors;
+        a->factors = f;
+    }
+    f->refs++;
+    trim(a);
+    pthread_mutex_unlock(&a->factor_lock);
+
+    return f;
+}
+
+// Bytes of the factorization of (A - sigma I) that "eigs_factor_get" would
+// allocate (zero if it is cached) and of the buffer of a solve
+size_t eigs_factor_bytes(eigs_sparse *a, double complex sigma) {
+
+    eigs_factor *f;
+    size_t n = a->n, m = a->complex_values ? 2 : 1;
+    size_t bytes = m*n*sizeof(double);
+
+    // Bandwidth follows from the ordering
+    pthread_mutex_lock(&a->factor_lock);
+    if (!a->perm) ordering(a);
+    for (f=a->factors; f; f=f->next) if (f->sigma == sigma) break;
+    if (!f)
+        bytes += sizeof(eigs_factor)+m*(3*(size_t)a->kd+1)*n*sizeof(double)
+                 +n*sizeof(lapack_int);
+    pthread_mutex_unlock(&a->factor_lock);
+
+    return bytes;
+}
+
+// Mark factorization as unused (it stays in the cache)
+void eigs_factor_release(eigs_sparse *a, eigs_factor *f) {
+    pthread_mutex_lock(&a->factor_lock);
+    f->refs--;
+    trim(a);
+    pthread_mutex_unlock(&a->factor_lock);
+}
+
+// Free the ordering and all cached factorizations of a matrix
+void eigs_factor_clear(eigs_sparse *a) {
+    eigs_factor *f, *next;
+    for (f=a->factors; f; f=next) { next = f->next; factor_destroy(f); }
+    a->factors = NULL;
+    free(a->perm); a->perm = NULL;
+}
+
+// Number of eigenvalues of the Hermitian matrix A below sigma: negative
+// pivots of the band LDL^H factorization (without pivoting) of P (A - sigma
+// I) P^T, which has the inertia of A - sigma I (Sylvester)
+int32_t eigs_sparse_inertia(eigs_sparse *a, double sigma) {
+
+    pthread_mutex_lock(&a->factor_lock);
+    if (!a->perm) ordering(a);
+    pthread_mutex_unlock(&a->factor_lock);
+
+    return a->complex_values ? zinertia(a, sigma) : dinertia(a, sigma);
+}
+
+// Solves with the factorization "f" (the buffer is allocated once, not at
+// every application of the map)
+void eigs_inverse_init(eigs_inverse *inv, const eigs_factor *f) {
+    size_t m = f->complex_values ? 2 : 1;
+    inv->factor = f;
+    inv->b = (double *)malloc(m*f->n*sizeof(double));
+}
+
+// Free the buffer of the solves
+void eigs_inverse_destroy(eigs_inverse *inv) {
+    free(inv->b); inv->b = NULL;
+}
+
+// y = (A - sigma I)^(-1) x for double complex matrices (use as "zphi" with
+// "phi_data" being an "eigs_inverse")
+void eigs_factor_zsolve(void *inverse,
+                        int32_t n,
+                        const double complex *x,
+                        double complex *y) {
+
+    const eigs_inverse *inv = (const eigs_inverse *)inverse;
+    const eigs_factor *f = inv->factor;
+    int32_t i, kd = f->kd;
+    double complex *b = (double complex *)inv->b;
+
+    for (i=0; i<n; i++) b[i] = x[f->perm[i]];
+    lapack_int info = LAPACKE_zgbtrs(LAPACK_COL_MAJOR, 'N', n, kd, kd, 1,
+                                     (const double complex *)f->ab, 3*kd+1,
+                                     f->ipiv, b, n);
+    if (info) {
+        printf("EIGS_FACTOR: LAPACKE_zgbtrs FAILED: INFO = %d\n", info);
+        exit(1);
+    }
+    for (i=0; i<n; i++) y[f->perm[i]] = b[i];
+}
+
+// y = (A - sigma I)^(-1) x for double matrices (use as "dphi" with
+// "phi_data" being an "eigs_inverse")
+void eigs_factor_dsolve(void *inverse,
+                        int32_t n,
+                        const double *x,
+                        double *y) {
+
+    const eigs_inverse *inv = (const eigs_inverse *)inverse;
+    const eigs_factor *f = inv->factor;
+    int32_t i, kd = f->kd;
+    double *b = inv->b;
+
+    for (i=0; i<n; i++) b[i] = x[f->perm[i]];
+    lapack_int info = LAPACKE_dgbtrs(LAPACK_COL_MAJOR, 'N', n, kd, kd, 1,
+                                     f->ab, 3*kd+1, f->ipiv, b, n);
+    if (info) {
+        printf("EIGS_FACTOR: LAPACKE_dgbtrs FAILED: INFO = %d\n", info);
+        exit(1);
+    }
+    for (i=0; i<n; i++) y[f->perm[i]] = b[i];
+}
+
+// Reverse Cuthill-McKee ordering and the resulting bandwidth
+static void ordering(eigs_sparse *a) {
+
+    int32_t n = a->n, i, j, s, l, start, count, levels, next, last, nq, gen;
+    int64_t k;
+    graph g;
+    graph_init(a, &g);
+
+    int32_t *perm = (int32_t *)malloc(n*sizeof(int32_t));
+    int32_t *mark = (int32_t *)calloc(n, sizeof(int32_t));
+    int32_t *queue = (int32_t *)malloc(n*sizeof(int32_t));
+
+    // Numbered nodes carry the mark -1, searches use increasing marks
+    gen = 0; count = 0; start = 0;
+    while (count < n) {
+
+        // Next unnumbered node (one per connected component)
+        while (mark[start] < 0) start++;
+        s = start;
+
+        // Pseudo-peripheral node: move to a node of minimal degree in the
+        // last level while the number of levels grows
+        levels = bfs(&g, s, mark, ++gen, queue, &last, &nq);
+        for (;;) {
+            next = queue[last];
+            for (i=last+1; i<nq; i++)
+                if (g.deg[queue[i]] < g.deg[next]) next = queue[i];
+            if (next == s) break;
+            l = bfs(&g, next, mark, ++gen, queue, &last, &nq);
+            if (l <= levels) break;
+            levels = l; s = next;
+        }
+
+        // Cuthill-McKee: visit neighbours by increasing degree
+        int32_t head = count;
+        perm[count++] = s; mark[s] = -1;
+        while (head < count) {
+            i = perm[head++];
+            int32_t first = count;
+            for (k=g.ptr[i]; k<g.ptr[i+1]; k++) {
+                j = g.adj[k];
+                if (mark[j] < 0) continue;
+                mark[j] = -1;
+                perm[count++] = j;
+            }
+            for (int32_t p=first+1; p<count; p++) {
+                j = perm[p];
+                int32_t q = p;
+                for (; (q>first) && (g.deg[perm[q-1]] > g.deg[j]); q--)
+                    perm[q] = perm[q-1];
+                perm[q] = j;
+            }
+        }
+    }
+
+    // Reverse
+    for (i=0; i<n/2; i++) {
+        j = perm[i]; perm[i] = perm[n-1-i]; perm[n-1-i] = j;
+    }
+
+    // Bandwidth in the new numbering
+    int32_t *iperm = mark;
+    for (i=0; i<n; i++) iperm[perm[i]] = i;
+    a->kd = 0;
+    for (i=0; i<n; i++) {
+        for (k=g.ptr[i]; k<g.ptr[i+1]; k++) {
+            int32_t d = iperm[i]-iperm[g.adj[k]];
+            if (d > a->kd) a->kd = d;
+        }
+    }
+    a->perm = perm;
+
+    free(mark); free(queue);
+    graph_destroy(&g);
+}
+
+// Pattern of A + A^T (duplicates are harmless)
+static void graph_init(const eigs_sparse *a, graph *g) {
+
+    int32_t n = a->n, i, j;
+    int64_t k;
+
+    g->n = n;
+    g->ptr = (int64_t *)calloc(n+1, sizeof(int64_t));
+    g->deg = (int32_t *)malloc(n*sizeof(int32_t));
+    for (i=0; i<n; i++) {
+        for (k=a->ptr[i]; k<a->ptr[i+1]; k++) {
+            if ((j = a->col[k]) == i) continue;
+            g->ptr[i+1]++; g->ptr[j+1]++;
+        }
+    }
+    for (i=0; i<n; i++) {
+        g->deg[i] = (int32_t)g->ptr[i+1];
+        g->ptr[i+1] += g->ptr[i];
+    }
+
+    int64_t *next = (int64_t *)malloc(n*sizeof(int64_t));
+    memcpy(next, g->ptr, n*sizeof(int64_t));
+    g->adj = (int32_t *)malloc(g->ptr[n]*sizeof(int32_t));
+    for (i=0; i<n; i++) {
+        for (k=a->ptr[i]; k<a->ptr[i+1]; k++) {
+            if ((j = a->col[k]) == i) continue;
+            g->adj[next[i]++] = j;
+            g->adj[next[j]++] = i;
+        }
+    }
+    free(next);
+}
+
+// Free for graph type
+static void graph_destroy(graph *g) {
+    free(g->ptr); free(g->adj); free(g->deg);
+}
+
+// Breadth first search from "s" over unnumbered nodes, marking them with
+// "gen"; returns the number of levels, the "nq" visited nodes are in "queue"
+// and "last" is the position of the first node of the last level
+static int32_t bfs(const graph *g,
+                   int32_t s,
+                   int32_t *mark,
+                   int32_t gen,
+                   int32_t *queue,
+                   int32_t *last,
+                   int32_t *nq) {
+
+    int32_t head = 0, tail = 0, end, levels = 0, i, j;
+    int64_t k;
+
+    queue[tail++] = s; mark[s] = gen;
+    while (head < tail) {
+        *last = head; end = tail; levels++;
+        for (; head<end; head++) {
+            i = queue[head];
+            for (k=g->ptr[i]; k<g->ptr[i+1]; k++) {
+                j = g->adj[k];
+                if ((mark[j] < 0) || (mark[j] == gen)) continue;
+                mark[j] = gen;
+                queue[tail++] = j;
+            }
+        }
+    }
+    *nq = tail;
+
+    return levels;
+}
+
+// Band LU factorization of P (A - sigma I) P^T
+static eigs_factor *factorize(const eigs_sparse *a, double complex sigma) {
+
+    int32_t n = a->n, kd = a->kd, i, j, r, c;
+    int64_t k, ldab = 3*(int64_t)kd+1;
+    size_t m = a->complex_values ? 2 : 1;
+
+    eigs_factor *f = (eigs_factor *)malloc(sizeof(eigs_factor));
+    f->sigma = sigma;
+    f->n = n; f->kd = kd;
+    f->complex_values = a->complex_values;
+    f->perm = a->perm;
+    f->refs = 0;
+    f->next = NULL;
+    f->ab = (double *)calloc(m*ldab*n, sizeof(double));
+    f->ipiv = (lapack_int *)malloc(n*sizeof(lapack_int));
+    if (!f->ab || !f->ipiv) {
+        printf("EIGS_FACTOR: NOT ENOUGH MEMORY FOR BANDWIDTH %d\n", kd);
+        exit(1);
+    }
+
+    // Element (r,c) of the band matrix is ab[2*kd+r-c+ldab*c]
+    int32_t *iperm = (int32_t *)malloc(n*sizeof(int32_t));
+    for (i=0; i<n; i++) iperm[a->perm[i]] = i;
+    double *ab = f->ab;
+    for (i=0; i<n; i++) {
+        for (k=a->ptr[i]; k<a->ptr[i+1]; k++) {
+            j = a->col[k];
+            r = iperm[i]; c = iperm[j];
+            int64_t p = m*(2*kd+r-c+ldab*c), q = m*(2*kd+c-r+ldab*r);
+            ab[p] += a->val[m*k];
+            if (m == 2) ab[p+1] += a->val[2*k+1];
+            if (!a->half || (i == j)) continue;
+            ab[q] += a->val[m*k];
+            if (m == 2) ab[q+1] -= a->val[2*k+1];
+        }
+    }
+    for (r=0; r<n; r++) {
+        ab[m*(2*kd+ldab*r)] -= creal(sigma);
+        if (m == 2) ab[m*(2*kd+ldab*r)+1] -= cimag(sigma);
+    }
+    free(iperm);
+
+    // Factorize
+    lapack_int info;
+    if (a->complex_values)
+        info = LAPACKE_zgbtrf(LAPACK_COL_MAJOR, n, n, kd, kd,
+                              (double complex *)ab, ldab, f->ipiv);
+    else
+        info = LAPACKE_dgbtrf(LAPACK_COL_MAJOR, n, n, kd, kd, ab, ldab,
+                              f->ipiv);
+    if (info > 0) {
+        printf("%s\n", "EIGS_FACTOR: A - SIGMA I IS SINGULAR, CHANGE SIGMA");
+        exit(1);
+    }
+    if (info < 0) {
+        printf("EIGS_FACTOR: BAND LU FAILED: INFO = %d\n", info);
+        exit(1);
+    }
+
+    return f;
+}
+
+// Negative pivots of LDL^H of the double complex band matrix; element (r,c),
+// r >= c, of the lower band is ab[r-c+(kd+1)*c], tiny pivots are replaced by
+// -pivmin (as in the Sturm counts of LAPACK's DSTEBZ)
+static int32_t zinertia(const eigs_sparse *a, double sigma) {
+
+    int32_t n = a->n, kd = a->kd, i, j, r, c, count = 0;
+    int64_t k, ld = (int64_t)kd+1;
+    double amax = 0.;
+
+    double complex *ab = (double complex *)calloc(ld*n, sizeof(double complex));
+    int32_t *iperm = (int32_t *)malloc(n*sizeof(int32_t));
+    if (!ab || !iperm) {
+        printf("EIGS_INERTIA: NOT ENOUGH MEMORY FOR BANDWIDTH %d\n", kd);
+        exit(1);
+    }
+    for (i=0; i<n; i++) iperm[a->perm[i]] = i;
+
+    // Lower triangle (the upper one of half storage is conjugated)
+    const double complex *val = (const double complex *)a->val;
+    for (i=0; i<n; i++) {
+        for (k=a->ptr[i]; k<a->ptr[i+1]; k++) {
+            j = a->col[k];
+            r = iperm[i]; c = iperm[j];
+            if (cabs(val[k]) > amax) amax = cabs(val[k]);
+            if (r >= c) ab[r-c+ld*c] += val[k];
+            else if (a->half) ab[c-r+ld*r] += conj(val[k]);
+        }
+    }
+    for (r=0; r<n; r++) ab[ld*r] -= sigma;
+    double pivmin = DBL_EPSILON*(amax+fabs(sigma))*(2*kd+1);
+    if (pivmin == 0.) pivmin = DBL_MIN;
+
+    // Right-looking LDL^H within the band
+    for (c=0; c<n; c++) {
+        double complex *col = &ab[ld*c];
+        double d = creal(col[0]);
+        if (fabs(d) < pivmin) d = -pivmin;
+        if (d < 0.) count++;
+        int32_t m = (kd < n-1-c) ? kd : n-1-c;
+        for (j=1; j<=m; j++) {
+            double complex l = conj(col[j])/d;
+            if (l == 0.) continue;
+            double complex *cj = &ab[ld*(c+j)];
+            for (i=j; i<=m; i++) cj[i-j] -= col[i]*l;
+        }
+    }
+
+    free(ab); free(iperm);
+    return count;
+}
+
+// Negative pivots of LDL^T of the double band matrix (as "zinertia")
+static int32_t dinertia(const eigs_sparse *a, double sigma) {
+
+    int32_t n = a->n, kd = a->kd, i, j, r, c, count = 0;
+    int64_t k, ld = (int64_t)kd+1;
+    double amax = 0.;
+
+    double *ab = (double *)calloc(ld*n, sizeof(double));
+    int32_t *iperm = (int32_t *)malloc(n*sizeof(int32_t));
+    if (!ab || !iperm) {
+        printf("EIGS_INERTIA: NOT ENOUGH MEMORY FOR BANDWIDTH %d\n", kd);
+        exit(1);
+    }
+    for (i=0; i<n; i++) iperm[a->perm[i]] = i;
+
+    for (i=0; i<n; i++) {
+        for (k=a->ptr[i]; k<a->ptr[i+1]; k++) {
+            j = a->col[k];
+            r = iperm[i]; c = iperm[j];
+            if (fabs(a->val[k]) > amax) amax = fabs(a->val[k]);
+            if (r >= c) ab[r-c+ld*c] += a->val[k];
+            else if (a->half) ab[c-r+ld*r] += a->val[k];
+        }
+    }
+    for (r=0; r<n; r++) ab[ld*r] -= sigma;
+    double pivmin = DBL_EPSILON*(amax+fabs(sigma))*(2*kd+1);
+    if (pivmin == 0.) pivmin = DBL_MIN;
+
+    for (c=0; c<n; c++) {
+        double *col = &ab[ld*c];
+        double d = col[0];
+        if (fabs(d) < pivmin) d = -pivmin;
+        if (d < 0.) count++;
+        int32_t m = (kd < n-1-c) ? kd : n-1-c;
+        for (j=1; j<=m; j++) {
+            double l = col[j]/d;
+            if (l == 0.) continue;
+            double *cj = &ab[ld*(c+j)];
+            for (i=j; i<=m; i++) cj[i-j] -= col[i]*l;
+        }
+    }
+
+    free(ab); free(iperm);
+    return count;
+}
+
+// Free for eigs_factor type (the ordering belongs to the matrix)
+static void factor_destroy(eigs_factor *f) {
+    free(f->ab); free(f->ipiv);
+    free(f);
+}
+
+// Drop unused factorizations beyond the size of the cache
+static void trim(eigs_sparse *a) {
+    eigs_factor **p = &a->factors, *f;
+    int32_t kept = 0;
+    while ((f = *p)) {
+        if (f->refs || (kept < FACTOR_CACHE)) {
+            kept++; p = &f->next;
+        } else {
+            *p = f->next; factor_destroy(f);
+        }
+    }
+}
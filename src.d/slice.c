@@ -0,0 +1,310 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Spectrum slicing: all eigenvalues of a sparse Hermitian matrix in an       *
+ * interval by inertia counts and concurrent shift-invert solves              *
+ *                                                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#include <float.h>
+#include <math.h>
+
+#include "../inc.d/eigs.h"
+
+
+// Eigenvalues per slice the bisection aims at
+#define SLICE_EIGS 48
+
+// Additional eigenvalues of a slice's solve (convergence of the edges)
+#define SLICE_EXTRA 4
+
+
+// Slice [lo, hi) holding "count" eigenvalues
+typedef struct _Slice {
+    double lo;
+    double hi;
+    int32_t count;
+    eigs_result *result;
+} slice;
+
+// Inertia counts at a set of points
+typedef struct _InertiaJob {
+    eigs_sparse *a;
+    const double *x;
+    int32_t *nu;
+} inertia_job;
+
+// Shift-invert solves of all slices
+typedef struct _SliceJob {
+    const char *solver;
+    eigs_sparse *a;
+    int32_t maxiter;
+    double tol;
+    bool evs;
+    eigs_options opts;     // Options of the slices (column-major)
+    slice *slices;
+    int32_t *order;        // Slices by decreasing counts (tasks of the pool)
+} slice_job;
+
+// Eigenvalue of a slice by its distance to the shift
+typedef struct _SliceValue {
+    double value;
+    double dist;
+    int32_t j;
+} slice_value;
+
+
+static bool crowded(const double *, const int32_t *, int32_t, double, double);
+static void inertia(eigs_sparse *, int32_t, const double *, int32_t *);
+static void inertia_task(void *, int32_t, int32_t);
+static void slice_task(void *, int32_t, int32_t);
+static int compare_dist(const void *, const void *);
+
+
+// All eigenvalues in [vl, vu) of the Hermitian sparse matrix "a" ("zh" for
+// double complex, "ds" for double values), ascending
+eigs_result *eigs_slice(const char *solver,
+                        eigs_sparse *a,
+                        double vl,
+                        double vu,
+                        int32_t maxiter,
+                        double tol,
+                        bool evs,
+                        const eigs_options *opts) {
+
+    double start = eigs_clock();
+    eigs_options defaults;
+    if (!opts) { eigs_options_init(&defaults); opts = &defaults; }
+
+    int32_t n = a->n, nslices, s, i, j;
+
+    // Check input
+    if (strcmp(solver, "zh") && strcmp(solver, "ds")) {
+        printf("%s\n", "EIGS_SLICE: SOLVER MUST BE zh OR ds");
+        exit(1);
+    }
+    if (a->complex_values != !strcmp(solver, "zh")) {
+        printf("EIGS_SLICE: Solver *%s* does not match the values\n", solver);
+        exit(1);
+    }
+    if (!(vl < vu)) {
+        printf("%s\n", "EIGS_SLICE: INTERVAL [VL, VU) IS EMPTY");
+        exit(1);
+    }
+    if (opts->cphi || opts->sphi || opts->zphi_block || opts->dphi_block) {
+        printf("%s\n", "EIGS_SLICE: MAPS OF THE OPTIONS NOT SUPPORTED");
+        exit(1);
+    }
+
+    // Number of eigenvalues in the interval
+    double ends[2] = { vl, vu };
+    int32_t nu_ends[2];
+    inertia(a, 2, ends, nu_ends);
+    int32_t total = nu_ends[1]-nu_ends[0];
+
+    // Equal slices, at least one per thread
+    nslices = (total+SLICE_EIGS-1)/SLICE_EIGS;
+    if (nslices < eigs_pool_size()) nslices = eigs_pool_size();
+    if (nslices < 1) nslices = 1;
+    double *x = (double *)malloc((nslices+1)*sizeof(double));
+    int32_t *nu = (int32_t *)malloc((nslices+1)*sizeof(int32_t));
+    for (s=1; s<nslices; s++) x[s] = vl+(vu-vl)*s/nslices;
+    inertia(a, nslices-1, x+1, nu+1);
+    x[0] = vl; nu[0] = nu_ends[0];
+    x[nslices] = vu; nu[nslices] = nu_ends[1];
+
+    // Bisect slices with too many eigenvalues (clusters stay together once
+    // the slices become too narrow to separate them)
+    for (;;) {
+        int32_t nsplit = 0;
+        for (s=0; s<nslices; s++) if (crowded(x, nu, s, vl, vu)) nsplit++;
+        if (!nsplit) break;
+        double *y = (double *)malloc((nslices+nsplit+1)*sizeof(double));
+        int32_t *mu = (int32_t *)malloc((nslices+nsplit+1)*sizeof(int32_t));
+        double *mid = (double *)malloc(nsplit*sizeof(double));
+        int32_t *nu_mid = (int32_t *)malloc(nsplit*sizeof(int32_t));
+        for (s=0, j=0; s<nslices; s++)
+            if (crowded(x, nu, s, vl, vu)) mid[j++] = .5*(x[s]+x[s+1]);
+        inertia(a, nsplit, mid, nu_mid);
+        for (s=0, i=0, j=0; s<nslices; s++) {
+            y[i] = x[s]; mu[i++] = nu[s];
+            if (crowded(x, nu, s, vl, vu)) {
+                y[i] = mid[j]; mu[i++] = nu_mid[j++];
+            }
+        }
+        y[i] = x[nslices]; mu[i] = nu[nslices];
+        free(x); free(nu); free(mid); free(nu_mid);
+        x = y; nu = mu; nslices += nsplit;
+    }
+
+    // Non-empty slices, largest first
+    slice_job job;
+    job.solver = solver;
+    job.a = a;
+    job.maxiter = maxiter; job.tol = tol; job.evs = evs;
+    job.opts = *opts;
+    job.opts.shift_invert = true;
+    job.opts.chebyshev = 0;
+    job.opts.range = 'A';
+    job.opts.colmajor = true;
+    job.opts.eigvecs = NULL;
+    job.slices = (slice *)malloc(nslices*sizeof(slice));
+    job.order = (int32_t *)malloc(nslices*sizeof(int32_t));
+    int32_t nonempty = 0;
+    for (s=0; s<nslices; s++) {
+        slice *sl = &job.slices[nonempty];
+        sl->count = nu[s+1]-nu[s];
+        if (!sl->count) continue;
+        if (sl->count+1 >= n) {
+            printf("%s\n", "EIGS_SLICE: SLICE HOLDS ALMOST ALL EIGENVALUES, "
+                           "USE A DENSE SOLVER");
+            exit(1);
+        }
+        sl->lo = x[s]; sl->hi = x[s+1];
+        sl->result = NULL;
+        for (i=nonempty; (i>0) && (job.slices[job.order[i-1]].count
+                                   < sl->count); i--)
+            job.order[i] = job.order[i-1];
+        job.order[i] = nonempty++;
+    }
+    free(x); free(nu);
+
+    // Shift-invert solves run concurrently (factorizations of different
+    // shifts are computed at the same time)
+    eigs_pool_run(nonempty, slice_task, &job);
+
+    // Result
+    eigs_result *result = (eigs_result *)malloc(sizeof(eigs_result));
+    result->n = n; result->k = total;
+    result->eigvals = (double complex *)malloc(total*sizeof(double complex));
+    result->eigvecs = NULL;
+    result->borrowed = false;
+    if (evs && opts->eigvecs) {
+        result->eigvecs = opts->eigvecs; result->borrowed = true;
+    } else
+    if (evs) {
+        result->eigvecs = (double complex *)malloc((size_t)n*total
+                                                   *sizeof(double complex));
+    }
+    result->nmatvec_float = 0;
+    result->nmatvec_refine = 0;
+    memset(&result->stats, 0, sizeof(eigs_stats));
+
+    // Merge: the slices are ascending and each one holds exactly the
+    // eigenvalues its inertia counts, i.e. those closest to its center
+    // (eigenvalues near a boundary are taken by one slice only)
+    int32_t off = 0;
+    for (s=0; s<nonempty; s++) {
+        slice *sl = &job.slices[s];
+        eigs_result *r = sl->result;
+        double sigma = .5*(sl->lo+sl->hi);
+        if (r->k < sl->count) {
+            printf("EIGS_SLICE: %d OF %d EIGENVALUES OF A SLICE FOUND\n",
+                   r->k, sl->count);
+            exit(1);
+        }
+        slice_value *v = (slice_value *)malloc(r->k*sizeof(slice_value));
+        for (j=0; j<r->k; j++) {
+            v[j].value = creal(r->eigvals[j]);
+            v[j].dist = fabs(v[j].value-sigma);
+            v[j].j = j;
+        }
+        qsort(v, r->k, sizeof(slice_value), compare_dist);
+        for (i=1; i<sl->count; i++) {
+            slice_value t = v[i];
+            for (j=i; (j>0) && (v[j-1].value > t.value); j--) v[j] = v[j-1];
+            v[j] = t;
+        }
+        for (j=0; j<sl->count; j++) {
+            result->eigvals[off+j] = CMPLX(v[j].value, 0.);
+            if (!evs) continue;
+            const double complex *y = r->eigvecs+(size_t)n*v[j].j;
+            if (opts->colmajor)
+                memcpy(result->eigvecs+(size_t)n*(off+j), y,
+                       n*sizeof(double complex));
+            else
+                for (i=0; i<n; i++)
+                    result->eigvecs[(size_t)total*i+off+j] = y[i];
+        }
+        off += sl->count;
+
+        result->stats.nmatvec += r->stats.nmatvec;
+        result->stats.nrestart += r->stats.nrestart;
+        result->stats.nreorth += r->stats.nreorth;
+        result->stats.time_phi += r->stats.time_phi;
+        result->stats.time_orth += r->stats.time_orth;
+        result->stats.time_restart += r->stats.time_restart;
+        result->stats.time_extract += r->stats.time_extract;
+        free(v);
+        eigs_result_free(r);
+    }
+    result->stats.nconv = total;
+
+    free(job.slices); free(job.order);
+
+    result->stats.time_total = eigs_clock()-start;
+    return result;
+}
+
+// Slice s has too many eigenvalues and can still be bisected
+static bool crowded(const double *x,
+                    const int32_t *nu,
+                    int32_t s,
+                    double vl,
+                    double vu) {
+    return (nu[s+1]-nu[s] > SLICE_EIGS) &&
+           (x[s+1]-x[s] > 1e3*DBL_EPSILON*(fabs(vl)+fabs(vu)));
+}
+
+// Inertia counts at "m" points on the thread pool
+static void inertia(eigs_sparse *a, int32_t m, const double *x, int32_t *nu) {
+    inertia_job job = { a, x, nu };
+    eigs_pool_run(m, inertia_task, &job);
+}
+
+// Inertia count at a single point
+static void inertia_task(void *arg, int32_t task, int32_t worker) {
+    inertia_job *job = (inertia_job *)arg;
+    (void)worker;
+    job->nu[task] = eigs_sparse_inertia(job->a, job->x[task]);
+}
+
+// Shift-invert solve of a single slice: the eigenvalues closest to its
+// center and a few more
+static void slice_task(void *arg, int32_t task, int32_t worker) {
+
+    slice_job *job = (slice_job *)arg;
+    slice *sl = &job->slices[job->order[task]];
+    eigs_options opts = job->opts;
+    int32_t n = job->a->n;
+    int32_t k = sl->count+SLICE_EXTRA;
+    (void)worker;
+
+    if (k > n-2) k = n-2;
+    opts.sigma = CMPLX(.5*(sl->lo+sl->hi), 0.);
+    bool real = !strcmp(job->solver, "ds");
+    sl->result = eigsx(job->solver, real ? NULL : eigs_sparse_zphi,
+                       real ? eigs_sparse_dphi : NULL, NULL, NULL, job->a, n,
+                       k, "LM", job->maxiter, job->tol, job->evs, &opts);
+}
+
+// Increasing distance to the shift
+static int compare_dist(const void *a, const void *b) {
+    double x = ((const slice_value *)a)->dist;
+    double y = ((const slice_value *)b)->dist;
+    return (x > y)-(x < y);
+}
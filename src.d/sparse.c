@@ -0,0 +1,324 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Sparse (CSR/CSC) double and double complex endomorphisms and their         *
+ * multithreaded action on vectors                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+
+#include "../inc.d/eigs.h"
+
+
+// Number of row blocks per participant of the pool (full storage)
+#define BLOCKS_PER_THREAD 4
+
+
+// Arguments of a single action of the matrix
+typedef struct _SparseJob {
+    const eigs_sparse *a;
+    const double *x;
+    double *y;
+} sparse_job;
+
+
+static void to_csr(eigs_sparse *, const int64_t *, const int32_t *,
+                   const void *);
+static void partition(eigs_sparse *);
+static void apply(eigs_sparse *, const double *, double *);
+static void rows_task(void *, int32_t, int32_t);
+static void reduce_task(void *, int32_t, int32_t);
+static void drows(const eigs_sparse *, int32_t, int32_t, const double *,
+                  double *, double *, int32_t);
+static void zrows(const eigs_sparse *, int32_t, int32_t, const double *,
+                  double *, double *, int32_t);
+
+
+// Sparse matrix from CSR or CSC arrays (either "zval" or "dval" is NULL)
+eigs_sparse *eigs_sparse_init(const char *format,
+                              bool half,
+                              int32_t n,
+                              const int64_t *ptr,
+                              const int32_t *idx,
+                              const double complex *zval,
+                              const double *dval) {
+
+    // Allocate memory for matrix
+    eigs_sparse *a = (eigs_sparse *)malloc(sizeof(eigs_sparse));
+    a->n = n;
+    a->half = half;
+    a->complex_values = (zval != NULL);
+    a->nnz = ptr[n];
+    const void *val = a->complex_values ? (const void *)zval
+                                        : (const void *)dval;
+
+    // CSR arrays are referenced, CSC arrays are transposed into CSR once
+    if (!strcmp(format, "csr")) {
+        a->own = false;
+        a->ptr = (int64_t *)ptr;
+        a->col = (int32_t *)idx;
+        a->val = (double *)val;
+    } else
+    if (!strcmp(format, "csc")) {
+        a->own = true;
+        to_csr(a, ptr, idx, val);
+    } else {
+        printf("EIGS_SPARSE: Format *%s* not implemented\n", format);
+        exit(1);
+    }
+
+    // Row blocks for the thread pool
+    partition(a);
+    pthread_mutex_init(&a->lock, NULL);
+
+    // Shift-invert factorizations are created on demand
+    a->perm = NULL; a->kd = 0;
+    a->factors = NULL;
+    pthread_mutex_init(&a->factor_lock, NULL);
+
+    return a;
+}
+
+// Free memory allocated by sparse matrix
+void eigs_sparse_free(eigs_sparse *a) {
+    if (a->own) { free(a->ptr); free(a->col); free(a->val); }
+    free(a->block);
+    free(a->lo); free(a->hi); free(a->offset);
+    free(a->scatter);
+    pthread_mutex_destroy(&a->lock);
+    eigs_factor_clear(a);
+    pthread_mutex_destroy(&a->factor_lock);
+    free(a);
+}
+
+// Action of a double complex sparse matrix (use as "zphi" with "phi_data"
+// being the matrix)
+void eigs_sparse_zphi(void *a, int32_t n, const double complex *x,
+                      double complex *y) {
+    (void)n;
+    apply((eigs_sparse *)a, (const double *)x, (double *)y);
+}
+
+// Action of a double sparse matrix (use as "dphi" with "phi_data" being the
+// matrix)
+void eigs_sparse_dphi(void *a, int32_t n, const double *x, double *y) {
+    (void)n;
+    apply((eigs_sparse *)a, x, y);
+}
+
+// Transpose CSC into owned CSR arrays
+static void to_csr(eigs_sparse *a,
+                   const int64_t *ptr,
+                   const int32_t *idx,
+                   const void *val) {
+
+    int32_t n = a->n, i, j;
+    int64_t k, pos, nnz = a->nnz;
+    size_t m = a->complex_values ? 2 : 1;
+    const double *v = (const double *)val;
+
+    a->ptr = (int64_t *)calloc(n+1, sizeof(int64_t));
+    a->col = (int32_t *)malloc(nnz*sizeof(int32_t));
+    a->val = (double *)malloc(m*nnz*sizeof(double));
+
+    for (k=0; k<nnz; k++) a->ptr[idx[k]+1]++;
+    for (i=0; i<n; i++) a->ptr[i+1] += a->ptr[i];
+
+    int64_t *next = (int64_t *)malloc(n*sizeof(int64_t));
+    memcpy(next, a->ptr, n*sizeof(int64_t));
+    for (j=0; j<n; j++) {
+        for (k=ptr[j]; k<ptr[j+1]; k++) {
+            pos = next[idx[k]]++;
+            a->col[pos] = j;
+            memcpy(&a->val[m*pos], &v[m*k], m*sizeof(double));
+        }
+    }
+    free(next);
+}
+
+// Split rows into blocks with (roughly) equal number of nonzeros; for half
+// storage every block also gets a scatter buffer for the columns it touches
+static void partition(eigs_sparse *a) {
+
+    int32_t nthreads = eigs_pool_size(), b, i, lo, hi;
+    int32_t nblocks = a->half ? nthreads : BLOCKS_PER_THREAD*nthreads;
+    if (nblocks > a->n) nblocks = a->n;
+    if (nblocks < 1) nblocks = 1;
+    a->nblocks = nblocks;
+    a->block = (int32_t *)malloc((nblocks+1)*sizeof(int32_t));
+
+    // Binary search for the first row of each block
+    a->block[0] = 0;
+    for (b=1; b<nblocks; b++) {
+        int64_t target = (a->nnz*b)/nblocks;
+        lo = a->block[b-1]; hi = a->n;
+        while (lo < hi) {
+            i = lo+(hi-lo)/2;
+            if (a->ptr[i] < target) lo = i+1; else hi = i;
+        }
+        a->block[b] = lo;
+    }
+    a->block[nblocks] = a->n;
+
+    // Column ranges [lo, hi) of the scatter buffers
+    a->lo = NULL; a->hi = NULL; a->scatter = NULL; a->offset = NULL;
+    if (!a->half || (nblocks == 1)) return;
+    a->lo = (int32_t *)malloc(nblocks*sizeof(int32_t));
+    a->hi = (int32_t *)malloc(nblocks*sizeof(int32_t));
+    int64_t size = 0, k;
+    for (b=0; b<nblocks; b++) {
+        a->lo[b] = a->hi[b] = a->block[b];
+        for (i=a->block[b]; i<a->block[b+1]; i++)
+            for (k=a->ptr[i]; k<a->ptr[i+1]; k++)
+                if (a->col[k]+1 > a->hi[b]) a->hi[b] = a->col[k]+1;
+        size += a->hi[b]-a->lo[b];
+    }
+    size_t m = a->complex_values ? 2 : 1;
+    a->scatter = (double *)calloc(m*size, sizeof(double));
+    a->offset = (int64_t *)malloc(nblocks*sizeof(int64_t));
+    for (size=0, b=0; b<nblocks; b++) {
+        a->offset[b] = size;
+        size += a->hi[b]-a->lo[b];
+    }
+}
+
+// y = A x
+static void apply(eigs_sparse *a, const double *x, double *y) {
+
+    sparse_job job = { a, x, y };
+
+    // Full storage: rows are independent
+    if (!a->half) {
+        eigs_pool_run(a->nblocks, rows_task, &job);
+        return;
+    }
+
+    // Half storage: scatter buffers are in use by another thread, or there
+    // is only a single block, then work serially on y directly
+    if ((a->nblocks == 1) || pthread_mutex_trylock(&a->lock)) {
+        if (a->complex_values)
+            zrows(a, 0, a->n, x, y, y, 0);
+        else
+            drows(a, 0, a->n, x, y, y, 0);
+        return;
+    }
+    eigs_pool_run(a->nblocks, rows_task, &job);
+    eigs_pool_run(a->nblocks, reduce_task, &job);
+    pthread_mutex_unlock(&a->lock);
+}
+
+// Rows of block "task"
+static void rows_task(void *arg, int32_t task, int32_t worker) {
+
+    sparse_job *job = (sparse_job *)arg;
+    const eigs_sparse *a = job->a;
+    int32_t r0 = a->block[task], r1 = a->block[task+1], lo = 0;
+    double *scatter = NULL;
+    (void)worker;
+
+    if (a->half) {
+        size_t m = a->complex_values ? 2 : 1;
+        scatter = &a->scatter[m*a->offset[task]];
+        lo = a->lo[task];
+    }
+    if (a->complex_values)
+        zrows(a, r0, r1, job->x, job->y, scatter, lo);
+    else
+        drows(a, r0, r1, job->x, job->y, scatter, lo);
+}
+
+// Add scatter buffers to the rows of block "task" (and zero them again)
+static void reduce_task(void *arg, int32_t task, int32_t worker) {
+
+    sparse_job *job = (sparse_job *)arg;
+    const eigs_sparse *a = job->a;
+    int32_t r0 = a->block[task], r1 = a->block[task+1], b, lo, hi;
+    size_t m = a->complex_values ? 2 : 1, j;
+    (void)worker;
+
+    for (b=0; b<=task; b++) {
+        lo = (a->lo[b] > r0) ? a->lo[b] : r0;
+        hi = (a->hi[b] < r1) ? a->hi[b] : r1;
+        if (lo >= hi) continue;
+        double *s = &a->scatter[m*(a->offset[b]+lo-a->lo[b])];
+        double *y = &job->y[m*lo];
+        for (j=0; j<m*(hi-lo); j++) { y[j] += s[j]; s[j] = 0.; }
+    }
+}
+
+// Rows r0,...,r1-1 of a double matrix (products of the rows by the
+// vectorized kernel), for half storage the transposed strictly upper part
+// goes to "scatter" (which starts at column "lo")
+static void drows(const eigs_sparse *a,
+                  int32_t r0,
+                  int32_t r1,
+                  const double *x,
+                  double *y,
+                  double *scatter,
+                  int32_t lo) {
+
+    const int64_t *ptr = a->ptr;
+    const int32_t *col = a->col;
+    const double *val = a->val;
+    int32_t i;
+    int64_t k;
+
+    // Serial half storage scatters into y itself, i.e. to rows after the
+    // current one (y_i holds the product of row i before)
+    eigs_dcsr_rows(r1-r0, &ptr[r0], col, val, x, &y[r0]);
+    if (!a->half) return;
+
+    // Transposed strictly upper part
+    for (i=r0; i<r1; i++)
+        for (k=ptr[i]; k<ptr[i+1]; k++)
+            if (col[k] != i) scatter[col[k]-lo] += val[k]*x[i];
+}
+
+// Rows r0,...,r1-1 of a double complex matrix (stored as pairs of doubles),
+// for half storage the adjoint strictly upper part goes to "scatter"
+static void zrows(const eigs_sparse *a,
+                  int32_t r0,
+                  int32_t r1,
+                  const double *x,
+                  double *y,
+                  double *scatter,
+                  int32_t lo) {
+
+    const int64_t *ptr = a->ptr;
+    const int32_t *col = a->col;
+    const double *val = a->val;
+    const double *v;
+    int32_t i, j;
+    int64_t k;
+    double xr, xi;
+
+    eigs_zcsr_rows(r1-r0, &ptr[r0], col, val, x, &y[2*r0]);
+    if (!a->half) return;
+
+    // Adjoint strictly upper part
+    for (i=r0; i<r1; i++) {
+        xr = x[2*i]; xi = x[2*i+1];
+        for (k=ptr[i]; k<ptr[i+1]; k++) {
+            if ((j = col[k]) == i) continue;
+            v = &val[2*k];
+            scatter[2*(j-lo)] += v[0]*xr+v[1]*xi;
+            scatter[2*(j-lo)+1] += v[0]*xi-v[1]*xr;
+        }
+    }
+}
@@ -0,0 +1,59 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LAPACK based solver for all float eigenvalues/-vectors of a                *
+ * symmetric matrix                                                           *
+ *                                                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#include "../inc.d/eigs.h"
+
+
+// Eigenvalues and eigenvectors (the row-major input read as column-major is
+// the transposed, i.e. the same, matrix)
+void sseigsa(uint32_t n,
+             const float *phi,
+             bool evs,
+             eigs_fresult *result) {
+
+    // Copy input, LAPACK overwrites it
+    float *a = (float *)malloc((size_t)n*n*sizeof(float));
+    memcpy(a, phi, (size_t)n*n*sizeof(float));
+
+    // Solve eigenproblem using LAPACK (divide and conquer)
+    uint32_t i;
+    float *eigvals = (float *)malloc(n*sizeof(float));
+    lapack_int info = LAPACKE_ssyevd(LAPACK_COL_MAJOR,
+                                     evs ? 'V' : 'N',
+                                     'L',
+                                     n,
+                                     a,
+                                     n,
+                                     eigvals);
+    for (i=0; i<n; i++) result->eigvals[i] = CMPLXF(eigvals[i], 0.f);
+
+    // Check result
+    if (info) {
+        printf("%s\n", "EIGS: LAPACKE_ssyevd did not converge"); exit(1);
+    }
+
+    // Check if eigenvectors are desired
+    if (evs) eigs_svecs(n, n, a, NULL, result->eigvecs, false, false);
+
+    // Clean up
+    free(a); free(eigvals);
+}
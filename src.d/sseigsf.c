@@ -0,0 +1,305 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * ARPACK based solver for a few eigenvalues/-vectors of a symmetric float    *
+ * endomorphism                                                               *
+ * -------------------------------------------------------------------------- */
+
+
+#include "../inc.d/eigs.h"
+
+
+// Data for internal usage
+typedef struct _SseigsfData {
+
+    // User set
+    a_int n;
+    seigs_phi *phi;
+    void *phi_data;
+    a_int nev;
+    const char *which;
+    bool evs;
+    float tol;
+    a_int ncv;
+    a_int mxiter;
+
+    // Internal
+    a_int ido;
+    const char *bmat;
+    float *resid;
+    float *v;
+    a_int ldv;
+    a_int *iparam;
+    a_int *ipntr;
+    float *workd;
+    a_int lworkl;
+    float *workl;
+    a_int info;
+    a_int ldz;
+    a_int *select;
+
+    // Results
+    float *d;
+    float *z;
+
+} sseigsf_data;
+
+
+static sseigsf_data *sseigsf_alloc(a_int,
+                                   a_int);
+static void sseigsf_init(sseigsf_data *,
+                         seigs_phi *,
+                         void *,
+                         const char *,
+                         bool,
+                         float,
+                         a_int);
+static void sseigsf_data_destroy(sseigsf_data *);
+static void lanczos_iterations(sseigsf_data *);
+static void iterate(sseigsf_data *);
+static void extract(sseigsf_data *);
+static eigs_fresult *prepare_result(sseigsf_data *, eigs_fresult *);
+
+
+// Eigenvalues and eigenvectors
+void sseigsf(a_int n,
+             seigs_phi *phi,
+             void *phi_data,
+             bool evs,
+             const char *which,
+             a_int k,
+             float tol,
+             a_int maxiter,
+             eigs_fresult *result) {
+
+    // Allocate memory
+    sseigsf_data *data = sseigsf_alloc(n, k);
+
+    // Initialize data
+    sseigsf_init(data,
+                 phi,
+                 phi_data,
+                 which,
+                 evs,
+                 tol,
+                 maxiter);
+
+    // Lanczos iterations
+    lanczos_iterations(data);
+
+    // Extract eigenvalues and (possibly) eigenvectors
+    extract(data);
+
+    // Prepare result
+    prepare_result(data, result);
+
+    // Clean up
+    sseigsf_data_destroy(data);
+}
+
+// Allocate memory for data
+static sseigsf_data *sseigsf_alloc(a_int n, a_int k) {
+
+    sseigsf_data *data = (sseigsf_data *)eigs_malloc(sizeof(sseigsf_data));
+    size_t nd = sizeof(float);
+
+    // Dimensions
+    data->n = n;
+    data->nev = k;
+    if ((data->ncv = 2*k+1) < 20) data->ncv = 20;
+    if (data->ncv > n) data->ncv = n;
+    data->ldv = n;
+    data->lworkl = data->ncv*(data->ncv+8);
+    data->ldz = n;
+
+    // Internal
+    data->resid = (float *)eigs_malloc(n*nd);
+    data->v = (float *)eigs_malloc((size_t)n*data->ncv*nd);
+    data->iparam = (a_int *)eigs_malloc(11*sizeof(a_int));
+    data->ipntr = (a_int *)eigs_malloc(11*sizeof(a_int));
+    data->workd = (float *)eigs_malloc(3*(size_t)n*nd);
+    data->workl = (float *)eigs_malloc(data->lworkl*nd);
+    data->select = (a_int *)eigs_malloc(data->ncv*sizeof(a_int));
+
+    // Results
+    data->d = (float *)eigs_malloc(data->nev*nd);
+    data->z = (float *)eigs_malloc((size_t)n*data->nev*nd);
+
+    return data;
+}
+
+// Bytes allocated by "sseigsf_alloc"
+size_t sseigsf_bytes(a_int n, a_int k) {
+    size_t nn = n, m = (2*k+1 < 20) ? 20 : 2*k+1, nd = sizeof(float);
+    if (m > nn) m = nn;
+    return sizeof(sseigsf_data)+(4*nn+nn*m+nn*k+m*(m+8)+k)*nd
+           +(22+m)*sizeof(a_int);
+}
+
+// Initialize eigenproblem
+static void sseigsf_init(sseigsf_data *data,
+                         seigs_phi *phi,
+                         void *phi_data,
+                         const char *which,
+                         bool evs,
+                         float tol,
+                         a_int maxiter) {
+
+    // User set
+    data->phi = phi;
+    data->which = which;
+    data->evs = evs;
+    data->tol = tol; // Default 0. (machine precision)
+    data->mxiter = maxiter; // Default 10*n
+    data->phi_data = phi_data; // Default NULL
+
+    // Internal
+    data->ido = 0;
+    data->bmat = "I";
+    memset(data->iparam, 0, 11*sizeof(a_int));
+    data->iparam[0] = 1;
+    data->iparam[2] = maxiter;
+    data->iparam[3] = 1;
+    data->iparam[6] = 1; // Regular mode
+    memset(data->ipntr, 0, 11*sizeof(a_int));
+    memset(data->select, 0, data->ncv*sizeof(a_int));
+    data->info = 0;
+}
+
+// Free for sseigsf_data type
+static void sseigsf_data_destroy(sseigsf_data *data) {
+    free(data->resid); data->resid = NULL;
+    free(data->v); data->v = NULL;
+    free(data->iparam); data->iparam = NULL;
+    free(data->ipntr); data->ipntr = NULL;
+    free(data->workd); data->workd = NULL;
+    free(data->workl); data->workl = NULL;
+    free(data->select); data->select = NULL;
+    free(data->d); data->d = NULL;
+    free(data->z); data->z = NULL;
+    free(data);
+}
+
+// Do Lanczos iterations
+static void lanczos_iterations(sseigsf_data *data) {
+
+    // Lanczos iterations
+    do {
+        iterate(data);
+    } while ((data->ido == 1) || (data->ido == -1));
+
+    // Check for errors
+    if (data->ido != 99) {
+        printf("%s\n", "SSEIGSF: LANCZOS PROCESS DID NOT CONVERGE");
+        exit(1);
+    }
+}
+
+// Do a single Lanczos iteration
+static void iterate(sseigsf_data *data) {
+
+    // Call SSAUPD
+    ssaupd_c(&data->ido,
+             data->bmat,
+             data->n,
+             data->which,
+             data->nev,
+             data->tol,
+             data->resid,
+             data->ncv,
+             data->v,
+             data->ldv,
+             data->iparam,
+             data->ipntr,
+             data->workd,
+             data->workl,
+             data->lworkl,
+             &data->info);
+
+    // Check for errors
+    int nerror = 0;
+    if ((data->ido != 1) && (data->ido != -1) && (data->ido != 99)) {
+        printf("SSEIGSF: ERROR DURING ITERATION: IDO = %d\n", data->ido);
+        nerror++;
+    }
+    if ((data->info != 0) && (data->info != 1)) {
+        printf("SSEIGSF: ERROR DURING ITERATION: INFO = %d\n", data->info);
+        nerror++;
+    }
+    if (data->info == 1) {
+        printf("%s\n", "SSEIGSF: MAXIMAL ALLOWED ITERATIONS REACHED");
+        nerror++;
+    }
+    if (nerror) exit(1);
+
+    // Compute action of phi
+    a_int xpntr = data->ipntr[0]-1;
+    a_int ypntr = data->ipntr[1]-1;
+    data->phi(data->phi_data,
+              data->n,
+              &(data->workd[xpntr]),
+              &(data->workd[ypntr]));
+}
+
+// Extract eigenvalues and (possiby) eigenvectors
+static void extract(sseigsf_data *data) {
+
+    // For internal use
+    const char *howmny = "A";
+    float sigma = 0.; // Not referenced in regular mode
+
+    // Call SSEUPD
+    sseupd_c(data->evs,
+             howmny,
+             data->select,
+             data->d,
+             data->z,
+             data->ldz,
+             sigma,
+             data->bmat,
+             data->n,
+             data->which,
+             data->nev,
+             data->tol,
+             data->resid,
+             data->ncv,
+             data->v,
+             data->ldv,
+             data->iparam,
+             data->ipntr,
+             data->workd,
+             data->workl,
+             data->lworkl,
+             &data->info);
+
+    // Check for errors
+    if (data->info) {
+        printf("SSEIGSF: COULD NOT EXTRACT RESULTS: INFO = %d\n", data->info);
+        exit(1);
+    }
+}
+
+// Load data into result and reorder it to row major
+static eigs_fresult *prepare_result(sseigsf_data *data,
+                                    eigs_fresult *result) {
+    a_int n, k, j;
+    n = data->n; k = data->nev;
+    result->n = n; result->k = k;
+    for (j=0; j<k; j++) result->eigvals[j] = CMPLXF(data->d[j], 0.);
+    if (data->evs)
+        eigs_svecs(n, k, data->z, NULL, result->eigvecs, false, false);
+    return result;
+}
@@ -0,0 +1,55 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Solver statistics: monotonic clock and ARPACK's timing common block        *
+ *                                                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <time.h>
+
+#include "../inc.d/eigs.h"
+
+
+// Seconds of a monotonic clock (arbitrary origin)
+double eigs_clock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec+1e-9*(double)ts.tv_nsec;
+}
+
+// Counters and timers of the last ARPACK solve of the calling thread ("type"
+// 's' for xSAUPD, 'n' for the real and 'c' for the complex xNAUPD) together
+// with the number of iterations and converged Ritz values of "iparam"; the
+// time of the extraction is not measured by ARPACK
+void eigs_arpack_stats(char type, const a_int *iparam, eigs_stats *stats) {
+
+    a_int counts[5];
+    float times[8];
+    arstat_c(type, counts, times);
+
+    // Counts: nopx, nbx, nrorth, nitref, nrstrt; times: xaupd, xaup2, xaitr
+    // (including the map), eigenvalues, shifts, restarts, convergence, map
+    stats->nmatvec = counts[0];
+    stats->nreorth = counts[2];
+    stats->nrestart = (iparam[2] > 1) ? iparam[2]-1 : 0;
+    stats->nconv = iparam[4];
+    stats->time_phi = times[7];
+    stats->time_orth = times[2]-times[7];
+    stats->time_restart = times[3]+times[4]+times[5]+times[6];
+}
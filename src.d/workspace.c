@@ -0,0 +1,291 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Workspace size query and memory budget                                     *
+ *                                                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#include "../inc.d/eigs.h"
+
+
+// Largest automatic subspace within a budget in units of the default one
+// (beyond, the dense work of a restart outgrows the matvecs it saves)
+#define BUDGET_GROWTH 4
+
+// Path "eigsx" takes for a problem (the same decisions in the same order)
+typedef struct _Route {
+    bool dense;            // LAPACK for all eigenvalues or a selected range
+    bool shift_invert;
+    bool filtered;         // Chebyshev filter
+    bool mixed;
+    bool schur;            // Krylov-Schur ("zg", "dg")
+    bool block;            // Block Lanczos ("zh", "ds")
+    bool zg_shift;         // "zh" with a complex shift runs "zgeigsf"
+    bool vecs;             // Eigenvectors go to a buffer of the caller
+    bool evs;              // Eigenvectors are computed
+    a_int nb;
+} route;
+
+
+static void route_init(route *,
+                       const char *,
+                       int32_t,
+                       int32_t,
+                       bool,
+                       const eigs_options *);
+static size_t dense_bytes(const route *,
+                          const char *,
+                          int32_t,
+                          int32_t,
+                          const eigs_options *);
+static size_t structured_bytes(const route *,
+                               const char *,
+                               int32_t,
+                               int32_t,
+                               const eigs_options *);
+static size_t path_bytes(const route *,
+                         const char *,
+                         void *,
+                         int32_t,
+                         int32_t,
+                         a_int,
+                         const eigs_options *);
+
+
+// Bytes "eigsx" (or "eigs_solve") allocates for the problem: workspaces,
+// result, copies, factorization and filter; the internal workspaces of
+// LAPACK, the memory of the map and a basis in a file are not included
+// ("phi_data" must be the sparse matrix with shift-invert)
+int64_t eigs_workspace_query(const char *solver,
+                             void *phi_data,
+                             int32_t n,
+                             int32_t k,
+                             bool evs,
+                             const eigs_options *opts) {
+
+    eigs_options defaults;
+    if (!opts) { eigs_options_init(&defaults); opts = &defaults; }
+
+    route r;
+    route_init(&r, solver, n, k, evs, opts);
+    a_int ncv = eigs_budget_ncv(solver, phi_data, n, k, evs, opts);
+    return (int64_t)path_bytes(&r, solver, phi_data, n, k, ncv, opts);
+}
+
+// Dimension of the subspace within the memory budget: without a budget "ncv"
+// of the options; with one the largest subspace which fits, up to "ncv" of
+// the options or, if that is automatic (0), up to BUDGET_GROWTH times the
+// default one (at most n); dense and mixed precision solvers cannot shrink
+a_int eigs_budget_ncv(const char *solver,
+                      void *phi_data,
+                      int32_t n,
+                      int32_t k,
+                      bool evs,
+                      const eigs_options *opts) {
+
+    if (opts->memory <= 0) return opts->ncv;
+
+    route r;
+    route_init(&r, solver, n, k, evs, opts);
+    size_t budget = (size_t)opts->memory, bytes;
+
+    // Nothing to choose
+    if (r.dense || r.mixed) {
+        bytes = path_bytes(&r, solver, phi_data, n, k, opts->ncv, opts);
+        if (bytes > budget) {
+            printf("EIGS: MEMORY BUDGET TOO SMALL, %lld BYTES NEEDED\n",
+                   (long long)bytes);
+            exit(1);
+        }
+        return opts->ncv;
+    }
+
+    // Subspaces (by blocks for block Lanczos) from the smallest one the
+    // solver accepts up to the requested one, or a multiple of the default
+    // one if it is automatic (spare memory buys fewer restarts)
+    a_int high, step = 1, low;
+    if (r.block) {
+        high = eigs_block_ncv(n, k, r.nb, opts->ncv);
+        if (opts->ncv <= 0)
+            high = eigs_block_ncv(n, k, r.nb, BUDGET_GROWTH*high);
+        step = r.nb;
+        low = r.nb*((k+2*r.nb-1)/r.nb);
+    } else {
+        high = eigs_ncv(n, k, opts->ncv);
+        if (opts->ncv <= 0) high = eigs_ncv(n, k, BUDGET_GROWTH*high);
+        low = (!strcmp(solver, "dg") && !r.schur) ? k+2 : k+1;
+    }
+    bytes = path_bytes(&r, solver, phi_data, n, k, low, opts);
+    if (bytes > budget) {
+        printf("EIGS: MEMORY BUDGET TOO SMALL, %lld BYTES NEEDED\n",
+               (long long)bytes);
+        exit(1);
+    }
+
+    // Largest one which fits (bisection, the bytes grow with the subspace)
+    a_int fits = 0, above = (high-low)/step+1, mid;
+    while (above-fits > 1) {
+        mid = fits+(above-fits)/2;
+        if (path_bytes(&r, solver, phi_data, n, k, low+mid*step, opts)
+            <= budget)
+            fits = mid;
+        else
+            above = mid;
+    }
+    return low+fits*step;
+}
+
+// Decisions of "eigsx" which change the allocated memory
+static void route_init(route *r,
+                       const char *solver,
+                       int32_t n,
+                       int32_t k,
+                       bool evs,
+                       const eigs_options *opts) {
+
+    if (strcmp(solver, "zg") && strcmp(solver, "dg") &&
+        strcmp(solver, "zh") && strcmp(solver, "ds")) {
+        printf("EIGS: Solver *%s* not implemented\n", solver);
+        exit(1);
+    }
+    bool hermitian = !strcmp(solver, "zh") || !strcmp(solver, "ds");
+
+    r->dense = (k == n) || (opts->range != 'A');
+    r->shift_invert = opts->shift_invert && !r->dense;
+    r->filtered = (opts->chebyshev > 0) && !r->dense && !r->shift_invert &&
+                  hermitian;
+    r->mixed = (opts->cphi || opts->sphi) && !r->dense;
+    r->block = (opts->block > 1) && !r->dense && !r->mixed && hermitian;
+    r->schur = opts->krylov_schur && !r->dense && !r->mixed;
+    if (r->schur && !strcmp(solver, "ds")) r->block = true;
+    r->nb = (opts->block > 1) ? opts->block : 1;
+    r->zg_shift = !strcmp(solver, "zh") && r->shift_invert &&
+                  (cimag(opts->sigma) != 0.);
+    r->vecs = opts->eigvecs || (opts->overwrite && (k == n) &&
+                                (opts->range == 'A') &&
+                                (opts->storage == 'F') &&
+                                !strcmp(solver, "zh"));
+    r->evs = evs || r->filtered;
+}
+
+// Bytes of the LAPACK based solvers besides the result
+static size_t dense_bytes(const route *r,
+                          const char *solver,
+                          int32_t n,
+                          int32_t k,
+                          const eigs_options *opts) {
+
+    size_t nn = n, kk = k, nz = sizeof(double complex), nd = sizeof(double);
+    size_t copy = opts->overwrite ? 0 : nn*nn;
+    bool all = (opts->range == 'A'), evs = r->evs;
+    size_t isuppz = 2*(kk+1)*sizeof(lapack_int);
+
+    if (opts->storage != 'F') return structured_bytes(r, solver, n, k, opts);
+    if (!strcmp(solver, "zg")) return copy*nz+nn*nd+(evs ? 0 : nn*nz);
+    if (!strcmp(solver, "dg")) return (copy+3*nn+(evs ? nn*nn : nn))*nd;
+    if (!strcmp(solver, "zh")) {
+        if (all) return (evs ? 0 : copy*nz)+nn*nd;
+        return copy*nz+(3*nn+(evs ? nn*kk : 0))*nd+nn*nz+isuppz
+               +((evs && !opts->colmajor) ? nn*kk*nz : 0);
+    }
+    if (all) return ((evs && opts->colmajor) ? 0 : copy*nd)+nn*nd;
+    return (copy+4*nn+(evs ? nn*kk : 0))*nd+isuppz;
+}
+
+// Bytes of the band and packed solvers besides the result (copy of the band
+// or triangle, the transformation of a band matrix for eigenvectors of a
+// range)
+static size_t structured_bytes(const route *r,
+                               const char *solver,
+                               int32_t n,
+                               int32_t k,
+                               const eigs_options *opts) {
+
+    size_t nn = n, kk = k, nz = sizeof(double complex), nd = sizeof(double);
+    bool band = (opts->storage == 'B'), evs = r->evs;
+    size_t len = band ? ((size_t)opts->kd+1)*nn : nn*(nn+1)/2;
+    size_t copy = opts->overwrite ? 0 : len;
+    size_t isuppz = 2*(kk+1)*sizeof(lapack_int);
+
+    if (!strcmp(solver, "zh")) {
+        if (opts->range == 'A') return copy*nz+nn*nd;
+        return copy*nz+(3*nn+(evs ? nn*kk : 0))*nd+isuppz
+               +(band ? (evs ? nn*nn*nz+2*nn*kk*nz : 0)
+                      : nn*nz+(evs ? nn*kk*nz : 0));
+    }
+    if (opts->range == 'A')
+        return copy*nd+nn*nd+((evs && !opts->colmajor) ? nn*nn*nd : 0);
+    return copy*nd+(3*nn+(evs ? nn*kk : 0))*nd+isuppz
+           +(band ? (evs ? nn*nn*nd+nn*kk*nd : 0) : nn*nd);
+}
+
+// Bytes of a solve with subspace dimension "ncv"
+static size_t path_bytes(const route *r,
+                         const char *solver,
+                         void *phi_data,
+                         int32_t n,
+                         int32_t k,
+                         a_int ncv,
+                         const eigs_options *opts) {
+
+    const char *dir = opts->basis_dir;
+    size_t bytes;
+
+    // Solver
+    if (r->dense) {
+        bytes = dense_bytes(r, solver, n, k, opts);
+    } else
+    if (r->mixed) {
+        bytes = eigs_mixed_bytes(solver, n, k, ncv, dir);
+    } else
+    if (!strcmp(solver, "zg")) {
+        bytes = r->schur ? zgeigsf_ks_bytes(n, k, ncv, dir)
+                         : zgeigsf_bytes(n, k, ncv, dir);
+    } else
+    if (!strcmp(solver, "dg")) {
+        bytes = r->schur ? zgeigsf_ks_bytes(n, k, ncv, dir)
+                         : dgeigsf_bytes(n, k, ncv, dir);
+    } else
+    if (r->zg_shift) {
+        bytes = zgeigsf_bytes(n, k, ncv, dir);
+    } else
+    if (r->block) {
+        bytes = zheigsf_block_bytes(n, k, r->nb, ncv, dir);
+    } else
+    if (!strcmp(solver, "zh")) {
+        bytes = zheigsf_bytes(n, k, ncv, dir);
+    } else {
+        bytes = dseigsf_bytes(n, k, ncv, dir);
+    }
+
+    // Result
+    bytes += sizeof(eigs_result)+(size_t)k*sizeof(double complex);
+    if (r->evs && !r->vecs) bytes += (size_t)n*k*sizeof(double complex);
+
+    // Filter set up before the result, factorization next to both
+    if (r->filtered)
+        bytes = eigs_chebyshev_bytes(n, k, !strcmp(solver, "zh"), bytes);
+    if (r->shift_invert) {
+        if (!phi_data) {
+            printf("%s\n", "EIGS: SHIFT-INVERT NEEDS A SPARSE MATRIX");
+            exit(1);
+        }
+        bytes += eigs_factor_bytes((eigs_sparse *)phi_data, opts->sigma);
+    }
+
+    return bytes;
+}
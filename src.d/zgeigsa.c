@@ -22,43 +22,84 @@
 #include "../inc.d/eigs.h"
 
 
-// Eigenvalues and eigenvectors
+// Eigenvalues and eigenvectors (the row-major input read as column-major is
+// the transposed matrix, whose left eigenvectors are the complex conjugated
+// right eigenvectors of the matrix)
 void zgeigsa(uint32_t n,
              const double complex *phi,
              bool evs,
+             const eigs_options *opts,
              eigs_result *result) {
 
-    // Copy matrix
-    double complex *phi_cpy, *eigvecs;
-    phi_cpy = (double complex *)malloc(n*n*sizeof(double complex));
-    for (uint32_t i=0; i<n*n; i++) phi_cpy[i] = phi[i];
+    bool overwrite = opts->overwrite, colmajor = opts->colmajor;
 
-    // Check if eigenvectors are desired
-    if (evs) {
-        eigvecs = result->eigvecs;
+    // Work in the input or in a copy
+    double complex *a;
+    if (overwrite) {
+        a = (double complex *)phi;
     } else {
-        eigvecs = (double complex *)malloc(n*n*sizeof(double complex));
+        a = (double complex *)malloc((size_t)n*n*sizeof(double complex));
+        memcpy(a, phi, (size_t)n*n*sizeof(double complex));
     }
 
+    // Eigenvalues only: balancing, Hessenberg reduction and the eigenvalues
+    // of the Schur form (LAPACK's ZGEBAL, ZGEHRD and ZHSEQR), no Schur
+    // vectors are accumulated and nothing is transformed back
+    double *scale = (double *)malloc(n*sizeof(double));
+    lapack_int info, ilo, ihi;
+    if (!evs) {
+        double complex *tau;
+        tau = (double complex *)malloc(n*sizeof(double complex));
+        info = LAPACKE_zgebal(LAPACK_COL_MAJOR, opts->balance, n, a, n, &ilo,
+                              &ihi, scale);
+        if (!info) info = LAPACKE_zgehrd(LAPACK_COL_MAJOR, n, ilo, ihi, a, n,
+                                         tau);
+        if (info) {
+            printf("EIGS: HESSENBERG REDUCTION FAILED: INFO = %d\n", info);
+            exit(1);
+        }
+        info = LAPACKE_zhseqr(LAPACK_COL_MAJOR, 'E', 'N', n, ilo, ihi, a, n,
+                              result->eigvals, NULL, 1);
+        if (info) {
+            printf("%s\n", "EIGS: LAPACKE_zhseqr did not converge"); exit(1);
+        }
+        free(tau); free(scale);
+        if (!overwrite) free(a);
+        return;
+    }
 
-    // Solve eigenproblem using LAPACK
-    lapack_int info = LAPACKE_zgeev(LAPACK_ROW_MAJOR,
-                                    'N',
-                                    'V',
-                                    n,
-                                    phi_cpy,
-                                    n,
-                                    result->eigvals,
-                                    NULL,
-                                    1,
-                                    eigvecs,
-                                    n);
+    // Solve eigenproblem using LAPACK (left eigenvectors of the transposed
+    // matrix)
+    double abnrm;
+    info = LAPACKE_zgeevx(LAPACK_COL_MAJOR,
+                          opts->balance,
+                          'V',
+                          'N',
+                          'N',
+                          n,
+                          a,
+                          n,
+                          result->eigvals,
+                          result->eigvecs,
+                          n,
+                          NULL,
+                          1,
+                          &ilo,
+                          &ihi,
+                          scale,
+                          &abnrm,
+                          NULL,
+                          NULL);
 
     // Check result
     if (info) {
-        printf("%s\n", "EIGS: LAPACKE_zgeev did not converge"); exit(1);
+        printf("%s\n", "EIGS: LAPACKE_zgeevx did not converge"); exit(1);
     }
 
+    // Eigenvectors
+    eigs_zvecs(n, n, result->eigvecs, result->eigvecs, colmajor, true);
+
     // Clean up
-    free(phi_cpy); if (!evs) free(eigvecs);
+    free(scale);
+    if (!overwrite) free(a);
 }
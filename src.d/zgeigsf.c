@@ -35,6 +35,8 @@ typedef struct _ZgeigsfData {
     double tol;
     a_int ncv;
     a_int mxiter;
+    a_int mode;
+    a_dcomplex sigma;
 
     // Internal
     a_int ido;
@@ -51,6 +53,7 @@ typedef struct _ZgeigsfData {
     a_int info;
     a_int ldz;
     a_dcomplex *workev;
+    a_int *select;
 
     // Results
     a_dcomplex *d;
@@ -59,19 +62,24 @@ typedef struct _ZgeigsfData {
 } zgeigsf_data;
 
 
-static zgeigsf_data *zgeigsf_init(a_int,
-                                  zeigs_phi *,
-                                  void *,
-                                  a_int,
-                                  const char *,
-                                  bool,
-                                  double,
-                                  a_int);
+static zgeigsf_data *zgeigsf_alloc(a_int,
+                                   a_int,
+                                   a_int,
+                                   const char *);
+static void zgeigsf_init(zgeigsf_data *,
+                         zeigs_phi *,
+                         void *,
+                         const char *,
+                         bool,
+                         double,
+                         a_int,
+                         a_int,
+                         a_dcomplex);
 static void zgeigsf_data_destroy(zgeigsf_data *);
 static void arnoldi_iterations(zgeigsf_data *);
 static void iterate(zgeigsf_data *);
-static void extract(zgeigsf_data *);
-static eigs_result *prepare_result(zgeigsf_data *, eigs_result *);
+static void extract(zgeigsf_data *, a_dcomplex *);
+static eigs_result *prepare_result(zgeigsf_data *, eigs_result *, bool);
 
 
 // Eigenvalues and eigenvectors
@@ -81,95 +89,147 @@ void zgeigsf(a_int n,
              bool evs,
              const char *which,
              a_int k,
+             a_int ncv,
              double tol,
              a_int maxiter,
+             a_int mode,
+             a_dcomplex sigma,
+             bool colmajor,
+             const char *basis_dir,
+             void **work,
              eigs_result *result) {
 
+    // Workspace (kept in "*work" for further solves if "work" is not NULL
+    // and neither the dimension of the subspace nor the storage of the basis
+    // change)
+    zgeigsf_data *data = work ? (zgeigsf_data *)*work : NULL;
+    if (data && ((data->ncv != eigs_ncv(n, k, ncv)) ||
+                 (eigs_basis_mapped(data->v) != (basis_dir != NULL)))) {
+        zgeigsf_data_destroy(data);
+        data = NULL;
+    }
+    if (!data) data = zgeigsf_alloc(n, k, ncv, basis_dir);
+    if (work) *work = data;
+
     // Initialize data
-    zgeigsf_data *data = zgeigsf_init(n,
-                                      phi,
-                                      phi_data,
-                                      k,
-                                      which,
-                                      evs,
-                                      tol,
-                                      maxiter);
+    zgeigsf_init(data,
+                 phi,
+                 phi_data,
+                 which,
+                 evs,
+                 tol,
+                 maxiter,
+                 mode,
+                 sigma);
 
     // Arnoldi iterations
     arnoldi_iterations(data);
+    eigs_arpack_stats('c', data->iparam, &result->stats);
 
-    // Extract eigenvalues and (possibly) eigenvectors
-    extract(data);
+    // Extract eigenvalues and (possibly) eigenvectors, column-major ones
+    // directly into the result
+    double t = eigs_clock();
+    extract(data, (evs && colmajor) ? result->eigvecs : data->z);
 
     // Prepare result
-    prepare_result(data, result);
+    prepare_result(data, result, colmajor);
+    result->stats.time_extract = eigs_clock()-t;
 
     // Clean up
-    zgeigsf_data_destroy(data);
+    if (!work) zgeigsf_data_destroy(data);
+}
+
+// Free workspace kept by "zgeigsf"
+void zgeigsf_free(void *work) {
+    if (work) zgeigsf_data_destroy((zgeigsf_data *)work);
+}
+
+// Allocate memory for data (nothing is zeroed, ARPACK does not need it)
+static zgeigsf_data *zgeigsf_alloc(a_int n, a_int k, a_int ncv,
+                                   const char *basis_dir) {
+
+    zgeigsf_data *data = (zgeigsf_data *)eigs_malloc(sizeof(zgeigsf_data));
+    size_t nz = sizeof(a_dcomplex);
+
+    // Dimensions
+    data->n = n;
+    data->nev = k;
+    data->ncv = eigs_ncv(n, k, ncv);
+    data->ldv = n;
+    data->lworkl = 3*data->ncv*(data->ncv+2);
+    data->ldz = n;
+
+    // Internal
+    data->resid = (a_dcomplex *)eigs_malloc(n*nz);
+    data->v = (a_dcomplex *)eigs_basis_alloc((size_t)n*data->ncv*nz, basis_dir);
+    data->iparam = (a_int *)eigs_malloc(11*sizeof(a_int));
+    data->ipntr = (a_int *)eigs_malloc(14*sizeof(a_int));
+    data->workd = (a_dcomplex *)eigs_malloc(3*(size_t)n*nz);
+    data->workl = (a_dcomplex *)eigs_malloc(data->lworkl*nz);
+    data->rwork = (double *)eigs_malloc(data->ncv*sizeof(double));
+    data->workev = (a_dcomplex *)eigs_malloc(3*data->ncv*nz);
+    data->select = (a_int *)eigs_malloc(data->ncv*sizeof(a_int));
+
+    // Results
+    data->d = (a_dcomplex *)eigs_malloc((data->nev+1)*nz);
+    data->z = (a_dcomplex *)eigs_malloc((size_t)n*data->nev*nz);
+
+    return data;
+}
+
+// Bytes allocated by "zgeigsf_alloc"
+size_t zgeigsf_bytes(a_int n, a_int k, a_int ncv, const char *basis_dir) {
+    size_t nn = n, m = eigs_ncv(n, k, ncv), nz = sizeof(a_dcomplex);
+    return sizeof(zgeigsf_data)+(4*nn+nn*k+3*m*(m+2)+3*m+k+1)*nz
+           +m*sizeof(double)+(25+m)*sizeof(a_int)
+           +eigs_basis_bytes(nn*m*nz, basis_dir);
 }
 
 // Initialize eigenproblem
-static zgeigsf_data *zgeigsf_init(a_int n,
-                                  zeigs_phi *phi,
-                                  void *phi_data,
-                                  a_int k,
-                                  const char *which,
-                                  bool evs,
-                                  double tol,
-                                  a_int maxiter) {
-
-    // Allocate memory for data
-    zgeigsf_data *data = (zgeigsf_data *)malloc(sizeof(zgeigsf_data));
+static void zgeigsf_init(zgeigsf_data *data,
+                         zeigs_phi *phi,
+                         void *phi_data,
+                         const char *which,
+                         bool evs,
+                         double tol,
+                         a_int maxiter,
+                         a_int mode,
+                         a_dcomplex sigma) {
 
     // User set
-    data->n = n;
     data->phi = phi;
-    data->nev = k;
     data->which = which;
     data->evs = evs;
     data->tol = tol; // Default 0. (machine precision)
     data->mxiter = maxiter; // Default 10*n
     data->phi_data = phi_data; // Default NULL
+    data->mode = mode; // 1 (regular) or 3 (shift-invert, phi is the inverse)
+    data->sigma = sigma; // Only referenced if mode is 3
 
     // Internal
     data->ido = 0;
     data->bmat = "I";
-    data->resid = (a_dcomplex *)malloc(n*sizeof(a_dcomplex));
-    if ((data->ncv = 2*k+1) < 20) data->ncv = 20;
-    if (data->ncv > n) data->ncv = n;
-    data->v = (a_dcomplex *)calloc(n*data->ncv, sizeof(a_dcomplex));
-    data->ldv = n;
-    data->iparam = (a_int *)calloc(11, sizeof(a_int));
+    memset(data->iparam, 0, 11*sizeof(a_int));
     data->iparam[0] = 1;
     data->iparam[2] = maxiter;
     data->iparam[3] = 1;
-    data->iparam[6] = 1;
-    data->ipntr = (a_int *)calloc(14, sizeof(a_int));
-    data->workd = (a_dcomplex *)calloc(3*n, sizeof(a_dcomplex));
-    data->lworkl = 3*data->ncv*(data->ncv+2);
-    data->workl = (a_dcomplex *)calloc(data->lworkl, sizeof(a_dcomplex));
-    data->rwork = (double *)calloc(data->ncv, sizeof(double));
+    data->iparam[6] = mode;
+    memset(data->ipntr, 0, 14*sizeof(a_int));
+    memset(data->select, 0, data->ncv*sizeof(a_int));
     data->info = 0;
-    data->ldz = n;
-    data->workev = (a_dcomplex *)calloc(3*data->ncv, sizeof(a_dcomplex));
-
-    // Results
-    data->d = (a_dcomplex *)calloc(data->nev+1, sizeof(a_dcomplex));
-    data->z = (a_dcomplex *)calloc(n*data->nev, sizeof(a_dcomplex));
-
-    return data;
 }
 
 // Free for zeigsf_data type
 static void zgeigsf_data_destroy(zgeigsf_data *data) {
     free(data->resid); data->resid = NULL;
-    free(data->v); data->v = NULL;
+    eigs_basis_free(data->v); data->v = NULL;
     free(data->iparam); data->iparam = NULL;
     free(data->ipntr); data->ipntr = NULL;
     free(data->workd); data->workd = NULL;
     free(data->workl); data->workl = NULL;
     free(data->rwork); data->rwork = NULL;
     free(data->workev); data->workev = NULL;
+    free(data->select); data->select = NULL;
     free(data->d); data->d = NULL;
     free(data->z); data->z = NULL;
     free(data);
@@ -238,19 +298,18 @@ static void iterate(zgeigsf_data *data) {
 }
 
 // Extract eigenvalues and (possiby) eigenvectors
-static void extract(zgeigsf_data *data) {
+static void extract(zgeigsf_data *data, a_dcomplex *z) {
 
     // For internal use
-    const char *howmny = "A"; if (data->evs) howmny = "P";
-    a_int *select = (a_int *)calloc(data->ncv, sizeof(a_int));
-    a_dcomplex sigma = CMPLX(0., 0.); // Not referenced
+    const char *howmny = "A"; // Ritz vectors (not Schur vectors)
+    a_dcomplex sigma = data->sigma; // Only referenced in mode 3
 
     // Call ZNEUPD
     zneupd_c(data->evs,
              howmny,
-             select,
+             data->select,
              data->d,
-             data->z,
+             z,
              data->ldz,
              sigma,
              data->workev,
@@ -271,9 +330,6 @@ static void extract(zgeigsf_data *data) {
              data->rwork,
              &data->info);
 
-    // Clean up
-    free(select);
-
     // Check for errors
     if (data->info) {
         printf("ZEIGSF: COULD NOT EXTRACT RESULTS: INFO = %d\n", data->info);
@@ -281,20 +337,15 @@ static void extract(zgeigsf_data *data) {
     }
 }
 
-// Load data into result and reorder it to row major
-static eigs_result *prepare_result(zgeigsf_data *data, eigs_result *result) {
-    a_int n, k, i, j, count;
-    n = data->n; k = data->nev; count = 0;
+// Load data into result (eigenvectors row-major unless "colmajor")
+static eigs_result *prepare_result(zgeigsf_data *data,
+                                   eigs_result *result,
+                                   bool colmajor) {
+    a_int n, k, j;
+    n = data->n; k = data->nev;
     result->n = n; result->k = k;
     for (j=0; j<k; j++) result->eigvals[j] = data->d[j];
-    if (data->evs) {
-        for (i=0; i<n; i++) {
-            for (j=0; j<k; j++) {
-                result->eigvecs[count++] = data->z[n*j+i];
-            }
-        }
-    } else {
-        result->eigvecs = NULL;
-    }
+    if (data->evs && !colmajor)
+        eigs_zvecs(n, k, data->z, result->eigvecs, false, false);
     return result;
 }
@@ -15,24 +15,70 @@
  * -------------------------------------------------------------------------- *
  *                                                                            *
  * LAPACK based solver for all double complex eigenvalues/-vectors of a       *
- * hermitian matrix                                                           *
+ * hermitian matrix (full, band or packed storage)                            *
  *                                                                            *
  * -------------------------------------------------------------------------- */
 
 
+#include <math.h>
+
 #include "../inc.d/eigs.h"
 
 
-// Eigenvalues and eigenvectors
+static void selection(uint32_t,
+                      double complex *,
+                      bool,
+                      const eigs_options *,
+                      eigs_result *);
+static void structured(uint32_t,
+                       const double complex *,
+                       bool,
+                       const eigs_options *,
+                       eigs_result *);
+static double *tridiagonal(uint32_t,
+                           double *,
+                           double *,
+                           bool,
+                           const eigs_options *,
+                           eigs_result *);
+static lapack_int count_below(uint32_t, const double *, const double *,
+                              double);
+
+
+// Eigenvalues and eigenvectors (the row-major input read as column-major is
+// the complex conjugated matrix, which has conjugated eigenvectors)
 void zheigsa(uint32_t n,
              const double complex *phi,
              bool evs,
+             const eigs_options *opts,
              eigs_result *result) {
 
-    // Copy matrix
-    double complex *phi_cpy;
-    phi_cpy = (double complex *)malloc(n*n*sizeof(double complex));
-    for (uint32_t i=0; i<n*n; i++) phi_cpy[i] = phi[i];
+    bool overwrite = opts->overwrite, colmajor = opts->colmajor;
+    bool all = (opts->range == 'A');
+
+    // Band or packed storage
+    if (opts->storage != 'F') {
+        structured(n, phi, evs, opts, result);
+        return;
+    }
+
+    // Work in the input, in the eigenvector buffer (all eigenvectors) or in
+    // a copy
+    double complex *a;
+    if (overwrite) {
+        a = (double complex *)phi;
+    } else {
+        if (evs && all) a = result->eigvecs;
+        else a = (double complex *)malloc((size_t)n*n*sizeof(double complex));
+        memcpy(a, phi, (size_t)n*n*sizeof(double complex));
+    }
+
+    // Selected eigenvalues only
+    if (!all) {
+        selection(n, a, evs, opts, result);
+        if (!overwrite) free(a);
+        return;
+    }
 
     // Check if eigenvectors are desired
     char jobz;
@@ -42,28 +88,237 @@ void zheigsa(uint32_t n,
         jobz = 'N';
     }
 
-    // Solve eigenproblem using LAPACK
+    // Solve eigenproblem using LAPACK (divide and conquer)
     uint32_t i;
     double *eigvals = (double *)malloc(n*sizeof(double));
-    lapack_int info = LAPACKE_zheev(LAPACK_ROW_MAJOR,
-                                    jobz,
-                                    'U',
-                                    n,
-                                    phi_cpy,
-                                    n,
-                                    eigvals);
+    lapack_int info = LAPACKE_zheevd(LAPACK_COL_MAJOR,
+                                     jobz,
+                                     'L',
+                                     n,
+                                     a,
+                                     n,
+                                     eigvals);
     for (i=0; i<n; i++) result->eigvals[i] = CMPLX(eigvals[i], 0.);
 
     // Check result
     if (info) {
-        printf("%s\n", "EIGS: LAPACKE_zheev did not converge"); exit(1);
+        printf("%s\n", "EIGS: LAPACKE_zheevd did not converge"); exit(1);
     }
 
     // Check if eigenvectors are desired
-    if (evs) {
-        for (uint32_t i=0; i<n*n; i++) result->eigvecs[i] = phi_cpy[i];
+    if (evs) eigs_zvecs(n, n, a, result->eigvecs, colmajor, true);
+
+    // Clean up
+    if (!overwrite && !evs) free(a);
+    free(eigvals);
+}
+
+// Eigenvalues il,...,il+k-1 (range 'I') or at most k eigenvalues in
+// [vl, vu) (range 'V') by MRRR: reduction to a real tridiagonal matrix,
+// eigenpairs of the tridiagonal matrix and back transformation of only the
+// selected eigenvectors
+static void selection(uint32_t n,
+                      double complex *a,
+                      bool evs,
+                      const eigs_options *opts,
+                      eigs_result *result) {
+
+    lapack_int info, m;
+
+    double *d = (double *)malloc(n*sizeof(double));
+    double *e = (double *)malloc(n*sizeof(double));
+    double complex *tau = (double complex *)malloc(n*sizeof(double complex));
+
+    // Householder reduction (LAPACK's ZHETRD)
+    info = LAPACKE_zhetrd(LAPACK_COL_MAJOR, 'L', n, a, n, d, e, tau);
+    if (info) {
+        printf("EIGS: LAPACKE_zhetrd FAILED: INFO = %d\n", info); exit(1);
+    }
+    double *z = tridiagonal(n, d, e, evs, opts, result);
+    m = result->k;
+
+    // Back transformation (LAPACK's ZUNMTR), column-major eigenvectors
+    // directly in the result
+    if (evs && m) {
+        double complex *c = result->eigvecs;
+        if (!opts->colmajor)
+            c = (double complex *)malloc((size_t)n*m*sizeof(double complex));
+        for (int64_t p=0; p<(int64_t)n*m; p++) c[p] = CMPLX(z[p], 0.);
+        info = LAPACKE_zunmtr(LAPACK_COL_MAJOR, 'L', 'L', 'N', n, m, a, n,
+                              tau, c, n);
+        if (info) {
+            printf("EIGS: LAPACKE_zunmtr FAILED: INFO = %d\n", info);
+            exit(1);
+        }
+        eigs_zvecs(n, m, c, result->eigvecs, opts->colmajor, true);
+        if (!opts->colmajor) free(c);
     }
 
     // Clean up
-    free(phi_cpy); free(eigvals);
+    free(d); free(e); free(tau); free(z);
+}
+
+// Band ('B', upper triangle, row i holds the elements i,...,i+kd) or packed
+// ('P', upper triangle row by row) matrix, read as column-major lower
+// triangle of the complex conjugated matrix: all eigenvalues by divide and
+// conquer, a range by the reduction of the band or packed matrix and MRRR
+static void structured(uint32_t n,
+                       const double complex *phi,
+                       bool evs,
+                       const eigs_options *opts,
+                       eigs_result *result) {
+
+    bool band = (opts->storage == 'B');
+    lapack_int kd = opts->kd, info, m, ldz = evs ? n : 1;
+    size_t len = band ? (size_t)(kd+1)*n : (size_t)n*(n+1)/2;
+
+    // Work in the input or in a copy of the band or triangle
+    double complex *a;
+    if (opts->overwrite) {
+        a = (double complex *)phi;
+    } else {
+        a = (double complex *)malloc(len*sizeof(double complex));
+        memcpy(a, phi, len*sizeof(double complex));
+    }
+
+    // All eigenvalues (LAPACK's ZHBEVD or ZHPEVD), eigenvectors directly in
+    // the result
+    if (opts->range == 'A') {
+        double *w = (double *)malloc(n*sizeof(double));
+        double complex *z = evs ? result->eigvecs : NULL;
+        if (band)
+            info = LAPACKE_zhbevd(LAPACK_COL_MAJOR, evs ? 'V' : 'N', 'L', n,
+                                  kd, a, kd+1, w, z, ldz);
+        else
+            info = LAPACKE_zhpevd(LAPACK_COL_MAJOR, evs ? 'V' : 'N', 'L', n,
+                                  a, w, z, ldz);
+        if (info) {
+            printf("EIGS: LAPACKE_%s did not converge\n",
+                   band ? "zhbevd" : "zhpevd");
+            exit(1);
+        }
+        for (uint32_t i=0; i<n; i++) result->eigvals[i] = CMPLX(w[i], 0.);
+        if (evs) eigs_zvecs(n, n, z, result->eigvecs, opts->colmajor, true);
+        if (!opts->overwrite) free(a);
+        free(w);
+        return;
+    }
+
+    // Reduction to a real tridiagonal matrix (LAPACK's ZHBTRD, which forms
+    // the n x n transformation for eigenvectors, or ZHPTRD)
+    double *d = (double *)malloc(n*sizeof(double));
+    double *e = (double *)malloc(n*sizeof(double));
+    double complex *q = NULL, *tau = NULL;
+    if (band) {
+        if (evs)
+            q = (double complex *)malloc((size_t)n*n*sizeof(double complex));
+        info = LAPACKE_zhbtrd(LAPACK_COL_MAJOR, evs ? 'V' : 'N', 'L', n, kd,
+                              a, kd+1, d, e, q, ldz);
+    } else {
+        tau = (double complex *)malloc(n*sizeof(double complex));
+        info = LAPACKE_zhptrd(LAPACK_COL_MAJOR, 'L', n, a, d, e, tau);
+    }
+    if (info) {
+        printf("EIGS: LAPACKE_%s FAILED: INFO = %d\n",
+               band ? "zhbtrd" : "zhptrd", info);
+        exit(1);
+    }
+    double *z = tridiagonal(n, d, e, evs, opts, result);
+    m = result->k;
+
+    // Back transformation (a product with the transformation or LAPACK's
+    // ZUPMTR)
+    if (evs && m) {
+        double complex *c = (double complex *)malloc((size_t)n*m
+                                                     *sizeof(double complex));
+        for (int64_t p=0; p<(int64_t)n*m; p++) c[p] = CMPLX(z[p], 0.);
+        if (band) {
+            double complex one = 1., zero = 0.;
+            double complex *qc = (double complex *)malloc((size_t)n*m
+                                                  *sizeof(double complex));
+            cblas_zgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n, m, n,
+                        &one, q, n, c, n, &zero, qc, n);
+            free(c); c = qc;
+        } else {
+            info = LAPACKE_zupmtr(LAPACK_COL_MAJOR, 'L', 'L', 'N', n, m, a,
+                                  tau, c, n);
+            if (info) {
+                printf("EIGS: LAPACKE_zupmtr FAILED: INFO = %d\n", info);
+                exit(1);
+            }
+        }
+        eigs_zvecs(n, m, c, result->eigvecs, opts->colmajor, true);
+        free(c);
+    }
+
+    // Clean up
+    if (!opts->overwrite) free(a);
+    free(d); free(e); free(q); free(tau); free(z);
+}
+
+// Eigenvalues il,...,il+k-1 or those in [vl, vu) of the tridiagonal matrix
+// (d, e) into the result (LAPACK's DSTEMR), returns the n x result->k
+// eigenvectors (NULL without eigenvectors)
+static double *tridiagonal(uint32_t n,
+                           double *d,
+                           double *e,
+                           bool evs,
+                           const eigs_options *opts,
+                           eigs_result *result) {
+
+    int32_t k = result->k;
+    lapack_int il = opts->il+1, iu = opts->il+k, m, nzc = k, j;
+    lapack_logical tryrac = 1;
+    lapack_int info;
+
+    // The interval becomes the index range of its eigenvalues
+    if (opts->range == 'V') {
+        il = count_below(n, d, e, opts->vl)+1;
+        iu = count_below(n, d, e, opts->vu);
+        nzc = iu-il+1;
+        if (nzc > k) {
+            printf("EIGS: %d EIGENVALUES IN [VL, VU), K = %d IS TOO SMALL\n",
+                   nzc, k);
+            exit(1);
+        }
+    }
+
+    // Eigenpairs of the tridiagonal matrix
+    double *w = (double *)malloc(n*sizeof(double));
+    double *z = NULL;
+    if (evs) z = (double *)malloc((size_t)n*(nzc ? nzc : 1)*sizeof(double));
+    lapack_int *isuppz = (lapack_int *)malloc(2*(nzc+1)*sizeof(lapack_int));
+    m = 0; info = 0;
+    if (nzc > 0)
+        info = LAPACKE_dstemr(LAPACK_COL_MAJOR, evs ? 'V' : 'N', 'I', n, d,
+                              e, 0., 0., il, iu, &m, w, z, evs ? n : 1, nzc,
+                              isuppz, &tryrac);
+    if (info) {
+        printf("EIGS: LAPACKE_dstemr FAILED: INFO = %d\n", info); exit(1);
+    }
+    result->k = m;
+    for (j=0; j<m; j++) result->eigvals[j] = CMPLX(w[j], 0.);
+
+    free(w); free(isuppz);
+    return z;
+}
+
+// Number of eigenvalues of the tridiagonal matrix (d, e) below x (Sturm
+// count, i.e. negative pivots of the LDL^T factorization of T - x I)
+static lapack_int count_below(uint32_t n,
+                              const double *d,
+                              const double *e,
+                              double x) {
+
+    const double tiny = 1e-300;
+    lapack_int count = 0;
+    double q = 1.;
+
+    for (uint32_t i=0; i<n; i++) {
+        q = d[i]-x-((i > 0) ? e[i-1]*e[i-1]/q : 0.);
+        if (fabs(q) < tiny) q = -tiny;
+        if (q < 0.) count++;
+    }
+
+    return count;
 }
@@ -0,0 +1,465 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Thick-restart Lanczos solver for a few eigenvalues/-vectors of a hermitian *
+ * double complex endomorphism                                                *
+ * -------------------------------------------------------------------------- */
+
+
+#include <math.h>
+
+#include "../inc.d/eigs.h"
+
+
+// Data for internal usage
+typedef struct _ZheigsfData {
+
+    // User set
+    a_int n;
+    zeigs_phi *phi;
+    void *phi_data;
+    a_int nev;
+    const char *which;
+    bool evs;
+    double tol;
+    a_int ncv;
+    a_int nkeep_restart; // Number of Ritz vectors kept at restart
+    a_int mxiter;
+    a_int mode;
+    double sigma;
+
+    // Internal
+    a_dcomplex *v;      // Lanczos basis, n x (ncv+1), column-major
+    a_dcomplex *w;      // Work vector of length n
+    a_dcomplex *h;      // Projection coefficients of length ncv+1
+    a_dcomplex *c;      // Reorthogonalization coefficients of length ncv+1
+    a_dcomplex *tmp;    // Buffer for basis rotations, EIGS_ROTATE_ROWS x
+                        // ncv
+    a_dcomplex *yc;     // Selected Ritz vectors of t as complex, ncv x ncv
+    double *t;          // Projected (real symmetric) matrix, ncv x ncv
+    double *y;          // Eigenvectors of t, ncv x ncv
+    double *theta;      // Ritz values, length ncv
+    a_int *order;       // Ritz values ordered by "which"
+    double beta;        // Norm of the residual vector
+    a_int nkeep;        // Number of Ritz vectors kept (zero at the start)
+    a_int nconv;
+    a_int iter;
+    a_int iseed[4];
+    double eps;
+    eigs_stats stats;   // Counters and timers
+
+    // Results
+    double *d;
+    a_dcomplex *z;
+
+} zheigsf_data;
+
+
+static zheigsf_data *zheigsf_alloc(a_int,
+                                   a_int,
+                                   a_int,
+                                   const char *);
+static void zheigsf_init(zheigsf_data *,
+                         zeigs_phi *,
+                         void *,
+                         const char *,
+                         bool,
+                         double,
+                         a_int,
+                         a_int,
+                         a_int,
+                         double);
+static void zheigsf_data_destroy(zheigsf_data *);
+static void lanczos_iterations(zheigsf_data *);
+static void expand(zheigsf_data *);
+static void orthogonalize(zheigsf_data *, a_int);
+static void ritz(zheigsf_data *);
+static void restart(zheigsf_data *);
+static void extract(zheigsf_data *, a_dcomplex *);
+static eigs_result *prepare_result(zheigsf_data *, eigs_result *, bool);
+
+
+// Eigenvalues and eigenvectors
+void zheigsf(a_int n,
+             zeigs_phi *phi,
+             void *phi_data,
+             bool evs,
+             const char *which,
+             a_int k,
+             a_int ncv,
+             a_int nkeep,
+             double tol,
+             a_int maxiter,
+             a_int mode,
+             double sigma,
+             bool colmajor,
+             const char *basis_dir,
+             void **work,
+             eigs_result *result) {
+
+    // Workspace (kept in "*work" for further solves if "work" is not NULL
+    // and neither the dimension of the subspace nor the storage of the basis
+    // change)
+    zheigsf_data *data = work ? (zheigsf_data *)*work : NULL;
+    if (data && ((data->ncv != eigs_ncv(n, k, ncv)) ||
+                 (eigs_basis_mapped(data->v) != (basis_dir != NULL)))) {
+        zheigsf_data_destroy(data);
+        data = NULL;
+    }
+    if (!data) data = zheigsf_alloc(n, k, ncv, basis_dir);
+    if (work) *work = data;
+
+    // Initialize data
+    zheigsf_init(data,
+                 phi,
+                 phi_data,
+                 which,
+                 evs,
+                 tol,
+                 nkeep,
+                 maxiter,
+                 mode,
+                 sigma);
+
+    // Lanczos iterations
+    lanczos_iterations(data);
+    result->stats = data->stats;
+
+    // Extract eigenvalues and (possibly) eigenvectors, column-major ones
+    // directly into the result
+    double t = eigs_clock();
+    extract(data, (evs && colmajor) ? result->eigvecs : data->z);
+
+    // Prepare result
+    prepare_result(data, result, colmajor);
+    result->stats.time_extract = eigs_clock()-t;
+
+    // Clean up
+    if (!work) zheigsf_data_destroy(data);
+}
+
+// Free workspace kept by "zheigsf"
+void zheigsf_free(void *work) {
+    if (work) zheigsf_data_destroy((zheigsf_data *)work);
+}
+
+// Allocate memory for data
+static zheigsf_data *zheigsf_alloc(a_int n, a_int k, a_int ncv,
+                                   const char *basis_dir) {
+
+    zheigsf_data *data = (zheigsf_data *)eigs_malloc(sizeof(zheigsf_data));
+    size_t nz = sizeof(a_dcomplex), nd = sizeof(double);
+
+    // Dimensions
+    data->n = n;
+    data->nev = k;
+    data->ncv = eigs_ncv(n, k, ncv);
+    a_int m = data->ncv;
+
+    // Internal
+    data->v = (a_dcomplex *)eigs_basis_alloc((size_t)n*(m+1)*nz, basis_dir);
+    data->w = (a_dcomplex *)eigs_malloc(n*nz);
+    data->h = (a_dcomplex *)eigs_malloc((m+1)*nz);
+    data->c = (a_dcomplex *)eigs_malloc((m+1)*nz);
+    data->tmp = (a_dcomplex *)eigs_malloc(EIGS_ROTATE_ROWS*m*nz);
+    data->yc = (a_dcomplex *)eigs_malloc(m*m*nz);
+    data->t = (double *)eigs_malloc(m*m*nd);
+    data->y = (double *)eigs_malloc(m*m*nd);
+    data->theta = (double *)eigs_malloc(m*nd);
+    data->order = (a_int *)eigs_malloc(m*sizeof(a_int));
+
+    // Results
+    data->d = (double *)eigs_malloc(data->nev*nd);
+    data->z = (a_dcomplex *)eigs_malloc((size_t)n*data->nev*nz);
+
+    return data;
+}
+
+// Bytes allocated by "zheigsf_alloc"
+size_t zheigsf_bytes(a_int n, a_int k, a_int ncv, const char *basis_dir) {
+    size_t nn = n, m = eigs_ncv(n, k, ncv);
+    size_t nz = sizeof(a_dcomplex), nd = sizeof(double);
+    return sizeof(zheigsf_data)
+           +(nn+2*(m+1)+EIGS_ROTATE_ROWS*m+m*m+nn*k)*nz
+           +(2*m*m+m+k)*nd+m*sizeof(a_int)
+           +eigs_basis_bytes(nn*(m+1)*nz, basis_dir);
+}
+
+// Initialize eigenproblem
+static void zheigsf_init(zheigsf_data *data,
+                         zeigs_phi *phi,
+                         void *phi_data,
+                         const char *which,
+                         bool evs,
+                         double tol,
+                         a_int nkeep,
+                         a_int maxiter,
+                         a_int mode,
+                         double sigma) {
+
+    // Check which
+    if (strcmp(which, "LA") && strcmp(which, "LR") &&
+        strcmp(which, "SA") && strcmp(which, "SR") &&
+        strcmp(which, "LM") && strcmp(which, "SM")) {
+        printf("ZHEIGSF: WHICH = %s NOT SUPPORTED\n", which);
+        exit(1);
+    }
+
+    // User set
+    data->phi = phi;
+    data->which = which;
+    data->evs = evs;
+    data->eps = LAPACKE_dlamch('E');
+    data->tol = (tol > 0.) ? tol : data->eps; // Default machine precision
+    data->nkeep_restart = eigs_nkeep(data->nev, data->ncv, nkeep);
+    data->mxiter = maxiter; // Default 10*n
+    data->phi_data = phi_data; // Default NULL
+    data->mode = mode; // 1 (regular) or 3 (shift-invert, phi is the inverse)
+    data->sigma = sigma; // Only referenced if mode is 3
+
+    // Internal (only the projected matrix has to start out as zero)
+    memset(data->t, 0, data->ncv*data->ncv*sizeof(double));
+    data->beta = 0.;
+    data->nkeep = 0;
+    data->nconv = 0;
+    data->iter = 0;
+    memset(&data->stats, 0, sizeof(eigs_stats));
+    data->iseed[0] = 1; data->iseed[1] = 3;
+    data->iseed[2] = 5; data->iseed[3] = 7;
+
+    // Random starting vector
+    eigs_basis_random(data->v, data->n, 0, data->iseed, data->w, data->c,
+                      NULL, NULL);
+}
+
+// Free for zheigsf_data type
+static void zheigsf_data_destroy(zheigsf_data *data) {
+    eigs_basis_free(data->v); data->v = NULL;
+    free(data->w); data->w = NULL;
+    free(data->h); data->h = NULL;
+    free(data->c); data->c = NULL;
+    free(data->tmp); data->tmp = NULL;
+    free(data->yc); data->yc = NULL;
+    free(data->t); data->t = NULL;
+    free(data->y); data->y = NULL;
+    free(data->theta); data->theta = NULL;
+    free(data->order); data->order = NULL;
+    free(data->d); data->d = NULL;
+    free(data->z); data->z = NULL;
+    free(data);
+}
+
+// Do thick-restart Lanczos iterations
+static void lanczos_iterations(zheigsf_data *data) {
+
+    double t;
+
+    for (data->iter=1; data->iter<=data->mxiter; data->iter++) {
+
+        // Extend the basis to ncv vectors
+        expand(data);
+
+        // Ritz values and their residuals
+        t = eigs_clock();
+        ritz(data);
+        data->stats.nconv = data->nconv;
+        if (data->nconv >= data->nev) {
+            data->stats.time_restart += eigs_clock()-t;
+            return;
+        }
+
+        // Keep the best Ritz vectors and start over
+        restart(data);
+        data->stats.nrestart++;
+        data->stats.time_restart += eigs_clock()-t;
+    }
+
+    printf("%s\n", "ZHEIGSF: MAXIMAL ALLOWED ITERATIONS REACHED");
+    exit(1);
+}
+
+// Lanczos steps nkeep,...,ncv-1 (with full reorthogonalization)
+static void expand(zheigsf_data *data) {
+
+    a_int n = data->n, m = data->ncv, j;
+    double alpha, t0 = eigs_clock(), t, tphi = 0.;
+
+    for (j=data->nkeep; j<m; j++) {
+
+        // Compute action of phi
+        t = eigs_clock();
+        data->phi(data->phi_data, n, &data->v[(size_t)n*j], data->w);
+        tphi += eigs_clock()-t;
+        data->stats.nmatvec++;
+
+        // Orthogonalize against v_0,...,v_j
+        orthogonalize(data, j+1);
+        data->stats.nreorth++;
+        alpha = creal(data->h[j]);
+        data->t[m*j+j] = alpha;
+
+        // Next basis vector (norm and scaled copy in two passes)
+        data->beta = eigs_znrm2_scale(n, data->w, &data->v[(size_t)n*(j+1)],
+                                      data->eps*fabs(alpha));
+        if (data->beta <= data->eps*fabs(alpha)) {
+            // Invariant subspace found, continue with a random vector
+            data->beta = 0.;
+            if (j+1 < n)
+                eigs_basis_random(data->v, n, j+1, data->iseed, data->w,
+                                  data->c, NULL, NULL);
+        }
+        if (j+1 < m) data->t[m*j+j+1] = data->t[m*(j+1)+j] = data->beta;
+    }
+    data->stats.time_phi += tphi;
+    data->stats.time_orth += eigs_clock()-t0-tphi;
+}
+
+// Classical Gram-Schmidt with one reorthogonalization (CGS2) of w against
+// the first "nv" basis vectors, the coefficients are stored in h
+static void orthogonalize(zheigsf_data *data, a_int nv) {
+
+    a_int n = data->n, i;
+    const a_dcomplex one = CMPLX(1., 0.), mone = CMPLX(-1., 0.);
+    const a_dcomplex zero = CMPLX(0., 0.);
+
+    // First pass: h = V^H w, w = w - V h
+    cblas_zgemv(CblasColMajor, CblasConjTrans, n, nv, &one, data->v, n,
+                data->w, 1, &zero, data->h, 1);
+    cblas_zgemv(CblasColMajor, CblasNoTrans, n, nv, &mone, data->v, n,
+                data->h, 1, &one, data->w, 1);
+
+    // Second pass: c = V^H w, w = w - V c, h = h + c
+    cblas_zgemv(CblasColMajor, CblasConjTrans, n, nv, &one, data->v, n,
+                data->w, 1, &zero, data->c, 1);
+    cblas_zgemv(CblasColMajor, CblasNoTrans, n, nv, &mone, data->v, n,
+                data->c, 1, &one, data->w, 1);
+    for (i=0; i<nv; i++) data->h[i] += data->c[i];
+}
+
+// Ritz values, ordering by "which" and number of converged Ritz values
+static void ritz(zheigsf_data *data) {
+
+    a_int m = data->ncv, i, j, l;
+    double eps23 = pow(data->eps, 2./3.), res, tol;
+    const char *which = data->which;
+
+    // Eigenvalues (ascending) and eigenvectors of t
+    memcpy(data->y, data->t, m*m*sizeof(double));
+    lapack_int info = LAPACKE_dsyev(LAPACK_COL_MAJOR, 'V', 'U', m, data->y,
+                                    m, data->theta);
+    if (info) {
+        printf("ZHEIGSF: LAPACKE_dsyev FAILED: INFO = %d\n", info);
+        exit(1);
+    }
+
+    // Order by which (insertion sort, ncv is small)
+    for (i=0; i<m; i++) {
+        if (!strcmp(which, "LA") || !strcmp(which, "LR"))
+            data->order[i] = m-1-i;
+        else
+            data->order[i] = i;
+    }
+    if (!strcmp(which, "LM") || !strcmp(which, "SM")) {
+        bool largest = !strcmp(which, "LM");
+        for (i=1; i<m; i++) {
+            l = data->order[i];
+            for (j=i; j>0; j--) {
+                double a = fabs(data->theta[data->order[j-1]]);
+                double b = fabs(data->theta[l]);
+                if (largest ? (a >= b) : (a <= b)) break;
+                data->order[j] = data->order[j-1];
+            }
+            data->order[j] = l;
+        }
+    }
+
+    // Converged wanted Ritz values (same criterion as ARPACK)
+    data->nconv = 0;
+    for (i=0; i<data->nev; i++) {
+        l = data->order[i];
+        res = fabs(data->beta*data->y[m*l+m-1]);
+        tol = data->tol*fmax(eps23, fabs(data->theta[l]));
+        if (res <= tol) data->nconv++;
+    }
+}
+
+// Thick restart with the nkeep most wanted Ritz vectors
+static void restart(zheigsf_data *data) {
+
+    a_int n = data->n, m = data->ncv, nkeep, i, r, l;
+    double s;
+
+    // Number of kept Ritz vectors
+    nkeep = data->nkeep_restart;
+
+    // Rotate basis: (v_0,...,v_nkeep-1) = V Y_kept
+    for (i=0; i<nkeep; i++) {
+        l = data->order[i];
+        for (r=0; r<m; r++) data->yc[m*i+r] = CMPLX(data->y[m*l+r], 0.);
+    }
+    eigs_basis_rotate(data->v, data->n, 0, m, nkeep, data->yc, m,
+                      data->tmp);
+
+    // The residual vector becomes v_nkeep
+    memcpy(&data->v[(size_t)n*nkeep], &data->v[(size_t)n*m],
+           n*sizeof(a_dcomplex));
+
+    // Projected matrix is diagonal plus an arrow in row/column nkeep
+    memset(data->t, 0, m*m*sizeof(double));
+    for (i=0; i<nkeep; i++) {
+        l = data->order[i];
+        s = data->beta*data->y[m*l+m-1];
+        data->t[m*i+i] = data->theta[l];
+        data->t[m*i+nkeep] = data->t[m*nkeep+i] = s;
+    }
+    data->nkeep = nkeep;
+}
+
+// Extract eigenvalues and (possiby) eigenvectors
+static void extract(zheigsf_data *data, a_dcomplex *z) {
+
+    a_int n = data->n, m = data->ncv, i, r, l;
+    const a_dcomplex one = CMPLX(1., 0.), zero = CMPLX(0., 0.);
+
+    for (i=0; i<data->nev; i++) data->d[i] = data->theta[data->order[i]];
+
+    // Shift-invert: theta = 1/(lambda-sigma)
+    if (data->mode == 3)
+        for (i=0; i<data->nev; i++) data->d[i] = data->sigma+1./data->d[i];
+
+    if (data->evs) {
+        for (i=0; i<data->nev; i++) {
+            l = data->order[i];
+            for (r=0; r<m; r++) data->yc[m*i+r] = CMPLX(data->y[m*l+r], 0.);
+        }
+        cblas_zgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, n,
+                    data->nev, m, &one, data->v, n, data->yc, m, &zero,
+                    z, n);
+    }
+}
+
+// Load data into result (eigenvectors row-major unless "colmajor")
+static eigs_result *prepare_result(zheigsf_data *data,
+                                   eigs_result *result,
+                                   bool colmajor) {
+    a_int n, k, j;
+    n = data->n; k = data->nev;
+    result->n = n; result->k = k;
+    for (j=0; j<k; j++) result->eigvals[j] = CMPLX(data->d[j], 0.);
+    if (data->evs && !colmajor)
+        eigs_zvecs(n, k, data->z, result->eigvecs, false, false);
+    return result;
+}
@@ -0,0 +1,138 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Regression test of the distributed solver (run on 3 processes)             *
+ *                                                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <unistd.h>
+
+#include "../inc.d/eigs_mpi.h"
+
+
+// Dimension, eigenvalues, accuracy and time limit (a deadlock fails)
+#define TEST_N 300
+#define TEST_K 6
+#define TEST_TOL 1e-9
+#define TEST_SECONDS 60
+
+
+// Slice of the operator on a process
+typedef struct {
+    MPI_Comm comm;
+    int32_t off;
+} slice_data;
+
+
+static int32_t rows(int, int);
+static double diag(int32_t);
+static double ua(int32_t);
+static double ub(int32_t);
+static void dphi_dist(void *, int32_t, const double *, double *);
+static void dphi_serial(void *, int32_t, const double *, double *);
+
+
+// Non-symmetric real operator D+a*b^T-b*a^T with complex eigenvalues, its
+// dot products are collective; process 1 holds no rows, i.e. its slices of
+// the complex basis never have an imaginary part while those of the others do
+int main(int argc, char **argv) {
+
+    int rank, size, r;
+    int32_t j, l;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    alarm(TEST_SECONDS);
+
+    // Rows: none on process 1, equal parts on the others
+    int32_t nloc = rows(rank, size), off = 0;
+    for (r=0; r<rank; r++) off += rows(r, size);
+    slice_data data = { MPI_COMM_WORLD, off };
+
+    eigs_options opts;
+    eigs_options_init(&opts);
+    eigs_result *dist = eigs_mpi(MPI_COMM_WORLD, "dg", NULL, dphi_dist, &data,
+                                 nloc, TEST_K, "LM", 0, -1., false, &opts);
+    eigs_result *serial = eigsx("dg", NULL, dphi_serial, NULL, NULL, NULL,
+                                TEST_N, TEST_K, "LM", 0, -1., false, &opts);
+
+    // Same eigenvalues, some of them complex
+    bool ok = (dist->stats.nconv == TEST_K), complex_pair = false;
+    for (l=0; l<TEST_K; l++) {
+        bool found = false;
+        for (j=0; j<TEST_K; j++)
+            if (cabs(dist->eigvals[j]-serial->eigvals[l])
+                <= TEST_TOL*cabs(serial->eigvals[0]))
+                found = true;
+        if (!found) ok = false;
+        if (cimag(serial->eigvals[l]) != 0.) complex_pair = true;
+    }
+    if (!complex_pair) ok = false;
+    eigs_result_free(dist);
+    eigs_result_free(serial);
+
+    int failed = !ok, nfailed;
+    MPI_Allreduce(&failed, &nfailed, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    if (!rank)
+        printf("%-40s %s\n", "mpi dg LM empty slice", nfailed ? "FAILED"
+                                                              : "ok");
+    MPI_Finalize();
+
+    return nfailed ? 1 : 0;
+}
+
+
+// Rows of process r of "size" processes (process 1 holds none)
+static int32_t rows(int r, int size) {
+    int32_t others = (size > 1) ? size-1 : 1, part = r ? r-1 : 0;
+    if (r == 1) return 0;
+    return TEST_N/others+(part < TEST_N%others);
+}
+
+// Diagonal and the vectors of the skew-symmetric part
+static double diag(int32_t i) { return 1.+(double)i/TEST_N; }
+static double ua(int32_t i) { return .2*cos(.1*i); }
+static double ub(int32_t i) { return .2*sin(.3*i+1.); }
+
+// The operator on the local slice (dot products summed over all processes)
+static void dphi_dist(void *data, int32_t n, const double *x, double *y) {
+    slice_data *s = (slice_data *)data;
+    double dot[2] = { 0., 0. };
+    for (int32_t i=0; i<n; i++) {
+        dot[0] += ua(s->off+i)*x[i];
+        dot[1] += ub(s->off+i)*x[i];
+    }
+    MPI_Allreduce(MPI_IN_PLACE, dot, 2, MPI_DOUBLE, MPI_SUM, s->comm);
+    for (int32_t i=0; i<n; i++)
+        y[i] = diag(s->off+i)*x[i]+ua(s->off+i)*dot[1]-ub(s->off+i)*dot[0];
+}
+
+// The same operator on a single process (reference)
+static void dphi_serial(void *data, int32_t n, const double *x, double *y) {
+    double dot[2] = { 0., 0. };
+    (void)data;
+    for (int32_t i=0; i<n; i++) {
+        dot[0] += ua(i)*x[i];
+        dot[1] += ub(i)*x[i];
+    }
+    for (int32_t i=0; i<n; i++)
+        y[i] = diag(i)*x[i]+ua(i)*dot[1]-ub(i)*dot[0];
+}
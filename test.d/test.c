@@ -0,0 +1,1191 @@
+/* -------------------------------------------------------------------------- *
+ *                                                                            *
+ * This file is part of the EIGS C-library by Simon Euchner.                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * LICENSE: GPL-3.0                                                           *
+ *                                                                            *
+ * IMPORTANT: THIS IS FREE SOFTWARE WITHOUT ANY WARRANTY. THE USER IS FREE TO *
+ *            MODIFY AND REDISTRIBUTE THIS SOFTWARE UNDER THE TERMS OF THE    *
+ *            LICENSE LISTED ABOVE PUBLISHED BY THE FREE SOFTWARE FOUNDATION. *
+ *            THE PUBLISHER, SIMON EUCHNER, IS NOT RESPONSIBLE FOR ANY        *
+ *            NEGATIVE EFFECTS THIS SOFTWARE MAY CAUSE.                       *
+ *                                                                            *
+ * -------------------------------------------------------------------------- *
+ *                                                                            *
+ * Regression tests: solvers on operators with known spectra                  *
+ *                                                                            *
+ * -------------------------------------------------------------------------- */
+
+
+#include <math.h>
+
+#include "../inc.d/eigs.h"
+
+
+// Accuracy of the eigenvalues (relative to the norm of the operator)
+#define TEST_TOL 1e-9
+
+
+// A test
+typedef struct {
+    const char *name;
+    bool (*run)(void);
+} test_case;
+
+
+static bool mixed_small_ds(void);
+static bool mixed_small_zh(void);
+static bool mixed_small_dg(void);
+static bool mixed_small(const char *, const char *);
+static bool mixed_random(void);
+static bool block_ds(void);
+static bool block_zh(void);
+static bool block_default(const char *);
+static bool budget_ncv(void);
+static bool sinvert_pairs(void);
+static bool sinvert_interior(void);
+static bool batch_zh(void);
+static bool batch_ds(void);
+static bool batch_dense(const char *);
+static bool sparse_lap1d(void);
+static bool chebyshev_lap1d(void);
+static bool context_lap1d(void);
+static bool layout_buffers(void);
+static bool dense_range(void);
+static bool float_lap1d(void);
+static bool krylov_schur(void);
+static bool basis_file(void);
+static bool kron_sum(void);
+static bool sectors_chains(void);
+static bool slice_lap1d(void);
+static bool band_packed(void);
+static bool dense_eigvals(void);
+static bool check(const eigs_result *, int32_t, const char *);
+static double lap1d_eigval(int32_t, int32_t);
+static eigs_sparse *rotations(int32_t);
+static double dresidual(const eigs_result *, deigs_phi *, void *);
+static void *random_hermitian(int32_t, bool, uint32_t *);
+static double dense_residual(const eigs_result *, const double complex *,
+                             const double *);
+static double uniform(uint32_t *);
+static void lap1d_zphi(void *, int32_t, const double complex *,
+                       double complex *);
+static void lap1d_dphi(void *, int32_t, const double *, double *);
+static void lap1d_cphi(void *, int32_t, const float complex *,
+                       float complex *);
+static void lap1d_sphi(void *, int32_t, const float *, float *);
+static void dense_zphi(void *, int32_t, const double complex *,
+                       double complex *);
+static void dense_dphi(void *, int32_t, const double *, double *);
+static void dense_cphi(void *, int32_t, const float complex *,
+                       float complex *);
+static void dense_sphi(void *, int32_t, const float *, float *);
+
+static eigs_sparse *lap1d_sparse(int32_t, bool, bool);
+static int compare_doubles(const void *, const void *);
+
+static const test_case tests[] = {
+    { "mixed ds SA small eigenvalues", mixed_small_ds },
+    { "mixed zh SA small eigenvalues", mixed_small_zh },
+    { "mixed dg LR",                   mixed_small_dg },
+    { "mixed dg, zg random nonsymmetric", mixed_random },
+    { "block ds nb = 2, 3, 4 defaults", block_ds },
+    { "block zh nb = 2, 3, 4 defaults", block_zh },
+    { "memory budget ncv",              budget_ncv },
+    { "shift-invert dg complex pairs",  sinvert_pairs },
+    { "shift-invert ds, zh interior", sinvert_interior },
+    { "batch zh against single solves", batch_zh },
+    { "batch ds against single solves", batch_ds },
+    { "sparse ds, zh full and half storage", sparse_lap1d },
+    { "chebyshev ds, zh SA and LA", chebyshev_lap1d },
+    { "context ds, zh two solves", context_lap1d },
+    { "colmajor buffer, overwritten matrix", layout_buffers },
+    { "dense zh, ds ranges I and V", dense_range },
+    { "float ss, ch, sg, cg", float_lap1d },
+    { "krylov-schur zg, dg against ARPACK", krylov_schur },
+    { "basis in a file zh, ds, zg, dg", basis_file },
+    { "kron ds, zh sum of Laplacians", kron_sum },
+    { "sectors zh, ds two chains", sectors_chains },
+    { "slice ds, zh interval and inertia", slice_lap1d },
+    { "dense zh, ds band and packed storage", band_packed },
+    { "dense zg, dg eigenvalues only", dense_eigvals }
+};
+#define NTESTS (int32_t)(sizeof(tests)/sizeof(tests[0]))
+
+
+int main(void) {
+
+    int32_t t, nfailed = 0;
+
+    for (t=0; t<NTESTS; t++) {
+        printf("%-40s ", tests[t].name);
+        fflush(stdout);
+        bool ok = tests[t].run();
+        printf("%s\n", ok ? "ok" : "FAILED");
+        if (!ok) nfailed++;
+    }
+    printf("%d of %d tests failed\n", nfailed, NTESTS);
+
+    return nfailed;
+}
+
+
+/* --- Mixed precision ------------------------------------------------------ */
+
+// Eigenvalues far below the norm of the operator (default tolerance)
+static bool mixed_small_ds(void) { return mixed_small("ds", "SA"); }
+static bool mixed_small_zh(void) { return mixed_small("zh", "SA"); }
+static bool mixed_small_dg(void) { return mixed_small("dg", "LR"); }
+
+static bool mixed_small(const char *solver, const char *which) {
+
+    int32_t n = 400, k = 6;
+    bool complex_solver = (solver[0] == 'z');
+    eigs_options opts;
+    eigs_options_init(&opts);
+    opts.cphi = lap1d_cphi;
+    opts.sphi = lap1d_sphi;
+
+    eigs_result *result = eigsx(solver,
+                                complex_solver ? lap1d_zphi : NULL,
+                                complex_solver ? NULL : lap1d_dphi,
+                                NULL, NULL, NULL, n, k, which, 0, -1., false,
+                                &opts);
+    bool ok = check(result, k, which);
+    eigs_result_free(result);
+
+    return ok;
+}
+
+
+// Random nonsymmetric matrix, the refinement stalls and a double Krylov-Schur
+// solve takes over
+static bool mixed_random(void) {
+
+    const char *solvers[] = { "dg", "dg", "zg" };
+    const char *which[] = { "LM", "LR", "LM" };
+    int32_t n = 300, k = 5, s, i;
+    bool ok = true;
+    uint32_t seed = 1;
+    double *a = (double *)malloc((size_t)n*n*sizeof(double));
+    float *af = (float *)malloc((size_t)n*n*sizeof(float));
+    eigs_options opts;
+    eigs_options_init(&opts);
+    opts.cphi = dense_cphi;
+    opts.sphi = dense_sphi;
+    opts.fphi_data = af;
+
+    for (i=0; i<n*n; i++) af[i] = (float)(a[i] = uniform(&seed));
+    for (s=0; s<3; s++) {
+        bool complex_solver = (solvers[s][0] == 'z');
+        eigs_result *result = eigsx(solvers[s],
+                                    complex_solver ? dense_zphi : NULL,
+                                    complex_solver ? NULL : dense_dphi,
+                                    NULL, NULL, a, n, k, which[s], 0, -1.,
+                                    true, &opts);
+        if ((result->stats.nconv < k) ||
+            (dense_residual(result, NULL, a) > TEST_TOL))
+            ok = false;
+        eigs_result_free(result);
+    }
+    free(a); free(af);
+
+    return ok;
+}
+
+
+/* --- Block Lanczos -------------------------------------------------------- */
+
+// Block sizes > 1 with the default subspace converge with at most twice the
+// matvecs of the single vector solver
+static bool block_ds(void) { return block_default("ds"); }
+static bool block_zh(void) { return block_default("zh"); }
+
+static bool block_default(const char *solver) {
+
+    int32_t n = 400, k = 6, nb;
+    bool complex_solver = (solver[0] == 'z'), ok = true;
+    eigs_options opts;
+    eigs_options_init(&opts);
+
+    eigs_result *result = eigsx("zh", lap1d_zphi, NULL, NULL, NULL, NULL, n,
+                                k, "SA", 0, -1., false, &opts);
+    int64_t single = result->stats.nmatvec;
+    eigs_result_free(result);
+
+    for (nb=2; nb<=4; nb++) {
+        opts.block = nb;
+        result = eigsx(solver,
+                       complex_solver ? lap1d_zphi : NULL,
+                       complex_solver ? NULL : lap1d_dphi,
+                       NULL, NULL, NULL, n, k, "SA", 0, -1., false, &opts);
+        if (!check(result, k, "SA") || (result->stats.nmatvec > 2*single))
+            ok = false;
+        eigs_result_free(result);
+    }
+
+    return ok;
+}
+
+
+/* --- Memory budget -------------------------------------------------------- */
+
+// A budget fits the workspaces, spare memory grows an automatic subspace but
+// not a requested one
+static bool budget_ncv(void) {
+
+    const char *solvers[] = { "zg", "dg", "zh", "ds" };
+    int32_t n = 3000, k = 10, s;
+    bool ok = true;
+    eigs_options opts;
+    eigs_options_init(&opts);
+
+    for (s=0; s<4; s++) {
+        opts.memory = 0; opts.ncv = 0;
+        int64_t unlimited = eigs_workspace_query(solvers[s], NULL, n, k,
+                                                 true, &opts);
+        opts.memory = 2*unlimited;
+        int64_t grown = eigs_workspace_query(solvers[s], NULL, n, k, true,
+                                             &opts);
+        opts.memory = (9*unlimited)/10;
+        int64_t shrunk = eigs_workspace_query(solvers[s], NULL, n, k, true,
+                                              &opts);
+        opts.ncv = 30; opts.memory = 0;
+        int64_t requested = eigs_workspace_query(solvers[s], NULL, n, k,
+                                                 true, &opts);
+        opts.memory = 4*requested;
+        int64_t kept = eigs_workspace_query(solvers[s], NULL, n, k, true,
+                                            &opts);
+        if ((grown <= unlimited) || (grown > 2*unlimited) ||
+            (shrunk > (9*unlimited)/10) || (kept != requested))
+            ok = false;
+    }
+
+    return ok;
+}
+
+
+/* --- Shift-invert -------------------------------------------------------- */
+
+// Eigenvectors of complex conjugate pairs close to the shift, also if k
+// splits a pair
+static bool sinvert_pairs(void) {
+
+    int32_t n = 200, k;
+    bool ok = true;
+    eigs_sparse *a = rotations(n);
+    eigs_options opts;
+    eigs_options_init(&opts);
+    opts.shift_invert = true;
+    opts.sigma = CMPLX(.1793, 0.);
+
+    for (k=5; k<=6; k++) {
+        eigs_result *result = eigsx("dg", NULL, eigs_sparse_dphi, NULL, NULL,
+                                    a, n, k, "LM", 0, -1., true, &opts);
+        if ((result->stats.nconv < k) ||
+            (dresidual(result, eigs_sparse_dphi, a) > TEST_TOL))
+            ok = false;
+        eigs_result_free(result);
+    }
+    eigs_sparse_free(a);
+
+    return ok;
+}
+
+// The eigenvalues closest to a shift in the interior of the spectrum
+static bool sinvert_interior(void) {
+
+    int32_t n = 400, k = 6, c, j, l;
+    bool ok = true;
+    double *dist = (double *)malloc(n*sizeof(double));
+    eigs_options opts;
+    eigs_options_init(&opts);
+    opts.shift_invert = true;
+    opts.sigma = CMPLX(1.3, 0.);
+
+    for (l=0; l<n; l++) dist[l] = fabs(lap1d_eigval(n, l)-1.3);
+    qsort(dist, n, sizeof(double), compare_doubles);
+    for (c=0; c<2; c++) {
+        eigs_sparse *a = lap1d_sparse(n, false, c);
+        eigs_result *result = eigsx(c ? "zh" : "ds",
+                                    c ? eigs_sparse_zphi : NULL,
+                                    c ? NULL : eigs_sparse_dphi,
+                                    NULL, NULL, a, n, k, "LM", 0, -1., true,
+                                    &opts);
+        if (result->stats.nconv < k) ok = false;
+        for (j=0; j<k; j++) {
+            double lambda = creal(result->eigvals[j]);
+            bool found = false;
+            for (l=0; l<n; l++)
+                if (fabs(lambda-lap1d_eigval(n, l)) <= 4.*TEST_TOL)
+                    found = true;
+            if (!found || (fabs(lambda-1.3) > dist[k-1]+TEST_TOL))
+                ok = false;
+        }
+        if (!c && (dresidual(result, eigs_sparse_dphi, a) > TEST_TOL))
+            ok = false;
+        eigs_result_free(result);
+        eigs_sparse_free(a);
+    }
+    free(dist);
+
+    return ok;
+}
+
+
+/* --- Batched dense solver ------------------------------------------------ */
+
+// Batch results agree with single dense solves and are eigenpairs
+static bool batch_zh(void) { return batch_dense("zh"); }
+static bool batch_ds(void) { return batch_dense("ds"); }
+
+static bool batch_dense(const char *solver) {
+
+    int32_t n[3] = { 12, 40, 25 }, count = 3, i, j;
+    bool complex_values = (solver[0] == 'z'), ok = true;
+    uint32_t seed = 1;
+    void *a[3];
+
+    for (i=0; i<count; i++) a[i] = random_hermitian(n[i], complex_values,
+                                                    &seed);
+    eigs_result *batch = eigs_batch(solver,
+        complex_values ? (const double complex *const *)a : NULL,
+        complex_values ? NULL : (const double *const *)a, n, count, true);
+
+    for (i=0; i<count; i++) {
+        const double complex *za = complex_values ? a[i] : NULL;
+        const double *da = complex_values ? NULL : a[i];
+        eigs_result *single = eigs(solver, NULL, NULL, za, da, NULL, n[i],
+                                   n[i], "LM", 0, -1., true);
+        for (j=0; j<n[i]; j++)
+            if (cabs(batch[i].eigvals[j]-single->eigvals[j]) > TEST_TOL)
+                ok = false;
+        if (dense_residual(&batch[i], za, da) > TEST_TOL) ok = false;
+        eigs_result_free(single);
+        free(a[i]);
+    }
+    eigs_batch_free(batch);
+
+    return ok;
+}
+
+
+/* --- Sparse matrices ----------------------------------------------------- */
+
+// The built-in sparse matrix in full and half storage, real and complex (a
+// gauge transformed Laplacian with the same spectrum)
+static bool sparse_lap1d(void) {
+
+    int32_t n = 400, k = 6, c, h;
+    bool ok = true;
+
+    for (c=0; c<2; c++) {
+        for (h=0; h<2; h++) {
+            eigs_sparse *a = lap1d_sparse(n, h, c);
+            eigs_result *result = eigs(c ? "zh" : "ds",
+                                       c ? eigs_sparse_zphi : NULL,
+                                       c ? NULL : eigs_sparse_dphi,
+                                       NULL, NULL, a, n, k, "SA", 0, -1.,
+                                       false);
+            if (!check(result, k, "SA")) ok = false;
+            eigs_result_free(result);
+            eigs_sparse_free(a);
+        }
+    }
+
+    return ok;
+}
+
+
+/* --- Chebyshev filter ---------------------------------------------------- */
+
+// Both ends of the spectrum with a degree 20 filter, real and complex
+static bool chebyshev_lap1d(void) {
+
+    const char *which[] = { "SA", "LA" };
+    int32_t n = 400, k = 6, c, w;
+    bool ok = true;
+    eigs_options opts;
+    eigs_options_init(&opts);
+    opts.chebyshev = 20;
+
+    for (c=0; c<2; c++) {
+        for (w=0; w<2; w++) {
+            eigs_result *result = eigsx(c ? "zh" : "ds",
+                                        c ? lap1d_zphi : NULL,
+                                        c ? NULL : lap1d_dphi,
+                                        NULL, NULL, NULL, n, k, which[w], 0,
+                                        -1., true, &opts);
+            if (!check(result, k, which[w])) ok = false;
+            eigs_result_free(result);
+        }
+    }
+
+    return ok;
+}
+
+
+/* --- Reusable context ---------------------------------------------------- */
+
+// Two solves on the workspaces of one context (the results belong to it)
+static bool context_lap1d(void) {
+
+    const char *which[] = { "SA", "LA" };
+    int32_t n = 400, k = 6, c, w;
+    bool ok = true;
+
+    for (c=0; c<2; c++) {
+        eigs_context *ctx = eigs_context_init(c ? "zh" : "ds", n, k);
+        for (w=0; w<2; w++) {
+            eigs_result *result = eigs_solve(ctx,
+                                             c ? lap1d_zphi : NULL,
+                                             c ? NULL : lap1d_dphi,
+                                             NULL, NULL, NULL, which[w], 0,
+                                             -1., true, NULL);
+            if (!check(result, k, which[w])) ok = false;
+        }
+        eigs_context_free(ctx);
+    }
+
+    return ok;
+}
+
+
+/* --- Layout of the eigenvectors ------------------------------------------ */
+
+// Column-major eigenvectors in a buffer of the caller, and the eigenvectors
+// of a full hermitian problem in the overwritten input matrix
+static bool layout_buffers(void) {
+
+    int32_t n = 400, k = 6, m = 50, i, j;
+    bool ok = true;
+    uint32_t seed = 2;
+    double complex *buf = (double complex *)malloc((size_t)n*k
+                                                   *sizeof(double complex));
+    eigs_options opts;
+    eigs_options_init(&opts);
+    opts.colmajor = true;
+    opts.eigvecs = buf;
+
+    eigs_result *result = eigsx("ds", NULL, lap1d_dphi, NULL, NULL, NULL, n,
+                                k, "SA", 0, -1., true, &opts);
+    eigs_result rows = *result;
+    rows.eigvecs = (double complex *)malloc((size_t)n*k
+                                            *sizeof(double complex));
+    for (j=0; j<k; j++)
+        for (i=0; i<n; i++)
+            rows.eigvecs[(int64_t)k*i+j] = buf[(int64_t)n*j+i];
+    if (!check(result, k, "SA") || (result->eigvecs != buf) ||
+        !result->borrowed || (dresidual(&rows, lap1d_dphi, NULL) > TEST_TOL))
+        ok = false;
+    eigs_result_free(result);
+    free(rows.eigvecs); free(buf);
+
+    double complex *a = random_hermitian(m, true, &seed);
+    double complex *copy = (double complex *)malloc((size_t)m*m
+                                                    *sizeof(double complex));
+    memcpy(copy, a, (size_t)m*m*sizeof(double complex));
+    eigs_options_init(&opts);
+    opts.overwrite = true;
+    result = eigsx("zh", NULL, NULL, a, NULL, NULL, m, m, "LM", 0, -1., true,
+                   &opts);
+    if ((result->eigvecs != a) || !result->borrowed ||
+        (dense_residual(result, copy, NULL) > TEST_TOL))
+        ok = false;
+    eigs_result_free(result);
+    free(a); free(copy);
+
+    return ok;
+}
+
+
+/* --- Dense ranges -------------------------------------------------------- */
+
+// Eigenvalues 10,...,14 and those in an interval around 21,...,27 agree
+// with the full spectrum and are eigenpairs
+static bool dense_range(void) {
+
+    int32_t m = 60, c, j;
+    bool ok = true;
+    uint32_t seed = 3;
+    eigs_options opts;
+
+    for (c=0; c<2; c++) {
+        const char *solver = c ? "zh" : "ds";
+        void *a = random_hermitian(m, c, &seed);
+        const double complex *za = c ? a : NULL;
+        const double *da = c ? NULL : a;
+        eigs_result *full = eigs(solver, NULL, NULL, za, da, NULL, m, m, "LM",
+                                 0, -1., false);
+
+        eigs_options_init(&opts);
+        opts.range = 'I';
+        opts.il = 10;
+        eigs_result *result = eigsx(solver, NULL, NULL, za, da, NULL, m, 5,
+                                    "LM", 0, -1., true, &opts);
+        for (j=0; j<5; j++)
+            if (cabs(result->eigvals[j]-full->eigvals[10+j]) > TEST_TOL)
+                ok = false;
+        if (dense_residual(result, za, da) > TEST_TOL) ok = false;
+        eigs_result_free(result);
+
+        opts.range = 'V';
+        opts.vl = .5*creal(full->eigvals[20]+full->eigvals[21]);
+        opts.vu = .5*creal(full->eigvals[27]+full->eigvals[28]);
+        result = eigsx(solver, NULL, NULL, za, da, NULL, m, m, "LM", 0, -1.,
+                       true, &opts);
+        if (result->k != 7) ok = false;
+        for (j=0; (j<7) && (j<result->k); j++)
+            if (cabs(result->eigvals[j]-full->eigvals[21+j]) > TEST_TOL)
+                ok = false;
+        if (dense_residual(result, za, da) > TEST_TOL) ok = false;
+        eigs_result_free(result);
+        eigs_result_free(full);
+        free(a);
+    }
+
+    return ok;
+}
+
+
+/* --- Single precision ---------------------------------------------------- */
+
+// The four float solvers on the 1D Laplacian (about 6 digits)
+static bool float_lap1d(void) {
+
+    const char *solvers[] = { "ss", "ch", "sg", "cg" };
+    const char *which[] = { "SA", "SR", "LR", "LM" };
+    int32_t n = 200, k = 4, s, j, l;
+    bool ok = true;
+
+    for (s=0; s<4; s++) {
+        bool complex_solver = (solvers[s][0] == 'c');
+        eigs_fresult *result = eigs_float(solvers[s],
+                                          complex_solver ? lap1d_cphi : NULL,
+                                          complex_solver ? NULL : lap1d_sphi,
+                                          NULL, NULL, NULL, n, k, which[s],
+                                          0, 0.f, false);
+        for (l=0; l<k; l++) {
+            double exact = lap1d_eigval(n, (which[s][0] == 'S') ? l
+                                                                : n-1-l);
+            bool found = false;
+            for (j=0; j<k; j++)
+                if (fabs(crealf(result->eigvals[j])-exact) <= 1e-4)
+                    found = true;
+            if (!found) ok = false;
+        }
+        eigs_fresult_free(result);
+    }
+
+    return ok;
+}
+
+
+/* --- Krylov-Schur --------------------------------------------------------- */
+
+// Largest real parts of the 1D Laplacian, and the conjugate pairs of the
+// rotations of largest modulus agree with ARPACK and are eigenpairs
+static bool krylov_schur(void) {
+
+    int32_t n = 200, k = 6, j, l;
+    bool ok = true;
+    eigs_sparse *a = rotations(n);
+    eigs_options opts;
+    eigs_options_init(&opts);
+    opts.krylov_schur = true;
+    opts.ncv = 20;
+    opts.nkeep = 10;
+
+    eigs_result *result = eigsx("zg", lap1d_zphi, NULL, NULL, NULL, NULL, n,
+                                k, "LR", 0, -1., false, &opts);
+    if (!check(result, k, "LR")) ok = false;
+    eigs_result_free(result);
+
+    result = eigsx("dg", NULL, eigs_sparse_dphi, NULL, NULL, a, n, k, "LM",
+                   0, -1., true, &opts);
+    eigs_result *arpack = eigs("dg", NULL, eigs_sparse_dphi, NULL, NULL, a,
+                               n, k, "LM", 0, -1., false);
+    for (l=0; l<k; l++) {
+        bool found = false;
+        for (j=0; j<k; j++)
+            if (cabs(result->eigvals[j]-arpack->eigvals[l]) <= TEST_TOL)
+                found = true;
+        if (!found) ok = false;
+    }
+    if ((result->stats.nconv < k) ||
+        (dresidual(result, eigs_sparse_dphi, a) > TEST_TOL))
+        ok = false;
+    eigs_result_free(result);
+    eigs_result_free(arpack);
+    eigs_sparse_free(a);
+
+    return ok;
+}
+
+
+/* --- Basis in a file ------------------------------------------------------ */
+
+// The double precision iterative solvers with the basis mapped from a file
+static bool basis_file(void) {
+
+    const char *solvers[] = { "zh", "ds", "zg", "dg" };
+    const char *which[] = { "SA", "LA", "SR", "LR" };
+    int32_t n = 400, k = 6, s;
+    bool ok = true;
+    eigs_options opts;
+    eigs_options_init(&opts);
+    opts.basis_dir = "/tmp";
+
+    for (s=0; s<4; s++) {
+        bool complex_solver = (solvers[s][0] == 'z');
+        eigs_result *result = eigsx(solvers[s],
+                                    complex_solver ? lap1d_zphi : NULL,
+                                    complex_solver ? NULL : lap1d_dphi,
+                                    NULL, NULL, NULL, n, k, which[s], 0, -1.,
+                                    false, &opts);
+        if (!check(result, k, which[s])) ok = false;
+        eigs_result_free(result);
+    }
+
+    return ok;
+}
+
+
+/* --- Tensor-product operators --------------------------------------------- */
+
+// H = A x I + I x B + 0.5 I of two 1D Laplacians (the complex ones gauge
+// transformed), the eigenvalues are the sums of theirs plus 0.5
+static bool kron_sum(void) {
+
+    int32_t dims[2] = { 10, 12 }, n = 120, k = 6, c, m, i, j, l;
+    bool ok = true;
+    double sums[120];
+
+    for (i=0; i<dims[0]; i++)
+        for (j=0; j<dims[1]; j++)
+            sums[dims[1]*i+j] = lap1d_eigval(dims[0], i)
+                                +lap1d_eigval(dims[1], j)+.5;
+    qsort(sums, n, sizeof(double), compare_doubles);
+    for (c=0; c<2; c++) {
+        double complex w = c ? cexp(CMPLX(0., .3)) : 1.;
+        eigs_kron *h = eigs_kron_init(2, dims);
+        for (m=0; m<2; m++) {
+            int32_t d = dims[m];
+            double complex *za = (double complex *)
+                calloc((size_t)d*d, sizeof(double complex));
+            double *da = (double *)calloc((size_t)d*d, sizeof(double));
+            for (i=0; i<d; i++) {
+                za[d*i+i] = 2.;
+                if (i < d-1) { za[d*i+i+1] = -w; za[d*(i+1)+i] = -conj(w); }
+            }
+            for (i=0; i<d*d; i++) da[i] = creal(za[i]);
+            const double complex *zf[2] = { NULL, NULL };
+            const double *df[2] = { NULL, NULL };
+            zf[m] = za; df[m] = da;
+            eigs_kron_add(h, 1., c ? zf : NULL, c ? NULL : df);
+            free(za); free(da);
+        }
+        eigs_kron_add(h, .5, NULL, NULL);
+        eigs_result *result = eigs(c ? "zh" : "ds",
+                                   c ? eigs_kron_zphi : NULL,
+                                   c ? NULL : eigs_kron_dphi,
+                                   NULL, NULL, h, n, k, "SA", 0, -1., false);
+        if (result->stats.nconv < k) ok = false;
+        for (l=0; l<k; l++) {
+            bool found = false;
+            for (j=0; j<k; j++)
+                if (fabs(creal(result->eigvals[j])-sums[l]) <= 4.*TEST_TOL)
+                    found = true;
+            if (!found) ok = false;
+        }
+        eigs_result_free(result);
+        eigs_kron_free(h);
+    }
+
+    return ok;
+}
+
+
+/* --- Symmetry sectors ---------------------------------------------------- */
+
+// Coupling i with i+2 splits n = 51 into chains of the even (26) and odd
+// (25) indices, detected from the dense and the sparse matrix; all
+// eigenvalues of the dense and the smallest of the sparse matrix
+static bool sectors_chains(void) {
+
+    int32_t n = 51, k = 6, nsectors, sizes[51], index[51], c, i, j;
+    int64_t ptr[52], nnz = 0;
+    int32_t row[153];
+    double complex zval[153];
+    double dval[153], exact[51];
+    bool ok = true;
+
+    for (j=0; j<26; j++) exact[j] = lap1d_eigval(26, j);
+    for (j=0; j<25; j++) exact[26+j] = lap1d_eigval(25, j);
+    qsort(exact, n, sizeof(double), compare_doubles);
+    for (c=0; c<2; c++) {
+        const char *solver = c ? "zh" : "ds";
+        double complex w = c ? cexp(CMPLX(0., .3)) : 1.;
+        double complex *za = (double complex *)
+            calloc((size_t)n*n, sizeof(double complex));
+        double *da = (double *)calloc((size_t)n*n, sizeof(double));
+        for (i=0; i<n; i++) {
+            za[n*i+i] = 2.;
+            if (i < n-2) { za[n*i+i+2] = -w; za[n*(i+2)+i] = -conj(w); }
+        }
+        for (i=0; i<n*n; i++) da[i] = creal(za[i]);
+        for (j=0, nnz=0; j<n; j++) {
+            ptr[j] = nnz;
+            for (i=0; i<n; i++)
+                if (za[n*i+j] != 0.) {
+                    row[nnz] = i; zval[nnz] = za[n*i+j];
+                    dval[nnz++] = da[n*i+j];
+                }
+        }
+        ptr[n] = nnz;
+        eigs_sparse *a = eigs_sparse_init("csc", false, n, ptr, row,
+                                          c ? zval : NULL, c ? NULL : dval);
+
+        nsectors = eigs_sectors_detect(n, NULL, c ? za : NULL,
+                                       c ? NULL : da, sizes, index);
+        if ((nsectors != 2) || (sizes[0] != 26) || (index[1] != 2))
+            ok = false;
+        eigs_result *result = eigs_sectors(solver, NULL, NULL,
+                                           c ? za : NULL, c ? NULL : da,
+                                           NULL, n, n, "LM", 0, -1., true,
+                                           NULL, nsectors, sizes, index);
+        for (j=0; j<n; j++)
+            if (cabs(result->eigvals[j]-exact[j]) > TEST_TOL) ok = false;
+        if (dense_residual(result, c ? za : NULL, c ? NULL : da) > TEST_TOL)
+            ok = false;
+        eigs_result_free(result);
+
+        nsectors = eigs_sectors_detect(n, a, NULL, NULL, sizes, index);
+        if (nsectors != 2) ok = false;
+        result = eigs_sectors(solver, c ? eigs_sparse_zphi : NULL,
+                              c ? NULL : eigs_sparse_dphi, NULL, NULL, a, n,
+                              k, "SA", 0, -1., false, NULL, nsectors, sizes,
+                              index);
+        if (result->stats.nconv < k) ok = false;
+        for (j=0; j<k; j++) {
+            bool found = false;
+            for (i=0; i<k; i++)
+                if (fabs(creal(result->eigvals[i])-exact[j]) <= 4.*TEST_TOL)
+                    found = true;
+            if (!found) ok = false;
+        }
+        eigs_result_free(result);
+        eigs_sparse_free(a);
+        free(za); free(da);
+    }
+
+    return ok;
+}
+
+
+/* --- Spectrum slicing ---------------------------------------------------- */
+
+// The inertia at both ends and all eigenvalues in between, against the exact
+// ones, full and half storage
+static bool slice_lap1d(void) {
+
+    int32_t n = 400, c, h, j, lo = 0, hi = 0;
+    double vl = .5, vu = .8;
+    bool ok = true;
+
+    for (j=0; j<n; j++) {
+        if (lap1d_eigval(n, j) < vl) lo++;
+        if (lap1d_eigval(n, j) < vu) hi++;
+    }
+    for (c=0; c<2; c++) {
+        for (h=0; h<2; h++) {
+            eigs_sparse *a = lap1d_sparse(n, h, c);
+            if ((eigs_sparse_inertia(a, vl) != lo) ||
+                (eigs_sparse_inertia(a, vu) != hi)) ok = false;
+            eigs_result *result = eigs_slice(c ? "zh" : "ds", a, vl, vu, 0,
+                                             -1., false, NULL);
+            if (result->k != hi-lo) ok = false;
+            for (j=0; (j<hi-lo) && (j<result->k); j++)
+                if (cabs(result->eigvals[j]-lap1d_eigval(n, lo+j)) >
+                    4.*TEST_TOL) ok = false;
+            eigs_result_free(result);
+            eigs_sparse_free(a);
+        }
+    }
+
+    return ok;
+}
+
+
+/* --- Band and packed storage -------------------------------------------- */
+
+// A random band matrix (kd = 3) in band and packed storage against full
+// storage: all eigenpairs of each and a range 'I' of the band matrix
+static bool band_packed(void) {
+
+    int32_t m = 60, kd = 3, c, i, j;
+    bool ok = true;
+    uint32_t seed = 5;
+    eigs_options opts;
+
+    for (c=0; c<2; c++) {
+        const char *solver = c ? "zh" : "ds";
+        void *a = random_hermitian(m, c, &seed);
+        double complex *za = c ? a : NULL;
+        double *da = c ? NULL : a;
+        double complex *zb = (double complex *)
+            calloc((size_t)m*m, sizeof(double complex));
+        double *db = (double *)calloc((size_t)m*m, sizeof(double));
+        for (i=0; i<m; i++)
+            for (j=0; j<m; j++) {
+                if (abs(i-j) > kd) {
+                    if (c) za[m*i+j] = 0.; else da[m*i+j] = 0.;
+                }
+                else if (j >= i) {
+                    if (c) zb[(kd+1)*i+j-i] = za[m*i+j];
+                    else db[(kd+1)*i+j-i] = da[m*i+j];
+                }
+            }
+        eigs_result *full = eigs(solver, NULL, NULL, za, da, NULL, m, m,
+                                 "LM", 0, -1., false);
+
+        eigs_options_init(&opts);
+        opts.storage = 'B';
+        opts.kd = kd;
+        eigs_result *result = eigsx(solver, NULL, NULL, c ? zb : NULL,
+                                    c ? NULL : db, NULL, m, m, "LM", 0, -1.,
+                                    true, &opts);
+        for (j=0; j<m; j++)
+            if (cabs(result->eigvals[j]-full->eigvals[j]) > TEST_TOL)
+                ok = false;
+        if (dense_residual(result, za, da) > TEST_TOL) ok = false;
+        eigs_result_free(result);
+
+        opts.range = 'I';
+        opts.il = 10;
+        result = eigsx(solver, NULL, NULL, c ? zb : NULL, c ? NULL : db,
+                       NULL, m, 5, "LM", 0, -1., true, &opts);
+        for (j=0; j<5; j++)
+            if (cabs(result->eigvals[j]-full->eigvals[10+j]) > TEST_TOL)
+                ok = false;
+        if (dense_residual(result, za, da) > TEST_TOL) ok = false;
+        eigs_result_free(result);
+
+        eigs_options_init(&opts);
+        opts.storage = 'P';
+        for (i=0; i<m; i++)
+            for (j=i; j<m; j++) {
+                int64_t p = (int64_t)i*m-(int64_t)i*(i-1)/2+j-i;
+                if (c) zb[p] = za[m*i+j]; else db[p] = da[m*i+j];
+            }
+        result = eigsx(solver, NULL, NULL, c ? zb : NULL, c ? NULL : db,
+                       NULL, m, m, "LM", 0, -1., true, &opts);
+        for (j=0; j<m; j++)
+            if (cabs(result->eigvals[j]-full->eigvals[j]) > TEST_TOL)
+                ok = false;
+        if (dense_residual(result, za, da) > TEST_TOL) ok = false;
+        eigs_result_free(result);
+        eigs_result_free(full);
+        free(a); free(zb); free(db);
+    }
+
+    return ok;
+}
+
+
+/* --- Eigenvalues of dense general matrices ------------------------------- */
+
+// A graded random matrix D R D^-1: the eigenvalues without eigenvectors,
+// balanced and not, are those of the eigenvector solve
+static bool dense_eigvals(void) {
+
+    const char balance[] = { 'B', 'N' };
+    int32_t m = 80, c, b, i, j, l;
+    bool ok = true;
+    uint32_t seed = 7;
+    double complex *za = (double complex *)
+        malloc((size_t)m*m*sizeof(double complex));
+    double *da = (double *)malloc((size_t)m*m*sizeof(double));
+    eigs_options opts;
+
+    for (i=0; i<m; i++)
+        for (j=0; j<m; j++) {
+            double d = pow(2., (i-j)/8.);
+            da[m*i+j] = d*uniform(&seed);
+            za[m*i+j] = CMPLX(da[m*i+j], d*uniform(&seed));
+        }
+    for (c=0; c<2; c++) {
+        const char *solver = c ? "zg" : "dg";
+        eigs_result *full = eigs(solver, NULL, NULL, c ? za : NULL,
+                                 c ? NULL : da, NULL, m, m, "LM", 0, -1.,
+                                 true);
+        if (dense_residual(full, c ? za : NULL, c ? NULL : da) > 1e-8)
+            ok = false;
+        for (b=0; b<2; b++) {
+            eigs_options_init(&opts);
+            opts.balance = balance[b];
+            eigs_result *result = eigsx(solver, NULL, NULL, c ? za : NULL,
+                                        c ? NULL : da, NULL, m, m, "LM", 0,
+                                        -1., false, &opts);
+            if (result->k != m) ok = false;
+            for (j=0; j<result->k; j++) {
+                double dist = INFINITY;
+                for (l=0; l<m; l++)
+                    dist = fmin(dist, cabs(result->eigvals[j]
+                                           -full->eigvals[l]));
+                if (dist > 1e-8) ok = false;
+            }
+            eigs_result_free(result);
+        }
+        eigs_result_free(full);
+    }
+    free(za); free(da);
+
+    return ok;
+}
+
+
+/* --- Helpers -------------------------------------------------------------- */
+
+// All k eigenpairs converged and the eigenvalues are the k smallest ("SA",
+// "SR") or largest ones of the 1D Laplacian (in any order)
+static bool check(const eigs_result *result, int32_t k, const char *which) {
+
+    int32_t n = result->n, j, l;
+    bool smallest = (which[0] == 'S');
+
+    if (result->stats.nconv != k) return false;
+    for (l=0; l<k; l++) {
+        double exact = lap1d_eigval(n, smallest ? l : n-1-l);
+        bool found = false;
+        for (j=0; j<k; j++)
+            if (fabs(creal(result->eigvals[j])-exact) <= 4.*TEST_TOL)
+                found = true;
+        if (!found) return false;
+    }
+
+    return true;
+}
+
+// Eigenvalue j (ascending) of the 1D Laplacian tridiag(-1, 2, -1)
+static double lap1d_eigval(int32_t n, int32_t j) {
+    double s = sin(acos(-1.)*(j+1)/(2.*(n+1)));
+    return 4.*s*s;
+}
+
+// Real sparse matrix with the eigenvalues p/100 +- (.05+p/1000) i, p < n/2:
+// rotation blocks on the diagonal, coupled to the next block above them
+// (CSC arrays, the matrix keeps a copy)
+static eigs_sparse *rotations(int32_t n) {
+
+    int64_t *ptr = (int64_t *)malloc((n+1)*sizeof(int64_t)), nnz = 0;
+    int32_t *row = (int32_t *)malloc(3*n*sizeof(int32_t)), j;
+    double *val = (double *)malloc(3*n*sizeof(double));
+
+    for (j=0; j<n; j++) {
+        double re = (j/2)/100., im = .05+(j/2)/1000.;
+        ptr[j] = nnz;
+        if (j >= 2) { row[nnz] = j-2; val[nnz++] = .01; }
+        row[nnz] = j-j%2; val[nnz++] = (j%2) ? im : re;
+        row[nnz] = j-j%2+1; val[nnz++] = (j%2) ? re : -im;
+    }
+    ptr[n] = nnz;
+    eigs_sparse *a = eigs_sparse_init("csc", false, n, ptr, row, NULL, val);
+    free(ptr); free(row); free(val);
+
+    return a;
+}
+
+// Largest relative residual |A x - lambda x|/|x| of the (row-major)
+// eigenpairs of a real map
+static double dresidual(const eigs_result *result,
+                        deigs_phi *dphi,
+                        void *data) {
+
+    int32_t n = result->n, k = result->k, i, j;
+    double *x = (double *)malloc(4*n*sizeof(double)), res = 0.;
+    double *y = &x[2*n];
+
+    for (j=0; j<k; j++) {
+        double complex lambda = result->eigvals[j];
+        double r = 0., nx = 0.;
+        for (i=0; i<n; i++) {
+            x[i] = creal(result->eigvecs[(int64_t)k*i+j]);
+            x[n+i] = cimag(result->eigvecs[(int64_t)k*i+j]);
+        }
+        dphi(data, n, x, y);
+        dphi(data, n, &x[n], &y[n]);
+        for (i=0; i<n; i++) {
+            double complex xi = CMPLX(x[i], x[n+i]);
+            r += pow(cabs(CMPLX(y[i], y[n+i])-lambda*xi), 2);
+            nx += pow(cabs(xi), 2);
+        }
+        if (sqrt(r/nx) > res) res = sqrt(r/nx);
+    }
+    free(x);
+
+    return res;
+}
+
+// Random row-major Hermitian (complex) or symmetric matrix with entries in
+// [-1, 1)
+static void *random_hermitian(int32_t n, bool complex_values, uint32_t *seed) {
+
+    int32_t i, j;
+    double complex *za = NULL;
+    double *da = NULL;
+
+    if (complex_values)
+        za = (double complex *)malloc((size_t)n*n*sizeof(double complex));
+    else
+        da = (double *)malloc((size_t)n*n*sizeof(double));
+    for (i=0; i<n; i++) {
+        for (j=i; j<n; j++) {
+            double re = uniform(seed), im = (j > i) ? uniform(seed) : 0.;
+            if (complex_values) {
+                za[(size_t)n*i+j] = CMPLX(re, im);
+                za[(size_t)n*j+i] = CMPLX(re, -im);
+            } else {
+                da[(size_t)n*i+j] = da[(size_t)n*j+i] = re;
+            }
+        }
+    }
+
+    return complex_values ? (void *)za : (void *)da;
+}
+
+// Largest residual |A x - lambda x| of the (row-major, normalized)
+// eigenpairs of a row-major dense matrix, either "za" or "da" is NULL
+static double dense_residual(const eigs_result *result,
+                             const double complex *za,
+                             const double *da) {
+
+    int32_t n = result->n, k = result->k, i, l, j;
+    double res = 0.;
+
+    for (j=0; j<k; j++) {
+        double r = 0.;
+        for (i=0; i<n; i++) {
+            double complex y = -result->eigvals[j]
+                               *result->eigvecs[(int64_t)k*i+j];
+            for (l=0; l<n; l++)
+                y += (za ? za[(size_t)n*i+l] : da[(size_t)n*i+l])
+                     *result->eigvecs[(int64_t)k*l+j];
+            r += pow(cabs(y), 2);
+        }
+        if (sqrt(r) > res) res = sqrt(r);
+    }
+
+    return res;
+}
+
+// Uniform random number in [-1, 1) (linear congruential generator)
+static double uniform(uint32_t *seed) {
+    *seed = 1664525u*(*seed)+1013904223u;
+    return 2.*(*seed)/4294967296.-1.;
+}
+
+// 1D Laplacian (Dirichlet) in the four precisions
+static void lap1d_zphi(void *data,
+                       int32_t n,
+                       const double complex *x,
+                       double complex *y) {
+    (void)data;
+    for (int32_t i=0; i<n; i++)
+        y[i] = 2.*x[i]-(i ? x[i-1] : 0.)-((i < n-1) ? x[i+1] : 0.);
+}
+
+static void lap1d_dphi(void *data, int32_t n, const double *x, double *y) {
+    (void)data;
+    for (int32_t i=0; i<n; i++)
+        y[i] = 2.*x[i]-(i ? x[i-1] : 0.)-((i < n-1) ? x[i+1] : 0.);
+}
+
+static void lap1d_cphi(void *data,
+                       int32_t n,
+                       const float complex *x,
+                       float complex *y) {
+    (void)data;
+    for (int32_t i=0; i<n; i++)
+        y[i] = 2.f*x[i]-(i ? x[i-1] : 0.f)-((i < n-1) ? x[i+1] : 0.f);
+}
+
+static void lap1d_sphi(void *data, int32_t n, const float *x, float *y) {
+    (void)data;
+    for (int32_t i=0; i<n; i++)
+        y[i] = 2.f*x[i]-(i ? x[i-1] : 0.f)-((i < n-1) ? x[i+1] : 0.f);
+}
+
+// Row-major dense n x n matrix "data" (float for the float maps)
+static void dense_zphi(void *data,
+                       int32_t n,
+                       const double complex *x,
+                       double complex *y) {
+    const double *a = (const double *)data;
+    for (int32_t i=0; i<n; i++) {
+        y[i] = 0.;
+        for (int32_t j=0; j<n; j++) y[i] += a[(size_t)n*i+j]*x[j];
+    }
+}
+
+static void dense_dphi(void *data, int32_t n, const double *x, double *y) {
+    const double *a = (const double *)data;
+    for (int32_t i=0; i<n; i++) {
+        y[i] = 0.;
+        for (int32_t j=0; j<n; j++) y[i] += a[(size_t)n*i+j]*x[j];
+    }
+}
+
+static void dense_cphi(void *data,
+                       int32_t n,
+                       const float complex *x,
+                       float complex *y) {
+    const float *a = (const float *)data;
+    for (int32_t i=0; i<n; i++) {
+        y[i] = 0.f;
+        for (int32_t j=0; j<n; j++) y[i] += a[(size_t)n*i+j]*x[j];
+    }
+}
+
+static void dense_sphi(void *data, int32_t n, const float *x, float *y) {
+    const float *a = (const float *)data;
+    for (int32_t i=0; i<n; i++) {
+        y[i] = 0.f;
+        for (int32_t j=0; j<n; j++) y[i] += a[(size_t)n*i+j]*x[j];
+    }
+}
+
+// 1D Laplacian as sparse matrix, the complex one has the couplings
+// -exp(+-0.3 i) (CSC arrays of the full matrix or of its upper triangle, the
+// matrix keeps a copy)
+static eigs_sparse *lap1d_sparse(int32_t n, bool half, bool complex_values) {
+
+    int64_t *ptr = (int64_t *)malloc((n+1)*sizeof(int64_t)), nnz = 0;
+    int32_t *row = (int32_t *)malloc(3*n*sizeof(int32_t)), j;
+    double complex *zval = (double complex *)malloc(3*n*sizeof(double complex));
+    double complex w = complex_values ? cexp(CMPLX(0., .3)) : 1.;
+
+    for (j=0; j<n; j++) {
+        ptr[j] = nnz;
+        if (j > 0) { row[nnz] = j-1; zval[nnz++] = -w; }
+        row[nnz] = j; zval[nnz++] = 2.;
+        if (!half && (j < n-1)) { row[nnz] = j+1; zval[nnz++] = -conj(w); }
+    }
+    ptr[n] = nnz;
+    double *dval = (double *)malloc(nnz*sizeof(double));
+    for (j=0; j<nnz; j++) dval[j] = creal(zval[j]);
+    eigs_sparse *a = eigs_sparse_init("csc", half, n, ptr, row,
+                                      complex_values ? zval : NULL,
+                                      complex_values ? NULL : dval);
+    free(ptr); free(row); free(zval); free(dval);
+
+    return a;
+}
+
+// Ascending order of doubles (qsort)
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y)-(x < y);
+}